@@ -42,6 +42,92 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /******************************************************************************/
 extern const char valueToChar[];
 
+/******************************************************************************/
+/*! A band of rows to palettize on its own thread */
+typedef struct
+{
+	/*! Just the band's rows */
+	PintoImageView view;
+	s32 pixelAmount;
+	char *indexedData;
+	/*! Colors of just this band, in order of first appearance in the band */
+	PintoPalette palette;
+	/*! Index in the image's palette of each of the band's colors */
+	char indexMap[ PINTO_MAX_COLORS ];
+	PINTO_RC rc;
+} PintoBandJob;
+
+/*! A range of colors to create RLE data for on its own thread */
+typedef struct
+{
+	const char *indexedData;
+	s32 pixelAmount;
+	s32 colorStart;
+	s32 colorEnd;
+	PintoText **colorTexts;
+	PINTO_RC rc;
+} PintoRleJob;
+
+/*! A match found while deflating a segment */
+typedef struct
+{
+	s32 position;
+	s32 length;
+	s32 distance;
+} PintoDeflateMatch;
+
+/*! A segment of text to deflate on its own thread */
+typedef struct
+{
+	PintoMatchFinder *finder;
+	s32 start;
+	s32 end;
+	/*! Matches of the segment's greedy parse, in order */
+	PintoDeflateMatch *matches;
+	s32 matchAmount;
+} PintoDeflateJob;
+
+/******************************************************************************/
+static PINTO_RC pintoEncode( PintoEncoder *encoder, const PintoImage *image, const PintoEncodeOptions *options, PintoText *outText, PintoText **encodedText_A );
+static PINTO_RC pintoEncodeView( PintoEncoder *encoder, const PintoImageView *view, const PintoEncodeOptions *options, PintoText *outText, PintoText **encodedText_A );
+static PINTO_RC pintoImageViewCheck( const PintoImageView *view );
+static PINTO_RC pintoEncoderGrow( PintoEncoder *encoder, s32 pixelAmount );
+static void pintoEncoderFreeBuffers( PintoEncoder *encoder );
+static PINTO_RC pintoEncodeIndexed( PintoEncoder *encoder, s32 width, s32 height, const PintoEncodeOptions *options, PintoText *outText, PintoText **encodedText_A );
+static PINTO_RC pintoEncoderGetText( PintoText **text );
+static PINTO_RC pintoEncoderSetSink( PintoEncoder *encoder, PintoWriteFunc writeFunc, void *userData );
+static PINTO_RC pintoPalettize( const PintoImageView *view, PintoPalette *palette, char *indexedData );
+static PINTO_RC pintoPalettizeIndexed( const PintoIndexedImage *image, PintoPalette *palette, char *indexedData );
+static PINTO_RC pintoPalettizeParallel( const PintoImageView *view, s32 threadCount, PintoPalette *palette, char *indexedData );
+static void pintoPalettizeJob( void *job );
+static void pintoRemapJob( void *job );
+static void pintoPaletteReorder( PintoPalette *palette, char *indexedData, s32 pixelAmount, char *sequence );
+static s32 pintoColorSequence( const char *indexedData, s32 pixelAmount, char *sequence );
+static s32 pintoColorSequenceRemove( char *sequence, s32 sequenceLength, s32 color );
+static PINTO_RC pintoRleEncodeColorsParallel( const char *indexedData, s32 pixelAmount, s32 colorAmount, s32 threadCount, PintoText **colorTexts );
+static void pintoRleJob( void *job );
+static PINTO_RC pintoDeflateGreedy( PintoMatchFinder *finder, PintoText *text );
+static PINTO_RC pintoDeflateParallel( PintoMatchFinder *finder, s32 threadCount, PintoText *text );
+static void pintoDeflateJob( void *job );
+static PINTO_RC pintoDeflateSmallest( PintoMatchFinder *finder, PintoOptimalParser *parser, const PintoText *textToDeflate, PintoText *optimalText, PintoText *greedyText, PintoText **smallestText );
+static PINTO_RC pintoDeflateOptimal( PintoMatchFinder *finder, PintoOptimalParser *parser, PintoText *text );
+static PINTO_RC pintoDeflateAddMatch( PintoText *text, s32 distance, s32 length );
+static s32 pintoDeflateMatchCost( s32 distance, s32 length );
+static PINTO_RC pintoDecode( PintoText *deflatedText, PintoDecodeTarget *target );
+static PINTO_RC pintoDecodeHeader( PintoInflater *inflater, s32 *width, s32 *height, s32 *colorAmount, u8 *palette );
+static PINTO_RC pintoDecodeTargetInit( PintoDecodeTarget *target, s32 width, s32 height, s32 colorAmount, const u8 *palette );
+static PINTO_RC pintoDecodeRuns( PintoInflater *inflater, s32 pixelAmount, s32 colorAmount, PintoInflaterMark *marks, s32 *colorStarts );
+static PINTO_RC pintoDecodeNextSpan( PintoInflater *inflater, s32 pixelAmount, s32 *position, s32 *spanStart, s32 *spanEnd );
+static PINTO_RC pintoPaintColors( const PintoDecodeTarget *target, PintoText *deflatedText, const PintoInflaterMark *marks, const s32 *colorStarts, s32 colorAmount, const u8 *palette );
+static s32 pintoInflatedSize( const PintoText *text );
+static PINTO_RC pintoInflaterInit( PintoInflater *inflater, PintoText *source, s32 bufferSize );
+static void pintoInflaterFree( PintoInflater *inflater );
+static PINTO_RC pintoInflaterFill( PintoInflater *inflater, s32 amount );
+static s32 pintoInflaterAtEnd( PintoInflater *inflater );
+static s32 pintoInflaterPosition( const PintoInflater *inflater );
+static void pintoInflaterSaveMark( PintoInflater *inflater );
+static PINTO_RC pintoInflaterResume( PintoInflater *inflater, const PintoInflaterMark *mark, s32 position );
+
 /******************************************************************************/
 /*!
 	\brief Encodes an image into the Pinto format.
@@ -52,36 +138,49 @@ extern const char valueToChar[];
 */
 PINTO_RC pintoImageEncode( const PintoImage *image, char **string_A )
 {
-	/* DATA */
-	PINTO_RC rc = PINTO_RC_SUCCESS;
-
-	PintoText *newText = NULL;
-	PintoText *newTextDeflated = NULL;
-	u8 *palette = NULL;
-
-	/* This is the indexed image data.
-	   Instead of holding RGB, it holds an index into the palette.
-	   The special value -1 is for transparent pixels. */
-	char *indexedData = NULL;
-
-	s32 color = 0;
-	s32 pixel = 0;
+	return pintoImageEncodeEx( image, NULL, string_A );
+}
 
-	s32 colorAmount = 0;
-	s32 colorFound = 0;
+/******************************************************************************/
+/*!
+	\brief Sets encoding options to their defaults.
+	\param[in] options Options to set.
+	\return void
+*/
+void pintoEncodeOptionsInit( PintoEncodeOptions *options )
+{
+	/* CODE */
+	if ( options == NULL )
+	{
+		return;
+	}
 
-	char needToAddStandardHeader = 1;
+	options->level = PINTO_LEVEL_DEFAULT;
+	options->threadCount = 1;
+	options->reorderColors = 0;
 
-	u8 red = 0;
-	u8 green = 0;
-	u8 blue = 0;
+	return;
+}
 
-	char rleState = 0;
-	s32 rleCount = 0;
+/******************************************************************************/
+/*!
+	\brief Encodes an image into the Pinto format, with options.
+	\param[in] image The image to be encoded.
+	\param[in] options Encoding options, or NULL to use the defaults.
+		See pintoEncodeOptionsInit().
+	\param[out] string_A On success, the string that contains the encoded image.
+		Will be allocated. The caller is responsible for freeing.
+	\return PINTO_RC
 
-	PintoImage *verifyImage = NULL;
+	Every level produces an encoding that decodes to the same image.
+*/
+PINTO_RC pintoImageEncodeEx( const PintoImage *image, const PintoEncodeOptions *options, char **string_A )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
 
-	char *givebackString = NULL;
+	PintoEncoder *encoder = NULL;
+	PintoText *encodedText = NULL;
 
 
 	/* PRECOND */
@@ -92,943 +191,5123 @@ PINTO_RC pintoImageEncode( const PintoImage *image, char **string_A )
 
 
 	/* CODE */
+	rc = pintoEncoderInit( &encoder );
+	ERR_IF_PASSTHROUGH;
 
-	/* check size */
-	ERR_IF_1( image->width  <= 0, PINTO_RC_ERROR_IMAGE_BAD_SIZE, image->width );
-	ERR_IF_1( image->height <= 0, PINTO_RC_ERROR_IMAGE_BAD_SIZE, image->height );
-
-	ERR_IF_1( image->width  > PINTO_MAX_WIDTH,  PINTO_RC_ERROR_IMAGE_BAD_SIZE, image->width );
-	ERR_IF_1( image->height > PINTO_MAX_HEIGHT, PINTO_RC_ERROR_IMAGE_BAD_SIZE, image->height );
-
-	/* malloc data, which is the palette-ized version of the image.
-	   instead of rgba, it'll hold the index of the color, with -1
-	   being a special case of transparent. */
-	PINTO_MALLOC( indexedData, char, image->width * image->height );
+	rc = pintoEncode( encoder, image, options, NULL, &encodedText );
+	ERR_IF_PASSTHROUGH;
 
-	/* determine palette */
-	PINTO_CALLOC( palette, u8, PINTO_MAX_COLORS * 3 );
+	/* give back, taking the string from the encoder so we don't have to copy
+	   it */
+	(*string_A) = encodedText->string;
+	encodedText->string = NULL;
 
-	/* foreach pixel */
-	for ( pixel = 0; pixel < ( image->width * image->height ); pixel += 1 )
-	{
-		/* if alpha is 0, fully transparent, ignore */
-		if ( image->rgba[ ( pixel * 4 ) + 3 ] == 0 )
-		{
-			/* mark pixel in data as transparent */
-			indexedData[ pixel ] = -1;
 
-			continue;
-		}
+	/* CLEANUP */
+	cleanup:
 
-		/* if alpha is not 255, fully opaque, then it's partially
-		   transparent, and not allowed */
-		ERR_IF( image->rgba[ ( pixel * 4 ) + 3 ] != 255, PINTO_RC_ERROR_IMAGE_PARTIAL_TRANSPARENCY );
+	pintoEncoderFree( &encoder );
 
-		/* reset colorFound flag */
-		colorFound = 0;
+	return rc;
+}
 
-		/* get the red, green, and blue of the pixel */
-		red   = image->rgba[ ( pixel * 4 )     ];
-		green = image->rgba[ ( pixel * 4 ) + 1 ];
-		blue  = image->rgba[ ( pixel * 4 ) + 2 ];
+/******************************************************************************/
+/*!
+	\brief Initialize an encoder, which keeps its buffers between encodes.
+	\param[out] encoder_A The new encoder.
+		Will be allocated. Caller is responsible for freeing by passing the
+		encoder to pintoEncoderFree().
+	\return PINTO_RC
 
-		red   = PINTO_8_BITS_TO_6_BITS( red   );
-		green = PINTO_8_BITS_TO_6_BITS( green );
-		blue  = PINTO_8_BITS_TO_6_BITS( blue  );
+	Buffers are allocated and grown as needed by pintoEncoderEncode(). Once
+	they're big enough, encoding with threadCount 1 doesn't allocate anything.
+*/
+PINTO_RC pintoEncoderInit( PintoEncoder **encoder_A )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
 
-		/* is this color already in our palette? */
+	PintoEncoder *newEncoder = NULL;
 
-		/* foreach color */
-		for ( color = 0; color < colorAmount; color += 1 )
-		{
-			/* does the current pixel match this color? */
-			if (    red   == palette[ ( color * 3 )     ]
-			     && green == palette[ ( color * 3 ) + 1 ]
-			     && blue  == palette[ ( color * 3 ) + 2 ]
-			   )
-			{
-				colorFound = 1;
-				break;
-			}
-		}
 
-		/* if color wasn't found, it's new, so add it to our palette */
-		if ( colorFound == 0 )
-		{
-			/* make sure we dont go over PINTO_MAX_COLORS */
-			ERR_IF( colorAmount == PINTO_MAX_COLORS, PINTO_RC_ERROR_IMAGE_TOO_MANY_COLORS );
+	/* CODE */
+	FAILURE_POINT;
+	ERR_IF( encoder_A == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( (*encoder_A) != NULL, PINTO_RC_ERROR_PRECOND );
 
-			/* add it to palette */
-			palette[ ( colorAmount * 3 )     ] = red;
-			palette[ ( colorAmount * 3 ) + 1 ] = green;
-			palette[ ( colorAmount * 3 ) + 2 ] = blue;
+	/* all buffers start out NULL */
+	PINTO_CALLOC( newEncoder, PintoEncoder, 1 );
 
-			colorAmount += 1;
-		}
+	/* give back */
+	(*encoder_A) = newEncoder;
+	newEncoder = NULL;
 
-		/* mark this pixel in data */
-		indexedData[ pixel ] = color;
-	}
 
-	/* we've created out palette, now lets start creating the pinto encoding */
+	/* CLEANUP */
+	cleanup:
 
-	/* create text */
-	rc = pintoTextInit( &newText );
-	ERR_IF_PASSTHROUGH;
+	return rc;
+}
 
-	/* See if it's a certain image, and we can use a shorter header */
-	if (    colorAmount == 1
-	     && palette[ 0 ] == 0 && palette[ 1 ] == 0 && palette[ 2 ] == 0
-	     && image->width == image->height
-	   )
+/******************************************************************************/
+/*!
+	\brief Frees an encoder and all its buffers.
+	\param[in] encoder_F Encoder to be freed. Will be freed with
+		PINTO_HOOK_FREE(). On return, encoder_F will be NULL.
+	\return void
+*/
+void pintoEncoderFree( PintoEncoder **encoder_F )
+{
+	/* CODE */
+	if ( encoder_F == NULL || (*encoder_F) == NULL )
 	{
-		if ( image->width == 8 )
-		{
-			rc = pintoTextAddChar( newText, '0' );
-			ERR_IF_PASSTHROUGH;
-
-			needToAddStandardHeader = 0;
-		}
-		if ( image->width == 16 )
-		{
-			rc = pintoTextAddChar( newText, '1' );
-			ERR_IF_PASSTHROUGH;
-
-			needToAddStandardHeader = 0;
-		}
-		else if ( image->width == 32 )
-		{
-			rc = pintoTextAddChar( newText, '2' );
-			ERR_IF_PASSTHROUGH;
-
-			needToAddStandardHeader = 0;
-		}
-		else if ( image->width == 64 )
-		{
-			rc = pintoTextAddChar( newText, '3' );
-			ERR_IF_PASSTHROUGH;
+		return;
+	}
 
-			needToAddStandardHeader = 0;
-		}
-		else if ( image->width == 128 )
-		{
-			rc = pintoTextAddChar( newText, '4' );
-			ERR_IF_PASSTHROUGH;
+	pintoEncoderFreeBuffers( (*encoder_F) );
 
-			needToAddStandardHeader = 0;
-		}
-		else if ( image->width == 256 )
-		{
-			rc = pintoTextAddChar( newText, '5' );
-			ERR_IF_PASSTHROUGH;
+	PINTO_HOOK_FREE( (*encoder_F) );
+	(*encoder_F) = NULL;
 
-			needToAddStandardHeader = 0;
-		}
-		else if ( image->width == 512 )
-		{
-			rc = pintoTextAddChar( newText, '6' );
-			ERR_IF_PASSTHROUGH;
+	return;
+}
 
-			needToAddStandardHeader = 0;
-		}
-		else if ( image->width == 1024 )
-		{
-			rc = pintoTextAddChar( newText, '7' );
-			ERR_IF_PASSTHROUGH;
+/******************************************************************************/
+/*!
+	\brief Frees an encoder's buffers, but not the encoder.
+	\param[in] encoder Encoder.
+	\return void
+*/
+static void pintoEncoderFreeBuffers( PintoEncoder *encoder )
+{
+	/* DATA */
+	s32 color = 0;
 
-			needToAddStandardHeader = 0;
-		}
-		else if ( image->width == 2048 )
-		{
-			rc = pintoTextAddChar( newText, '8' );
-			ERR_IF_PASSTHROUGH;
 
-			needToAddStandardHeader = 0;
-		}
-		else if ( image->width == 4096 )
-		{
-			rc = pintoTextAddChar( newText, '9' );
-			ERR_IF_PASSTHROUGH;
+	/* CODE */
+	PINTO_HOOK_FREE( encoder->indexedData );
+	encoder->indexedData = NULL;
+	PINTO_HOOK_FREE( encoder->sequence );
+	encoder->sequence = NULL;
 
-			needToAddStandardHeader = 0;
-		}
-	}
+	pintoTextFree( &encoder->text );
+	pintoTextFree( &encoder->deflatedText );
+	pintoTextFree( &encoder->greedyText );
+	pintoTextFree( &encoder->sinkText );
 
-	if ( needToAddStandardHeader )
+	for ( color = 0; color < PINTO_MAX_COLORS; color += 1 )
 	{
-			/* 'a' means standard header follows */
-			rc = pintoTextAddChar( newText, 'a' );
-			ERR_IF_PASSTHROUGH;
-
-			/* add width */
-			rc = pintoTextAddValue( newText, image->width );
-			ERR_IF_PASSTHROUGH;
-
-			/* add height */
-			rc = pintoTextAddValue( newText, image->height );
-			ERR_IF_PASSTHROUGH;
-
-			/* add colorAmount */
-			rc = pintoTextAddValue( newText, colorAmount );
-			ERR_IF_PASSTHROUGH;
-
-			/* add colors to palette */
-			for ( color = 0; color < ( colorAmount * 3 ); color += 1 )
-			{
-				/* divide by 4 because pinto's colors are 6-bit */
-				rc = pintoTextAddChar( newText, valueToChar[ palette[ color ] / 4 ] );
-				ERR_IF_PASSTHROUGH;
-			}
+		pintoTextFree( &encoder->colorTexts[ color ] );
 	}
 
-	/* add RLE data */
+	PINTO_HOOK_FREE( encoder->finder );
+	encoder->finder = NULL;
+	PINTO_HOOK_FREE( encoder->parser );
+	encoder->parser = NULL;
 
-	/* foreach color */
-	for ( color = 0; color < colorAmount; color += 1 )
-	{
-		rleState = 0;
-		rleCount = 0;
+	return;
+}
 
-		/* foreach pixel */
-		for ( pixel = 0; pixel < ( image->width * image->height ); pixel += 1 )
-		{
-			/* if off */
-			if ( rleState == 0 )
-			{
-				/* if same color */
-				if ( color == indexedData[ pixel ] )
-				{
-					/* add rle count */
-					rc = pintoTextAddValue( newText, rleCount );
-					ERR_IF_PASSTHROUGH;
+/******************************************************************************/
+/*!
+	\brief Encodes an image into the Pinto format, using an encoder's buffers.
+	\param[in] encoder Encoder.
+	\param[in] image The image to be encoded.
+	\param[in] options Encoding options, or NULL to use the defaults.
+		See pintoEncodeOptionsInit().
+	\param[out] string On success, the string that contains the encoded image.
+		Belongs to the encoder, and is only valid until the encoder is used
+		again or freed.
+	\return PINTO_RC
 
-					/* reset rleState and rleCount */
-					rleState = 1;
-					rleCount = 1;
-				}
-				/* else if different color */
-				else
-				{
-					rleCount += 1;
-				}
-			}
-			/* else, on */
-			else
-			{
-				PARANOID_ERR_IF( rleState != 1 );
+	Gives the exact same encoding as pintoImageEncodeEx().
+*/
+PINTO_RC pintoEncoderEncode( PintoEncoder *encoder, const PintoImage *image, const PintoEncodeOptions *options, const char **string )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
 
-				/* if same or higher color */
-				if ( indexedData[ pixel ] >= color )
-				{
-					rleCount += 1;
-				}
-				/* else if lower color */
-				else
-				{
-					/* add rle count */
-					rc = pintoTextAddValue( newText, rleCount );
-					ERR_IF_PASSTHROUGH;
+	PintoText *encodedText = NULL;
 
-					rleState = 0;
-					rleCount = 1;
-				}
-			}
 
-		} /* end foreach pixel */
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( encoder == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( image == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( string == NULL, PINTO_RC_ERROR_PRECOND );
 
-		/* add '^', which signals end of color */
-		rc = pintoTextAddChar( newText, '^' );
-		ERR_IF_PASSTHROUGH;
 
-	} /* end foreach color */
+	/* CODE */
+	(*string) = NULL;
 
-	/* deflate */
-	rc = pintoSimpleDeflate( &newText, &newTextDeflated );
+	rc = pintoEncode( encoder, image, options, NULL, &encodedText );
 	ERR_IF_PASSTHROUGH;
 
-	/* get string */
-	pintoTextFreeAndGetString( &newTextDeflated, &givebackString );
-
-	/* give back */
-	(*string_A) = givebackString;
-	givebackString = NULL;
+	(*string) = encodedText->string;
 
 
 	/* CLEANUP */
 	cleanup:
 
-	PINTO_HOOK_FREE( palette );
-	palette = NULL;
-
-	PINTO_HOOK_FREE( indexedData );
-	indexedData = NULL;
-
-	pintoTextFree( &newText );
-	pintoTextFree( &newTextDeflated );
-
-	pintoImageFree( &verifyImage );
-
-	PINTO_HOOK_FREE( givebackString );
-	givebackString = NULL;
-
 	return rc;
 }
 
 /******************************************************************************/
 /*!
-	\brief Decodes a string into an image.
-	\param[in] string The string to be decoded.
-	\param[out] image_A On success, the decoded image.
-		Will be allocated. The caller is responsible for freeing by passing the
-		image to the pintoImageFree() function.
+	\brief Gets the most characters an image's encoding can take.
+	\param[in] image The image that will be encoded.
+	\param[out] size On success, the most characters any encoding of the image
+		can take, with any options. Doesn't include the '\0'.
 	\return PINTO_RC
+
+	Gives the same errors encoding the image would, so if this succeeds,
+	encoding can only fail if it runs out of memory. Doesn't allocate
+	anything.
+
+	With painter's RLE, a color is only turned on at the start of a run of
+	pixels that are the same, so no matter what order the colors are in, all
+	the colors together have at most 2 values per run of the same opaque
+	pixels. Each color's values add up to at most the amount of pixels, so
+	only so many of them can be big enough to need more than 1 character.
+	Deflating never makes text longer.
 */
-PINTO_RC pintoImageDecodeString( const char *string, PintoImage **image_A )
+PINTO_RC pintoImageEncodedSize( const PintoImage *image, s32 *size )
 {
 	/* DATA */
 	PINTO_RC rc = PINTO_RC_SUCCESS;
 
-	PintoText *text = NULL;
-
+	PintoPalette palette;
 
-	/* PRECOND */
-	FAILURE_POINT;
-	ERR_IF( string == NULL, PINTO_RC_ERROR_PRECOND );
-	ERR_IF( image_A == NULL, PINTO_RC_ERROR_PRECOND );
-	ERR_IF( (*image_A) != NULL, PINTO_RC_ERROR_PRECOND );
+	/* keys of a block of pixels */
+	s32 keys[ PINTO_KEY_BLOCK_SIZE ];
+	s32 blockStart = 0;
+	s32 blockSize = 0;
+	s32 keysConverted = 0;
 
+	s32 pixel = 0;
+	s32 pixelAmount = 0;
+	s32 color = 0;
 
-	/* CODE */
-	/* create our text */
-	rc = pintoTextInit( &text );
-	ERR_IF_PASSTHROUGH;
+	s32 key = 0;
+	s32 previousKey = -2;
 
-	/* add string to our pintoText */
-	while ( (*string) != '\0' )
-	{
-		rc = pintoTextAddChar( text, (*string) );
-		ERR_IF_PASSTHROUGH;
+	/* runs of the same opaque pixels */
+	s32 runs = 0;
 
-		string += 1;
-	}
+	/* RLE values, and how many could need at least 2, 3, 4, or 5 characters */
+	s32 values = 0;
+	s32 bigValues = 0;
+	s32 smallestBigValues[ 4 ] = { 64, 64 * 14, 64 * 64, 64 * 64 * 64 };
+	s32 i = 0;
 
-	/* call the text version */
-	rc = pintoImageDecodeText( &text, image_A );
-	ERR_IF_PASSTHROUGH;
+	s32 newSize = 0;
 
 
-	/* CLEANUP */
-	cleanup:
+	/* PRECOND */
+	ERR_IF( image == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( size == NULL, PINTO_RC_ERROR_PRECOND );
 
-	pintoTextFree( &text );
+
+	/* CODE */
+	ERR_IF_1( image->width  <= 0, PINTO_RC_ERROR_IMAGE_BAD_SIZE, image->width );
+	ERR_IF_1( image->height <= 0, PINTO_RC_ERROR_IMAGE_BAD_SIZE, image->height );
+
+	ERR_IF_1( image->width  > PINTO_MAX_WIDTH,  PINTO_RC_ERROR_IMAGE_BAD_SIZE, image->width );
+	ERR_IF_1( image->height > PINTO_MAX_HEIGHT, PINTO_RC_ERROR_IMAGE_BAD_SIZE, image->height );
+
+	pixelAmount = image->width * image->height;
+
+	/* count colors and runs, the same way pintoPalettize() does */
+	pintoPaletteInit( &palette );
+
+	for ( blockStart = 0; blockStart < pixelAmount; blockStart += PINTO_KEY_BLOCK_SIZE )
+	{
+		blockSize = pixelAmount - blockStart;
+		if ( blockSize > PINTO_KEY_BLOCK_SIZE )
+		{
+			blockSize = PINTO_KEY_BLOCK_SIZE;
+		}
+
+		keysConverted = pintoPixelsToKeys( image->rgba + ( blockStart * 4 ), blockSize, keys );
+
+		for ( pixel = 0; pixel < keysConverted; pixel += 1 )
+		{
+			key = keys[ pixel ];
+
+			if ( key != previousKey && key != -1 )
+			{
+				rc = pintoPaletteGetIndex( &palette, key, &color );
+				ERR_IF_PASSTHROUGH;
+
+				runs += 1;
+			}
+
+			previousKey = key;
+		}
+
+		ERR_IF( keysConverted != blockSize, PINTO_RC_ERROR_IMAGE_PARTIAL_TRANSPARENCY );
+	}
+
+	/* header */
+	newSize =   1
+	          + pintoTextValueSize( image->width )
+	          + pintoTextValueSize( image->height )
+	          + pintoTextValueSize( palette.colorAmount )
+	          + ( palette.colorAmount * 3 );
+
+	/* RLE values, each taking at least 1 character */
+	values = runs * 2;
+	newSize += values;
+
+	/* and each value big enough takes more */
+	for ( i = 0; i < 4; i += 1 )
+	{
+		bigValues = palette.colorAmount * ( pixelAmount / smallestBigValues[ i ] );
+		newSize += ( bigValues < values ? bigValues : values );
+	}
+
+	/* '^' after each color */
+	newSize += palette.colorAmount;
+
+	/* longer encodings fail with PINTO_RC_ERROR_FORMAT_TOO_LONG */
+	if ( newSize > PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT )
+	{
+		newSize = PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT;
+	}
+
+	/* give back */
+	(*size) = newSize;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Encodes an image into the Pinto format, into a buffer.
+	\param[in] image The image to be encoded.
+	\param[in] options Encoding options, or NULL to use the defaults.
+		See pintoEncodeOptionsInit().
+	\param[in] buffer Buffer to put the encoding in.
+	\param[in] bufferSize Size of buffer. pintoImageEncodedSize() gives a size
+		that's always big enough.
+	\param[out] usedSize On success, the length of the encoding. If the
+		buffer is too small, the size it needs to be.
+	\return PINTO_RC
+
+	The encoding is made right in the buffer. If there's room, a '\0' is
+	added after the encoding, which isn't counted in usedSize. If the buffer
+	is too small, returns PINTO_RC_ERROR_BUFFER_TOO_SMALL, and the buffer has
+	only the start of the encoding.
+
+	Only allocates what encoding needs while it works, like the palette
+	index of each pixel. Nothing the size of the encoding is allocated unless
+	it's deflated. Use pintoEncoderEncodeInto() to keep those between encodes.
+*/
+PINTO_RC pintoImageEncodeInto( const PintoImage *image, const PintoEncodeOptions *options, char *buffer, s32 bufferSize, s32 *usedSize )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoEncoder encoder;
+
+
+	/* PRECOND */
+	/* the encoder's only used once, so it doesn't need to be allocated.
+	   cleanup frees its buffers, so it starts empty. */
+	memset( &encoder, 0, sizeof( PintoEncoder ) );
+
+	FAILURE_POINT;
+	ERR_IF( image == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( buffer == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( bufferSize < 0, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( usedSize == NULL, PINTO_RC_ERROR_PRECOND );
+
+
+	/* CODE */
+	rc = pintoEncoderEncodeInto( &encoder, image, options, buffer, bufferSize, usedSize );
+	ERR_IF_PASSTHROUGH;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoEncoderFreeBuffers( &encoder );
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Encodes an image into the Pinto format, into a buffer, using an
+	       encoder's buffers.
+	\param[in] encoder Encoder.
+	\param[in] image The image to be encoded.
+	\param[in] options Encoding options, or NULL to use the defaults.
+	\param[in] buffer Buffer to put the encoding in.
+	\param[in] bufferSize Size of buffer.
+	\param[out] usedSize On success, the length of the encoding. If the
+		buffer is too small, the size it needs to be.
+	\return PINTO_RC
+
+	See pintoImageEncodeInto().
+*/
+PINTO_RC pintoEncoderEncodeInto( PintoEncoder *encoder, const PintoImage *image, const PintoEncodeOptions *options, char *buffer, s32 bufferSize, s32 *usedSize )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoText bufferText;
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( encoder == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( image == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( buffer == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( bufferSize < 0, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( usedSize == NULL, PINTO_RC_ERROR_PRECOND );
+
+
+	/* CODE */
+	/* characters that don't fit are still counted, so we know the size the
+	   buffer needs to be */
+	pintoTextInitBuffer( &bufferText, buffer, bufferSize );
+
+	rc = pintoEncode( encoder, image, options, &bufferText, NULL );
+	ERR_IF_PASSTHROUGH;
+
+	(*usedSize) = bufferText.usedSize + bufferText.writtenSize;
+
+	ERR_IF( bufferText.writtenSize > 0, PINTO_RC_ERROR_BUFFER_TOO_SMALL );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Encodes an image into the Pinto format, giving the encoding to a
+	       sink as it's made.
+	\param[in] image The image to be encoded.
+	\param[in] options Encoding options, or NULL to use the defaults.
+		See pintoEncodeOptionsInit().
+	\param[in] writeFunc Function to give the encoding to, a piece at a time.
+		See pintoFileWrite() to write to a FILE *.
+	\param[in] userData Passed to writeFunc.
+	\return PINTO_RC
+
+	Gives the same encoding as pintoImageEncodeEx(), without ever holding all
+	of it. The encoding is given to writeFunc in pieces of at most 4096
+	characters. PINTO_LEVEL_MAX still holds the whole
+	encoding, since it needs it to pick the smallest one. If an error happens,
+	writeFunc may have already been given part of the encoding.
+*/
+PINTO_RC pintoImageEncodeToSink( const PintoImage *image, const PintoEncodeOptions *options, PintoWriteFunc writeFunc, void *userData )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoEncoder *encoder = NULL;
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( image == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( writeFunc == NULL, PINTO_RC_ERROR_PRECOND );
+
+
+	/* CODE */
+	rc = pintoEncoderInit( &encoder );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoEncoderEncodeToSink( encoder, image, options, writeFunc, userData );
+	ERR_IF_PASSTHROUGH;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoEncoderFree( &encoder );
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Encodes an image into the Pinto format, giving the encoding to a
+	       sink as it's made, using an encoder's buffers.
+	\param[in] encoder Encoder.
+	\param[in] image The image to be encoded.
+	\param[in] options Encoding options, or NULL to use the defaults.
+	\param[in] writeFunc Function to give the encoding to, a piece at a time.
+	\param[in] userData Passed to writeFunc.
+	\return PINTO_RC
+
+	See pintoImageEncodeToSink().
+*/
+PINTO_RC pintoEncoderEncodeToSink( PintoEncoder *encoder, const PintoImage *image, const PintoEncodeOptions *options, PintoWriteFunc writeFunc, void *userData )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( encoder == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( image == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( writeFunc == NULL, PINTO_RC_ERROR_PRECOND );
+
+
+	/* CODE */
+	rc = pintoEncoderSetSink( encoder, writeFunc, userData );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoEncode( encoder, image, options, encoder->sinkText, NULL );
+	ERR_IF_PASSTHROUGH;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief A PintoWriteFunc that writes to a file.
+	\param[in] file The FILE * to write to.
+	\param[in] data Characters to write.
+	\param[in] size Amount of characters.
+	\return 0 on success.
+*/
+s32 pintoFileWrite( void *file, const char *data, s32 size )
+{
+	/* CODE */
+	if ( fwrite( data, 1, (size_t) size, (FILE *) file ) != (size_t) size )
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
+/******************************************************************************/
+/*!
+	\brief Sets up an image view of pixels.
+	\param[in] view View to set up.
+	\param[in] width Width.
+	\param[in] height Height.
+	\param[in] format One of the PINTO_FORMAT_* values.
+	\param[in] pixels First pixel of the first row.
+	\return void
+
+	The rows are right after each other, there's no color key, and the
+	threshold is 0. Change the view's fields after this for anything else.
+*/
+void pintoImageViewInit( PintoImageView *view, s32 width, s32 height, s32 format, const u8 *pixels )
+{
+	/* CODE */
+	view->width = width;
+	view->height = height;
+	view->format = format;
+	view->pixels = pixels;
+	view->stride = 0;
+	view->colorKey = -1;
+	view->threshold = 0;
+
+	return;
+}
+
+/******************************************************************************/
+/*!
+	\brief Encodes an image view into the Pinto format.
+	\param[in] view The image view to be encoded.
+	\param[in] options Encoding options, or NULL to use the defaults.
+		See pintoEncodeOptionsInit().
+	\param[out] string_A On success, the string that contains the encoded image.
+		Will be allocated. The caller is responsible for freeing.
+	\return PINTO_RC
+
+	The pixels are read where they are, so nothing is copied or converted
+	first. Gives the exact same encoding as pintoImageEncodeEx() would for the
+	same image in RGBA.
+*/
+PINTO_RC pintoImageViewEncode( const PintoImageView *view, const PintoEncodeOptions *options, char **string_A )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoEncoder *encoder = NULL;
+	PintoText *encodedText = NULL;
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	rc = pintoImageViewCheck( view );
+	ERR_IF_PASSTHROUGH;
+	ERR_IF( string_A == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( (*string_A) != NULL, PINTO_RC_ERROR_PRECOND );
+
+
+	/* CODE */
+	rc = pintoEncoderInit( &encoder );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoEncodeView( encoder, view, options, NULL, &encodedText );
+	ERR_IF_PASSTHROUGH;
+
+	/* give back, taking the string from the encoder so we don't have to copy
+	   it */
+	(*string_A) = encodedText->string;
+	encodedText->string = NULL;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoEncoderFree( &encoder );
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Encodes an image view into the Pinto format, using an encoder's
+	       buffers.
+	\param[in] encoder Encoder.
+	\param[in] view The image view to be encoded.
+	\param[in] options Encoding options, or NULL to use the defaults.
+		See pintoEncodeOptionsInit().
+	\param[out] string On success, the string that contains the encoded image.
+		Belongs to the encoder, and is only valid until the encoder is used
+		again or freed.
+	\return PINTO_RC
+
+	See pintoImageViewEncode().
+*/
+PINTO_RC pintoEncoderEncodeView( PintoEncoder *encoder, const PintoImageView *view, const PintoEncodeOptions *options, const char **string )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoText *encodedText = NULL;
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( encoder == NULL, PINTO_RC_ERROR_PRECOND );
+	rc = pintoImageViewCheck( view );
+	ERR_IF_PASSTHROUGH;
+	ERR_IF( string == NULL, PINTO_RC_ERROR_PRECOND );
+
+
+	/* CODE */
+	(*string) = NULL;
+
+	rc = pintoEncodeView( encoder, view, options, NULL, &encodedText );
+	ERR_IF_PASSTHROUGH;
+
+	(*string) = encodedText->string;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Checks the parts of an image view that aren't checked while
+	       encoding.
+	\param[in] view Image view.
+	\return PINTO_RC
+*/
+static PINTO_RC pintoImageViewCheck( const PintoImageView *view )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+
+	/* CODE */
+	ERR_IF( view == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF_1( pintoFormatPixelSize( view->format ) == 0, PINTO_RC_ERROR_PRECOND, view->format );
+	ERR_IF( view->pixels == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF_1( view->format == PINTO_FORMAT_RGB && ( view->colorKey < -1 || view->colorKey > 0xFFFFFF ), PINTO_RC_ERROR_PRECOND, view->colorKey );
+	ERR_IF_1( view->format == PINTO_FORMAT_GRAY && ( view->threshold < 0 || view->threshold > 256 ), PINTO_RC_ERROR_PRECOND, view->threshold );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Encodes an image that already has a palette into the Pinto format.
+	\param[in] image The image to be encoded.
+	\param[in] options Encoding options, or NULL to use the defaults.
+		See pintoEncodeOptionsInit().
+	\param[out] string_A On success, the string that contains the encoded image.
+		Will be allocated. The caller is responsible for freeing.
+	\return PINTO_RC
+
+	Gives the exact same encoding as pintoImageEncodeEx() would for the same
+	image in RGBA, but without needing the RGBA, and each palette color is
+	only looked up once. Palette colors that aren't used don't count toward
+	PINTO_MAX_COLORS. A pixel whose index isn't in the palette, and isn't the
+	transparent index, gives PINTO_RC_ERROR_PRECOND.
+*/
+PINTO_RC pintoIndexedImageEncode( const PintoIndexedImage *image, const PintoEncodeOptions *options, char **string_A )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoEncodeOptions defaultOptions;
+
+	PintoEncoder *encoder = NULL;
+	PintoText *encodedText = NULL;
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( image == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( image->indexes == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF_1( image->colorAmount < 0 || image->colorAmount > 256, PINTO_RC_ERROR_PRECOND, image->colorAmount );
+	ERR_IF( image->palette == NULL && image->colorAmount > 0, PINTO_RC_ERROR_PRECOND );
+	ERR_IF_1( image->transparentIndex < -1 || image->transparentIndex > 255, PINTO_RC_ERROR_PRECOND, image->transparentIndex );
+	ERR_IF( string_A == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( (*string_A) != NULL, PINTO_RC_ERROR_PRECOND );
+
+	if ( options == NULL )
+	{
+		pintoEncodeOptionsInit( &defaultOptions );
+		options = &defaultOptions;
+	}
+
+	ERR_IF_1( options->level < PINTO_LEVEL_NONE || options->level > PINTO_LEVEL_MAX, PINTO_RC_ERROR_PRECOND, options->level );
+	ERR_IF_1( options->threadCount < 1 || options->threadCount > PINTO_MAX_THREADS, PINTO_RC_ERROR_PRECOND, options->threadCount );
+
+
+	/* CODE */
+
+	/* check size */
+	ERR_IF_1( image->width  <= 0, PINTO_RC_ERROR_IMAGE_BAD_SIZE, image->width );
+	ERR_IF_1( image->height <= 0, PINTO_RC_ERROR_IMAGE_BAD_SIZE, image->height );
+
+	ERR_IF_1( image->width  > PINTO_MAX_WIDTH,  PINTO_RC_ERROR_IMAGE_BAD_SIZE, image->width );
+	ERR_IF_1( image->height > PINTO_MAX_HEIGHT, PINTO_RC_ERROR_IMAGE_BAD_SIZE, image->height );
+
+	rc = pintoEncoderInit( &encoder );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoEncoderGrow( encoder, image->width * image->height );
+	ERR_IF_PASSTHROUGH;
+
+	pintoPaletteInit( &encoder->palette );
+
+	rc = pintoPalettizeIndexed( image, &encoder->palette, encoder->indexedData );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoEncodeIndexed( encoder, image->width, image->height, options, NULL, &encodedText );
+	ERR_IF_PASSTHROUGH;
+
+	/* give back, taking the string from the encoder so we don't have to copy
+	   it */
+	(*string_A) = encodedText->string;
+	encodedText->string = NULL;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoEncoderFree( &encoder );
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Starts encoding an image a row at a time.
+	\param[in] encoder Encoder.
+	\param[in] width Width of the image.
+	\param[in] height Height of the image.
+	\param[in] options Encoding options, or NULL to use the defaults.
+		See pintoEncodeOptionsInit().
+	\return PINTO_RC
+
+	Add the rows with pintoEncoderAddRows(), and then get the encoding with
+	pintoEncoderFinish() or pintoEncoderFinishToSink(). Each row is turned
+	into palette indexes as it's added, so only 1 byte per pixel is held
+	instead of the whole image's RGBA. Gives the exact same encoding as
+	pintoImageEncodeEx().
+
+	Starting again, or encoding a whole image with the encoder, drops any
+	image that was being encoded a row at a time.
+*/
+PINTO_RC pintoEncoderBegin( PintoEncoder *encoder, s32 width, s32 height, const PintoEncodeOptions *options )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( encoder == NULL, PINTO_RC_ERROR_PRECOND );
+
+	encoder->rowHeight = 0;
+
+	if ( options == NULL )
+	{
+		pintoEncodeOptionsInit( &encoder->rowOptions );
+	}
+	else
+	{
+		encoder->rowOptions = (*options);
+	}
+
+	ERR_IF_1( encoder->rowOptions.level < PINTO_LEVEL_NONE || encoder->rowOptions.level > PINTO_LEVEL_MAX, PINTO_RC_ERROR_PRECOND, encoder->rowOptions.level );
+	ERR_IF_1( encoder->rowOptions.threadCount < 1 || encoder->rowOptions.threadCount > PINTO_MAX_THREADS, PINTO_RC_ERROR_PRECOND, encoder->rowOptions.threadCount );
+
+
+	/* CODE */
+
+	/* check size */
+	ERR_IF_1( width  <= 0, PINTO_RC_ERROR_IMAGE_BAD_SIZE, width );
+	ERR_IF_1( height <= 0, PINTO_RC_ERROR_IMAGE_BAD_SIZE, height );
+
+	ERR_IF_1( width  > PINTO_MAX_WIDTH,  PINTO_RC_ERROR_IMAGE_BAD_SIZE, width );
+	ERR_IF_1( height > PINTO_MAX_HEIGHT, PINTO_RC_ERROR_IMAGE_BAD_SIZE, height );
+
+	rc = pintoEncoderGrow( encoder, width * height );
+	ERR_IF_PASSTHROUGH;
+
+	pintoPaletteInit( &encoder->palette );
+
+	encoder->rowWidth = width;
+	encoder->rowHeight = height;
+	encoder->rowsAdded = 0;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Adds rows to the image being encoded a row at a time.
+	\param[in] encoder Encoder. pintoEncoderBegin() must have been called.
+	\param[in] rgba Red, green, blue, and alpha of the rows' pixels. Size is
+		(width * rowAmount * 4). Isn't needed once this returns.
+	\param[in] rowAmount Amount of rows. Can't go past the image's height.
+	\return PINTO_RC
+
+	Gives the same errors for the rows as pintoImageEncodeEx() would give for
+	the whole image, as soon as the rows are added. After an error, the image
+	is dropped, and pintoEncoderBegin() must be called again.
+*/
+PINTO_RC pintoEncoderAddRows( PintoEncoder *encoder, const u8 *rgba, s32 rowAmount )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoImageView rows;
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( encoder == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( encoder->rowHeight == 0, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( rgba == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF_1( rowAmount <= 0 || rowAmount > encoder->rowHeight - encoder->rowsAdded, PINTO_RC_ERROR_PRECOND, rowAmount );
+
+
+	/* CODE */
+	pintoImageViewInit( &rows, encoder->rowWidth, rowAmount, PINTO_FORMAT_RGBA, rgba );
+	rows.stride = encoder->rowWidth * 4;
+
+	if ( encoder->rowOptions.threadCount > 1 )
+	{
+		rc = pintoPalettizeParallel( &rows, encoder->rowOptions.threadCount, &encoder->palette, encoder->indexedData + ( encoder->rowsAdded * encoder->rowWidth ) );
+		ERR_IF_PASSTHROUGH;
+	}
+	else
+	{
+		rc = pintoPalettize( &rows, &encoder->palette, encoder->indexedData + ( encoder->rowsAdded * encoder->rowWidth ) );
+		ERR_IF_PASSTHROUGH;
+	}
+
+	encoder->rowsAdded += rowAmount;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	if ( rc != PINTO_RC_SUCCESS && encoder != NULL )
+	{
+		encoder->rowHeight = 0;
+	}
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Finishes encoding an image a row at a time.
+	\param[in] encoder Encoder. All the image's rows must have been added.
+	\param[out] string On success, the string that contains the encoded image.
+		Belongs to the encoder, and is only valid until the encoder is used
+		again or freed.
+	\return PINTO_RC
+*/
+PINTO_RC pintoEncoderFinish( PintoEncoder *encoder, const char **string )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoText *encodedText = NULL;
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( encoder == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( encoder->rowHeight == 0, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( encoder->rowsAdded != encoder->rowHeight, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( string == NULL, PINTO_RC_ERROR_PRECOND );
+
+
+	/* CODE */
+	(*string) = NULL;
+
+	/* the image is used up, even if encoding fails */
+	encoder->rowHeight = 0;
+
+	rc = pintoEncodeIndexed( encoder, encoder->rowWidth, encoder->rowsAdded, &encoder->rowOptions, NULL, &encodedText );
+	ERR_IF_PASSTHROUGH;
+
+	(*string) = encodedText->string;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Finishes encoding an image a row at a time, giving the encoding to
+	       a sink as it's made.
+	\param[in] encoder Encoder. All the image's rows must have been added.
+	\param[in] writeFunc Function to give the encoding to, a piece at a time.
+	\param[in] userData Passed to writeFunc.
+	\return PINTO_RC
+
+	See pintoImageEncodeToSink().
+*/
+PINTO_RC pintoEncoderFinishToSink( PintoEncoder *encoder, PintoWriteFunc writeFunc, void *userData )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( encoder == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( encoder->rowHeight == 0, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( encoder->rowsAdded != encoder->rowHeight, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( writeFunc == NULL, PINTO_RC_ERROR_PRECOND );
+
+
+	/* CODE */
+	encoder->rowHeight = 0;
+
+	rc = pintoEncoderSetSink( encoder, writeFunc, userData );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoEncodeIndexed( encoder, encoder->rowWidth, encoder->rowsAdded, &encoder->rowOptions, encoder->sinkText, NULL );
+	ERR_IF_PASSTHROUGH;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Encodes an image into the Pinto format, using an encoder's buffers.
+	\param[in] encoder Encoder.
+	\param[in] image The image to be encoded.
+	\param[in] options Encoding options, or NULL to use the defaults.
+	\param[in] outText Text to add the encoding to as it's made, or NULL.
+		Can give it to a sink, or be over a fixed buffer.
+	\param[out] encodedText_A If outText is NULL, on success, the encoder's
+		text that holds the encoded image.
+	\return PINTO_RC
+*/
+static PINTO_RC pintoEncode( PintoEncoder *encoder, const PintoImage *image, const PintoEncodeOptions *options, PintoText *outText, PintoText **encodedText_A )
+{
+	/* DATA */
+	PintoImageView view;
+
+
+	/* CODE */
+	pintoImageViewInit( &view, image->width, image->height, PINTO_FORMAT_RGBA, image->rgba );
+
+	return pintoEncodeView( encoder, &view, options, outText, encodedText_A );
+}
+
+/******************************************************************************/
+/*!
+	\brief Encodes an image view into the Pinto format, using an encoder's
+	       buffers.
+	\param[in] encoder Encoder.
+	\param[in] view The image view to be encoded. Its format and pixels must
+		already be checked.
+	\param[in] options Encoding options, or NULL to use the defaults.
+	\param[in] outText Text to add the encoding to as it's made, or NULL.
+		Can give it to a sink, or be over a fixed buffer.
+	\param[out] encodedText_A If outText is NULL, on success, the encoder's
+		text that holds the encoded image.
+	\return PINTO_RC
+*/
+static PINTO_RC pintoEncodeView( PintoEncoder *encoder, const PintoImageView *view, const PintoEncodeOptions *options, PintoText *outText, PintoText **encodedText_A )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoEncodeOptions defaultOptions;
+
+	PintoImageView strideView;
+	s32 rowSize = 0;
+
+
+	/* PRECOND */
+	if ( options == NULL )
+	{
+		pintoEncodeOptionsInit( &defaultOptions );
+		options = &defaultOptions;
+	}
+
+	ERR_IF_1( options->level < PINTO_LEVEL_NONE || options->level > PINTO_LEVEL_MAX, PINTO_RC_ERROR_PRECOND, options->level );
+	ERR_IF_1( options->threadCount < 1 || options->threadCount > PINTO_MAX_THREADS, PINTO_RC_ERROR_PRECOND, options->threadCount );
+
+
+	/* CODE */
+
+	/* this uses the same buffers as encoding a row at a time, so any row
+	   encoding that was going on is over */
+	encoder->rowHeight = 0;
+
+	/* check size */
+	ERR_IF_1( view->width  <= 0, PINTO_RC_ERROR_IMAGE_BAD_SIZE, view->width );
+	ERR_IF_1( view->height <= 0, PINTO_RC_ERROR_IMAGE_BAD_SIZE, view->height );
+
+	ERR_IF_1( view->width  > PINTO_MAX_WIDTH,  PINTO_RC_ERROR_IMAGE_BAD_SIZE, view->width );
+	ERR_IF_1( view->height > PINTO_MAX_HEIGHT, PINTO_RC_ERROR_IMAGE_BAD_SIZE, view->height );
+
+	/* rows can't overlap */
+	strideView = (*view);
+	rowSize = view->width * pintoFormatPixelSize( view->format );
+
+	if ( strideView.stride == 0 )
+	{
+		strideView.stride = rowSize;
+	}
+
+	ERR_IF_1( strideView.stride < rowSize && strideView.stride > -rowSize, PINTO_RC_ERROR_PRECOND, strideView.stride );
+
+	rc = pintoEncoderGrow( encoder, view->width * view->height );
+	ERR_IF_PASSTHROUGH;
+
+	/* determine palette */
+	pintoPaletteInit( &encoder->palette );
+
+	if ( options->threadCount > 1 )
+	{
+		rc = pintoPalettizeParallel( &strideView, options->threadCount, &encoder->palette, encoder->indexedData );
+		ERR_IF_PASSTHROUGH;
+	}
+	else
+	{
+		rc = pintoPalettize( &strideView, &encoder->palette, encoder->indexedData );
+		ERR_IF_PASSTHROUGH;
+	}
+
+	rc = pintoEncodeIndexed( encoder, view->width, view->height, options, outText, encodedText_A );
+	ERR_IF_PASSTHROUGH;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Grows an encoder's indexed data if it's too small.
+	\param[in] encoder Encoder.
+	\param[in] pixelAmount Amount of pixels it needs room for.
+	\return PINTO_RC
+*/
+static PINTO_RC pintoEncoderGrow( PintoEncoder *encoder, s32 pixelAmount )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( encoder == NULL );
+
+	/* this is the palette-ized version of the image. instead of rgba, it'll
+	   hold the index of the color, with -1 being a special case of
+	   transparent. */
+	if ( pixelAmount > encoder->indexedDataSize )
+	{
+		PINTO_HOOK_FREE( encoder->indexedData );
+		encoder->indexedData = NULL;
+
+		PINTO_HOOK_FREE( encoder->sequence );
+		encoder->sequence = NULL;
+
+		encoder->indexedDataSize = 0;
+
+		PINTO_MALLOC( encoder->indexedData, char, pixelAmount );
+		encoder->indexedDataSize = pixelAmount;
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Encodes an image that's already been palettized into an encoder's
+	       palette and indexed data.
+	\param[in] encoder Encoder.
+	\param[in] width Width of the image.
+	\param[in] height Height of the image.
+	\param[in] options Encoding options. Must already be checked.
+	\param[in] outText Text to add the encoding to as it's made, or NULL.
+		Can give it to a sink, or be over a fixed buffer.
+	\param[out] encodedText_A If outText is NULL, on success, the encoder's
+		text that holds the encoded image.
+	\return PINTO_RC
+*/
+static PINTO_RC pintoEncodeIndexed( PintoEncoder *encoder, s32 width, s32 height, const PintoEncodeOptions *options, PintoText *outText, PintoText **encodedText_A )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoText *newText = NULL;
+	PintoText *encodedText = NULL;
+	PintoPalette *palette = &encoder->palette;
+
+	/* This is the indexed image data.
+	   Instead of holding RGB, it holds an index into the palette.
+	   The special value -1 is for transparent pixels. */
+	char *indexedData = encoder->indexedData;
+
+	s32 pixelAmount = width * height;
+
+	s32 color = 0;
+
+	s32 colorAmount = 0;
+
+	char needToAddStandardHeader = 1;
+
+	s32 chainDepth = 0;
+
+
+	/* CODE */
+	if ( options->reorderColors )
+	{
+		if ( encoder->sequence == NULL )
+		{
+			PINTO_MALLOC( encoder->sequence, char, encoder->indexedDataSize );
+		}
+
+		pintoPaletteReorder( palette, indexedData, pixelAmount, encoder->sequence );
+	}
+
+	colorAmount = palette->colorAmount;
+
+	/* we've created out palette, now lets start creating the pinto encoding */
+
+	/* create text. text that isn't deflated goes straight to outText. */
+	if ( options->level == PINTO_LEVEL_NONE && outText != NULL )
+	{
+		newText = outText;
+	}
+	else
+	{
+		rc = pintoEncoderGetText( &encoder->text );
+		ERR_IF_PASSTHROUGH;
+
+		newText = encoder->text;
+	}
+
+	/* See if it's a certain image, and we can use a shorter header */
+	if (    colorAmount == 1
+	     && palette->colors[ 0 ] == 0 && palette->colors[ 1 ] == 0 && palette->colors[ 2 ] == 0
+	     && width == height
+	   )
+	{
+		if ( width == 8 )
+		{
+			rc = pintoTextAddChar( newText, '0' );
+			ERR_IF_PASSTHROUGH;
+
+			needToAddStandardHeader = 0;
+		}
+		if ( width == 16 )
+		{
+			rc = pintoTextAddChar( newText, '1' );
+			ERR_IF_PASSTHROUGH;
+
+			needToAddStandardHeader = 0;
+		}
+		else if ( width == 32 )
+		{
+			rc = pintoTextAddChar( newText, '2' );
+			ERR_IF_PASSTHROUGH;
+
+			needToAddStandardHeader = 0;
+		}
+		else if ( width == 64 )
+		{
+			rc = pintoTextAddChar( newText, '3' );
+			ERR_IF_PASSTHROUGH;
+
+			needToAddStandardHeader = 0;
+		}
+		else if ( width == 128 )
+		{
+			rc = pintoTextAddChar( newText, '4' );
+			ERR_IF_PASSTHROUGH;
+
+			needToAddStandardHeader = 0;
+		}
+		else if ( width == 256 )
+		{
+			rc = pintoTextAddChar( newText, '5' );
+			ERR_IF_PASSTHROUGH;
+
+			needToAddStandardHeader = 0;
+		}
+		else if ( width == 512 )
+		{
+			rc = pintoTextAddChar( newText, '6' );
+			ERR_IF_PASSTHROUGH;
+
+			needToAddStandardHeader = 0;
+		}
+		else if ( width == 1024 )
+		{
+			rc = pintoTextAddChar( newText, '7' );
+			ERR_IF_PASSTHROUGH;
+
+			needToAddStandardHeader = 0;
+		}
+		else if ( width == 2048 )
+		{
+			rc = pintoTextAddChar( newText, '8' );
+			ERR_IF_PASSTHROUGH;
+
+			needToAddStandardHeader = 0;
+		}
+		else if ( width == 4096 )
+		{
+			rc = pintoTextAddChar( newText, '9' );
+			ERR_IF_PASSTHROUGH;
+
+			needToAddStandardHeader = 0;
+		}
+	}
+
+	if ( needToAddStandardHeader )
+	{
+			/* 'a' means standard header follows */
+			rc = pintoTextAddChar( newText, 'a' );
+			ERR_IF_PASSTHROUGH;
+
+			/* add width */
+			rc = pintoTextAddValue( newText, width );
+			ERR_IF_PASSTHROUGH;
+
+			/* add height */
+			rc = pintoTextAddValue( newText, height );
+			ERR_IF_PASSTHROUGH;
+
+			/* add colorAmount */
+			rc = pintoTextAddValue( newText, colorAmount );
+			ERR_IF_PASSTHROUGH;
+
+			/* add colors to palette */
+			for ( color = 0; color < ( colorAmount * 3 ); color += 1 )
+			{
+				/* divide by 4 because pinto's colors are 6-bit */
+				rc = pintoTextAddChar( newText, valueToChar[ palette->colors[ color ] / 4 ] );
+				ERR_IF_PASSTHROUGH;
+			}
+	}
+
+	/* add RLE data */
+	for ( color = 0; color < colorAmount; color += 1 )
+	{
+		rc = pintoEncoderGetText( &encoder->colorTexts[ color ] );
+		ERR_IF_PASSTHROUGH;
+	}
+
+	if ( options->threadCount > 1 && colorAmount > 1 )
+	{
+		rc = pintoRleEncodeColorsParallel( indexedData, pixelAmount, colorAmount, options->threadCount, encoder->colorTexts );
+		ERR_IF_PASSTHROUGH;
+	}
+	else
+	{
+		rc = pintoRleEncodeColors( indexedData, pixelAmount, 0, colorAmount, encoder->colorTexts );
+		ERR_IF_PASSTHROUGH;
+	}
+
+	for ( color = 0; color < colorAmount; color += 1 )
+	{
+		rc = pintoTextAddText( newText, encoder->colorTexts[ color ] );
+		ERR_IF_PASSTHROUGH;
+	}
+
+	/* deflate */
+	if ( options->level == PINTO_LEVEL_NONE )
+	{
+		/* text that isn't deflated is still valid to inflate, since RLE data
+		   never has '?' or '@' */
+		encodedText = newText;
+	}
+	else
+	{
+		if ( encoder->finder == NULL )
+		{
+			PINTO_MALLOC( encoder->finder, PintoMatchFinder, 1 );
+		}
+
+		if ( options->level == PINTO_LEVEL_MAX )
+		{
+			if ( encoder->parser == NULL )
+			{
+				PINTO_MALLOC( encoder->parser, PintoOptimalParser, 1 );
+			}
+
+			/* we need both deflates whole to know which is smaller, so these
+			   don't go straight to outText */
+			rc = pintoEncoderGetText( &encoder->deflatedText );
+			ERR_IF_PASSTHROUGH;
+
+			rc = pintoEncoderGetText( &encoder->greedyText );
+			ERR_IF_PASSTHROUGH;
+
+			rc = pintoDeflateSmallest( encoder->finder, encoder->parser, newText, encoder->deflatedText, encoder->greedyText, &encodedText );
+			ERR_IF_PASSTHROUGH;
+		}
+		else
+		{
+			/* greedy deflate only ever adds to the end, so it can go straight
+			   to outText */
+			if ( outText != NULL )
+			{
+				encodedText = outText;
+			}
+			else
+			{
+				rc = pintoEncoderGetText( &encoder->deflatedText );
+				ERR_IF_PASSTHROUGH;
+
+				encodedText = encoder->deflatedText;
+			}
+
+			chainDepth = ( options->level == PINTO_LEVEL_FAST ? PINTO_DEFLATE_CHAIN_DEPTH_FAST : PINTO_DEFLATE_CHAIN_DEPTH_MAX );
+
+			pintoMatchFinderReset( encoder->finder, newText->string, newText->usedSize, chainDepth );
+
+			if ( options->threadCount > 1 )
+			{
+				rc = pintoDeflateParallel( encoder->finder, options->threadCount, encodedText );
+				ERR_IF_PASSTHROUGH;
+			}
+			else
+			{
+				rc = pintoDeflateGreedy( encoder->finder, encodedText );
+				ERR_IF_PASSTHROUGH;
+			}
+		}
+	}
+
+	/* give the rest to outText, and then to its sink */
+	if ( outText != NULL )
+	{
+		if ( encodedText != outText )
+		{
+			rc = pintoTextAddText( outText, encodedText );
+			ERR_IF_PASSTHROUGH;
+		}
+
+		if ( outText->writeFunc != NULL )
+		{
+			rc = pintoTextFlush( outText );
+			ERR_IF_PASSTHROUGH;
+		}
+	}
+	else
+	{
+		(*encodedText_A) = encodedText;
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Gets one of an encoder's texts ready to be used, creating it if it
+	       doesn't exist yet.
+	\param[in] text The encoder's text. If not NULL, it's emptied, but keeps
+		its buffer.
+	\return PINTO_RC
+*/
+static PINTO_RC pintoEncoderGetText( PintoText **text )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( text == NULL );
+
+	if ( (*text) == NULL )
+	{
+		rc = pintoTextInit( text );
+		ERR_IF_PASSTHROUGH;
+	}
+	else
+	{
+		pintoTextReset( (*text) );
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Gets an encoder's text that gives to a sink ready, creating it if it
+	       doesn't exist yet.
+	\param[in] encoder Encoder.
+	\param[in] writeFunc Function to give the characters to.
+	\param[in] userData Passed to writeFunc.
+	\return PINTO_RC
+*/
+static PINTO_RC pintoEncoderSetSink( PintoEncoder *encoder, PintoWriteFunc writeFunc, void *userData )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( encoder == NULL );
+	PARANOID_ERR_IF( writeFunc == NULL );
+
+	if ( encoder->sinkText == NULL )
+	{
+		rc = pintoTextInitSink( &encoder->sinkText );
+		ERR_IF_PASSTHROUGH;
+	}
+
+	pintoTextSetSink( encoder->sinkText, writeFunc, userData );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Adds pixels' colors to a palette, and sets each pixel's index.
+	\param[in] view Pixels. Its stride can't be 0.
+	\param[in] palette Palette to add colors to.
+	\param[out] indexedData Index of each pixel, or -1 for transparent.
+	\return PINTO_RC
+*/
+static PINTO_RC pintoPalettize( const PintoImageView *view, PintoPalette *palette, char *indexedData )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	/* keys of a block of pixels */
+	s32 keys[ PINTO_KEY_BLOCK_SIZE ];
+	s32 blockStart = 0;
+	s32 blockSize = 0;
+	s32 keysConverted = 0;
+
+	s32 pixelSize = 0;
+	s32 rowPixels = 0;
+	s32 rowAmount = 0;
+	s32 row = 0;
+	const u8 *rowData = NULL;
+	char *rowIndexedData = NULL;
+
+	s32 pixel = 0;
+	s32 color = 0;
+
+	s32 key = 0;
+	s32 previousKey = -1;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( view == NULL );
+	PARANOID_ERR_IF( palette == NULL );
+	PARANOID_ERR_IF( indexedData == NULL );
+
+	pixelSize = pintoFormatPixelSize( view->format );
+
+	/* if rows are right after each other, do them as one long row */
+	rowPixels = view->width;
+	rowAmount = view->height;
+
+	if ( view->stride == view->width * pixelSize )
+	{
+		rowPixels = view->width * view->height;
+		rowAmount = 1;
+	}
+
+	/* foreach row */
+	for ( row = 0; row < rowAmount; row += 1 )
+	{
+		rowData = view->pixels + ( row * view->stride );
+		rowIndexedData = indexedData + ( row * rowPixels );
+
+		/* foreach block of pixels */
+		for ( blockStart = 0; blockStart < rowPixels; blockStart += PINTO_KEY_BLOCK_SIZE )
+		{
+			blockSize = rowPixels - blockStart;
+			if ( blockSize > PINTO_KEY_BLOCK_SIZE )
+			{
+				blockSize = PINTO_KEY_BLOCK_SIZE;
+			}
+
+			/* get each pixel's key, which stops early at a partially
+			   transparent pixel */
+			keysConverted = pintoViewPixelsToKeys( view, rowData + ( blockStart * pixelSize ), blockSize, keys );
+
+			/* foreach pixel */
+			for ( pixel = 0; pixel < keysConverted; pixel += 1 )
+			{
+				key = keys[ pixel ];
+
+				/* fully transparent */
+				if ( key == -1 )
+				{
+					/* mark pixel in data as transparent */
+					rowIndexedData[ blockStart + pixel ] = -1;
+
+					continue;
+				}
+
+				/* neighboring pixels are usually the same color, so only look
+				   in the palette if it's different from the last one */
+				if ( key != previousKey )
+				{
+					rc = pintoPaletteGetIndex( palette, key, &color );
+					ERR_IF_PASSTHROUGH;
+
+					previousKey = key;
+				}
+
+				/* mark this pixel in data */
+				rowIndexedData[ blockStart + pixel ] = (char) color;
+			}
+
+			/* if alpha is not 0 or 255, it's partially transparent, and not
+			   allowed */
+			ERR_IF( keysConverted != blockSize, PINTO_RC_ERROR_IMAGE_PARTIAL_TRANSPARENCY );
+		}
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Same as pintoPalettize(), but for an image that already has a
+	       palette.
+	\param[in] image Image.
+	\param[in] palette Empty palette to add colors to.
+	\param[out] indexedData Index of each pixel, or -1 for transparent.
+	\return PINTO_RC
+
+	Each of the image's palette indexes is mapped to our palette's index the
+	first time it's seen, in pixel order, so colors are added in the same
+	order as they would be from RGBA.
+*/
+static PINTO_RC pintoPalettizeIndexed( const PintoIndexedImage *image, PintoPalette *palette, char *indexedData )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	/* our palette index of each of the image's indexes, -1 for transparent,
+	   or PINTO_INDEX_NOT_SEEN */
+	char indexMap[ 256 ];
+
+	const u8 *indexes = NULL;
+	const u8 *rgb = NULL;
+
+	s32 pixelAmount = 0;
+	s32 pixel = 0;
+	s32 index = 0;
+	s32 color = 0;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( image == NULL );
+	PARANOID_ERR_IF( palette == NULL );
+	PARANOID_ERR_IF( indexedData == NULL );
+
+	indexes = image->indexes;
+	pixelAmount = image->width * image->height;
+
+	memset( indexMap, PINTO_INDEX_NOT_SEEN, 256 );
+
+	if ( image->transparentIndex != -1 )
+	{
+		indexMap[ image->transparentIndex ] = -1;
+	}
+
+	for ( pixel = 0; pixel < pixelAmount; pixel += 1 )
+	{
+		index = indexes[ pixel ];
+
+		if ( indexMap[ index ] == PINTO_INDEX_NOT_SEEN )
+		{
+			ERR_IF_1( index >= image->colorAmount, PINTO_RC_ERROR_PRECOND, index );
+
+			rgb = image->palette + ( index * 3 );
+
+			rc = pintoPaletteGetIndex( palette, PINTO_PALETTE_KEY( rgb[ 0 ], rgb[ 1 ], rgb[ 2 ] ), &color );
+			ERR_IF_PASSTHROUGH;
+
+			indexMap[ index ] = (char) color;
+		}
+
+		indexedData[ pixel ] = indexMap[ index ];
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Same as pintoPalettize(), but splits the image into bands of rows
+	       that are palettized on their own threads.
+	\param[in] view Pixels. Its stride can't be 0.
+	\param[in] threadCount Amount of threads to use.
+	\param[in] palette Palette to add colors to.
+	\param[out] indexedData Index of each pixel, or -1 for transparent.
+	\return PINTO_RC
+
+	Each band gets its own palette. The band palettes are then merged in band
+	order, which gives the same colors in the same order as palettizing the
+	whole image at once, and then each band's indexes are changed to the
+	merged palette's.
+
+	Errors are the same as pintoPalettize() too. A band stops at its first
+	error, so every color it found comes before that error. If merging those
+	colors goes over PINTO_MAX_COLORS, that happened first, otherwise the
+	band's own error did.
+*/
+static PINTO_RC pintoPalettizeParallel( const PintoImageView *view, s32 threadCount, PintoPalette *palette, char *indexedData )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoBandJob *jobs = NULL;
+	s32 jobAmount = 0;
+	s32 rowsPerBand = 0;
+	s32 row = 0;
+
+	s32 job = 0;
+	s32 color = 0;
+	s32 index = 0;
+	const u8 *colors = NULL;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( view == NULL );
+	PARANOID_ERR_IF( palette == NULL );
+	PARANOID_ERR_IF( indexedData == NULL );
+
+	rowsPerBand = ( view->height + threadCount - 1 ) / threadCount;
+	jobAmount = ( view->height + rowsPerBand - 1 ) / rowsPerBand;
+
+	PINTO_MALLOC( jobs, PintoBandJob, jobAmount );
+
+	/* split into bands */
+	for ( job = 0; job < jobAmount; job += 1 )
+	{
+		row = job * rowsPerBand;
+
+		jobs[ job ].view = (*view);
+		jobs[ job ].view.pixels = view->pixels + ( row * view->stride );
+		jobs[ job ].view.height = rowsPerBand;
+		if ( row + rowsPerBand > view->height )
+		{
+			jobs[ job ].view.height = view->height - row;
+		}
+
+		jobs[ job ].indexedData = indexedData + ( row * view->width );
+		jobs[ job ].pixelAmount = jobs[ job ].view.height * view->width;
+
+		jobs[ job ].rc = PINTO_RC_SUCCESS;
+	}
+
+	/* palettize each band */
+	pintoThreadsRun( pintoPalettizeJob, jobs, sizeof( PintoBandJob ), jobAmount );
+
+	/* merge band palettes */
+	for ( job = 0; job < jobAmount; job += 1 )
+	{
+		colors = jobs[ job ].palette.colors;
+
+		for ( color = 0; color < jobs[ job ].palette.colorAmount; color += 1 )
+		{
+			rc = pintoPaletteGetIndex( palette, PINTO_PALETTE_KEY( colors[ ( color * 3 ) ], colors[ ( color * 3 ) + 1 ], colors[ ( color * 3 ) + 2 ] ), &index );
+			ERR_IF_PASSTHROUGH;
+
+			jobs[ job ].indexMap[ color ] = (char) index;
+		}
+
+		rc = jobs[ job ].rc;
+		ERR_IF_PASSTHROUGH;
+	}
+
+	/* change each band's indexes to the merged palette's */
+	pintoThreadsRun( pintoRemapJob, jobs, sizeof( PintoBandJob ), jobAmount );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( jobs );
+	jobs = NULL;
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Palettizes one band. See pintoPalettizeParallel().
+	\param[in] job The band's PintoBandJob.
+	\return void
+*/
+static void pintoPalettizeJob( void *job )
+{
+	/* DATA */
+	PintoBandJob *bandJob = (PintoBandJob *) job;
+
+
+	/* CODE */
+	pintoPaletteInit( &bandJob->palette );
+
+	bandJob->rc = pintoPalettize( &bandJob->view, &bandJob->palette, bandJob->indexedData );
+
+	return;
+}
+
+/******************************************************************************/
+/*!
+	\brief Changes one band's indexes to the merged palette's. See
+	       pintoPalettizeParallel().
+	\param[in] job The band's PintoBandJob.
+	\return void
+*/
+static void pintoRemapJob( void *job )
+{
+	/* DATA */
+	PintoBandJob *bandJob = (PintoBandJob *) job;
+
+	s32 pixel = 0;
+	s32 color = 0;
+
+
+	/* CODE */
+	/* nothing to do if the band's colors are already in the right place,
+	   which is always true for the first band */
+	for ( color = 0; color < bandJob->palette.colorAmount; color += 1 )
+	{
+		if ( bandJob->indexMap[ color ] != color )
+		{
+			break;
+		}
+	}
+
+	if ( color == bandJob->palette.colorAmount )
+	{
+		return;
+	}
+
+	for ( pixel = 0; pixel < bandJob->pixelAmount; pixel += 1 )
+	{
+		if ( bandJob->indexedData[ pixel ] >= 0 )
+		{
+			bandJob->indexedData[ pixel ] = bandJob->indexMap[ (u8) bandJob->indexedData[ pixel ] ];
+		}
+	}
+
+	return;
+}
+
+/******************************************************************************/
+/*!
+	\brief Reorders a palette's colors to paint them with fewer runs.
+	\param[in] palette Palette.
+	\param[in] indexedData Palette index of each pixel, or -1 for transparent.
+		Will be changed to the new indexes.
+	\param[in] pixelAmount Amount of pixels.
+	\param[in] sequence Scratch space for pixelAmount values.
+	\return void
+
+	A color's runs go through pixels of all the colors painted after it, so
+	the amount of runs a color needs is how many times it appears in the
+	image once the later colors are taken out, and repeats are merged.
+
+	We pick the order from the last color to the first. At each step, we pick
+	the color that appears the least, take it out, and merge repeats. This
+	tends to put small details last and backgrounds first. If this wouldn't
+	give fewer runs than the order of first appearance, nothing is changed.
+*/
+static void pintoPaletteReorder( PintoPalette *palette, char *indexedData, s32 pixelAmount, char *sequence )
+{
+	/* DATA */
+	s32 sequenceLength = 0;
+
+	s32 counts[ PINTO_MAX_COLORS ];
+	char placed[ PINTO_MAX_COLORS ];
+	char order[ PINTO_MAX_COLORS ];
+	char newIndex[ PINTO_MAX_COLORS ];
+	u8 colors[ PINTO_MAX_COLORS * 3 ];
+
+	s32 runs = 0;
+	s32 runsFirstAppearance = 0;
+
+	s32 colorAmount = palette->colorAmount;
+	s32 color = 0;
+	s32 best = 0;
+	s32 step = 0;
+	s32 i = 0;
+
+
+	/* CODE */
+	if ( colorAmount <= 1 )
+	{
+		return;
+	}
+
+	/* count the runs for the order of first appearance */
+	sequenceLength = pintoColorSequence( indexedData, pixelAmount, sequence );
+
+	for ( color = colorAmount - 1; color >= 0; color -= 1 )
+	{
+		for ( i = 0; i < sequenceLength; i += 1 )
+		{
+			if ( sequence[ i ] == color )
+			{
+				runsFirstAppearance += 1;
+			}
+		}
+
+		sequenceLength = pintoColorSequenceRemove( sequence, sequenceLength, color );
+	}
+
+	/* pick our order */
+	sequenceLength = pintoColorSequence( indexedData, pixelAmount, sequence );
+
+	for ( color = 0; color < colorAmount; color += 1 )
+	{
+		placed[ color ] = 0;
+	}
+
+	for ( step = colorAmount - 1; step >= 0; step -= 1 )
+	{
+		for ( color = 0; color < colorAmount; color += 1 )
+		{
+			counts[ color ] = 0;
+		}
+
+		for ( i = 0; i < sequenceLength; i += 1 )
+		{
+			if ( sequence[ i ] >= 0 )
+			{
+				counts[ (s32) sequence[ i ] ] += 1;
+			}
+		}
+
+		/* on a tie, take the higher color, so we keep the order of first
+		   appearance when the order doesn't matter */
+		best = -1;
+		for ( color = 0; color < colorAmount; color += 1 )
+		{
+			if ( placed[ color ] == 0 && ( best == -1 || counts[ color ] <= counts[ best ] ) )
+			{
+				best = color;
+			}
+		}
+
+		placed[ best ] = 1;
+		order[ step ] = (char) best;
+		runs += counts[ best ];
+
+		sequenceLength = pintoColorSequenceRemove( sequence, sequenceLength, best );
+	}
+
+	if ( runs >= runsFirstAppearance )
+	{
+		return;
+	}
+
+	/* use our new order */
+	for ( step = 0; step < colorAmount; step += 1 )
+	{
+		newIndex[ (s32) order[ step ] ] = (char) step;
+	}
+
+	memcpy( colors, palette->colors, colorAmount * 3 );
+
+	for ( color = 0; color < colorAmount; color += 1 )
+	{
+		palette->colors[ ( newIndex[ color ] * 3 )     ] = colors[ ( color * 3 )     ];
+		palette->colors[ ( newIndex[ color ] * 3 ) + 1 ] = colors[ ( color * 3 ) + 1 ];
+		palette->colors[ ( newIndex[ color ] * 3 ) + 2 ] = colors[ ( color * 3 ) + 2 ];
+	}
+
+	for ( i = 0; i < PINTO_PALETTE_HASH_SIZE; i += 1 )
+	{
+		if ( palette->keys[ i ] != -1 )
+		{
+			palette->indexes[ i ] = newIndex[ (u8) palette->indexes[ i ] ];
+		}
+	}
+
+	for ( i = 0; i < pixelAmount; i += 1 )
+	{
+		if ( indexedData[ i ] >= 0 )
+		{
+			indexedData[ i ] = newIndex[ (u8) indexedData[ i ] ];
+		}
+	}
+
+	return;
+}
+
+/******************************************************************************/
+/*!
+	\brief Gets the indexed data with repeats merged.
+	\param[in] indexedData Palette index of each pixel, or -1 for transparent.
+	\param[in] pixelAmount Amount of pixels.
+	\param[in] sequence Where to put the merged data. Must have room for
+		pixelAmount values.
+	\return The length of the sequence.
+*/
+static s32 pintoColorSequence( const char *indexedData, s32 pixelAmount, char *sequence )
+{
+	/* DATA */
+	s32 i = 0;
+	s32 sequenceLength = 0;
+
+
+	/* CODE */
+	for ( i = 0; i < pixelAmount; i += 1 )
+	{
+		if ( sequenceLength == 0 || sequence[ sequenceLength - 1 ] != indexedData[ i ] )
+		{
+			sequence[ sequenceLength ] = indexedData[ i ];
+			sequenceLength += 1;
+		}
+	}
+
+	return sequenceLength;
+}
+
+/******************************************************************************/
+/*!
+	\brief Takes a color out of a sequence, and merges the repeats this makes.
+	\param[in] sequence Sequence from pintoColorSequence().
+	\param[in] sequenceLength Length of the sequence.
+	\param[in] color Color to take out.
+	\return The new length of the sequence.
+*/
+static s32 pintoColorSequenceRemove( char *sequence, s32 sequenceLength, s32 color )
+{
+	/* DATA */
+	s32 i = 0;
+	s32 newLength = 0;
+
+
+	/* CODE */
+	for ( i = 0; i < sequenceLength; i += 1 )
+	{
+		if (    sequence[ i ] != color
+		     && ( newLength == 0 || sequence[ newLength - 1 ] != sequence[ i ] )
+		   )
+		{
+			sequence[ newLength ] = sequence[ i ];
+			newLength += 1;
+		}
+	}
+
+	return newLength;
+}
+
+/******************************************************************************/
+/*!
+	\brief Empties a palette.
+	\param[in] palette Palette.
+	\return void
+*/
+void pintoPaletteInit( PintoPalette *palette )
+{
+	/* DATA */
+	s32 i = 0;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( palette == NULL );
+
+	palette->colorAmount = 0;
+
+	for ( i = 0; i < PINTO_PALETTE_HASH_SIZE; i += 1 )
+	{
+		palette->keys[ i ] = -1;
+	}
+
+	return;
+}
+
+/******************************************************************************/
+/*!
+	\brief Gets the index of a color in the palette, adding it if it's new.
+	\param[in] palette Palette.
+	\param[in] key The color's key. See PINTO_PALETTE_KEY.
+	\param[out] index On success, the index of the color.
+	\return PINTO_RC
+
+	Colors are kept in a hash table, so this takes the same time no matter how
+	many colors there are. Colors are added to the end of the palette, so
+	indexes are in order of first appearance.
+*/
+PINTO_RC pintoPaletteGetIndex( PintoPalette *palette, s32 key, s32 *index )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	s32 slot = 0;
+	s32 color = 0;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( palette == NULL );
+	PARANOID_ERR_IF( key < 0 );
+	PARANOID_ERR_IF( index == NULL );
+
+	slot = (s32)( ( ( (u32)key * 2654435761U ) >> 16 ) & ( PINTO_PALETTE_HASH_SIZE - 1 ) );
+
+	/* look for the color, or an empty slot */
+	while ( palette->keys[ slot ] != -1 )
+	{
+		if ( palette->keys[ slot ] == key )
+		{
+			(*index) = palette->indexes[ slot ];
+
+			goto cleanup;
+		}
+
+		slot = ( slot + 1 ) & ( PINTO_PALETTE_HASH_SIZE - 1 );
+	}
+
+	/* it's new, so add it to our palette.
+	   make sure we dont go over PINTO_MAX_COLORS */
+	ERR_IF( palette->colorAmount == PINTO_MAX_COLORS, PINTO_RC_ERROR_IMAGE_TOO_MANY_COLORS );
+
+	color = palette->colorAmount;
+
+	/* PINTO_8_BITS_TO_6_BITS only depends on the 6 most significant bits,
+	   which is what's in the key */
+	palette->colors[ ( color * 3 )     ] = (u8) PINTO_8_BITS_TO_6_BITS( ( ( key >> 12 )        ) << 2 );
+	palette->colors[ ( color * 3 ) + 1 ] = (u8) PINTO_8_BITS_TO_6_BITS( ( ( key >>  6 ) & 0x3F ) << 2 );
+	palette->colors[ ( color * 3 ) + 2 ] = (u8) PINTO_8_BITS_TO_6_BITS( ( ( key       ) & 0x3F ) << 2 );
+
+	palette->colorAmount += 1;
+
+	palette->keys[ slot ] = key;
+	palette->indexes[ slot ] = (char) color;
+
+	(*index) = color;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Creates the RLE data for a range of colors, in one pass over the
+	       image.
+	\param[in] indexedData Palette index of each pixel, or -1 for transparent.
+	\param[in] pixelAmount Amount of pixels.
+	\param[in] colorStart First color to create RLE data for.
+	\param[in] colorEnd One past the last color to create RLE data for.
+	\param[in] colorTexts Texts to add each color's RLE data to, indexed by
+		color. Only colorStart to colorEnd - 1 are used.
+	\return PINTO_RC
+
+	Each color's RLE data is a list of runs, alternating between off and on,
+	starting with off, and ending with '^'. The last run isn't added. A color
+	is turned on by a pixel of that color, and stays on through pixels of that
+	color or higher colors, since those get painted over it. It's turned off
+	by a pixel of a lower color, or a transparent pixel.
+
+	So a pixel turns off every color above it, and turns on its own color.
+	That means the colors that are on are always a stack, with the highest
+	color on top, and each pixel pops the colors above it and pushes its own.
+	This lets us do every color in one pass, without checking every color at
+	every pixel.
+*/
+PINTO_RC pintoRleEncodeColors( const char *indexedData, s32 pixelAmount, s32 colorStart, s32 colorEnd, PintoText **colorTexts )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	/* where each color's current run started */
+	s32 runStart[ PINTO_MAX_COLORS ];
+
+	/* colors that are on, lowest to highest */
+	s32 onColors[ PINTO_MAX_COLORS ];
+	s32 onAmount = 0;
+
+	s32 pixel = 0;
+	s32 color = 0;
+	s32 onColor = 0;
+
+	/* nothing is on at the start, which is the same as after a transparent
+	   pixel */
+	s32 previousColor = -1;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( indexedData == NULL );
+	PARANOID_ERR_IF( colorStart < 0 );
+	PARANOID_ERR_IF( colorEnd > PINTO_MAX_COLORS );
+	PARANOID_ERR_IF( colorTexts == NULL );
+
+	for ( color = colorStart; color < colorEnd; color += 1 )
+	{
+		runStart[ color ] = 0;
+	}
+
+	/* foreach pixel */
+	for ( pixel = 0; pixel < pixelAmount; pixel += 1 )
+	{
+		color = indexedData[ pixel ];
+
+		/* same as the last pixel? then nothing changes */
+		if ( color == previousColor )
+		{
+			continue;
+		}
+
+		previousColor = color;
+
+		/* turn off every color above this one */
+		while ( onAmount > 0 && onColors[ onAmount - 1 ] > color )
+		{
+			onAmount -= 1;
+			onColor = onColors[ onAmount ];
+
+			/* add on run */
+			rc = pintoTextAddValue( colorTexts[ onColor ], pixel - runStart[ onColor ] );
+			ERR_IF_PASSTHROUGH;
+
+			runStart[ onColor ] = pixel;
+		}
+
+		/* turn on this color, if it isn't already */
+		if (    color >= colorStart
+		     && color < colorEnd
+		     && ( onAmount == 0 || onColors[ onAmount - 1 ] != color )
+		   )
+		{
+			/* add off run */
+			rc = pintoTextAddValue( colorTexts[ color ], pixel - runStart[ color ] );
+			ERR_IF_PASSTHROUGH;
+
+			runStart[ color ] = pixel;
+
+			onColors[ onAmount ] = color;
+			onAmount += 1;
+		}
+	}
+
+	/* add '^', which signals end of color */
+	for ( color = colorStart; color < colorEnd; color += 1 )
+	{
+		rc = pintoTextAddChar( colorTexts[ color ], '^' );
+		ERR_IF_PASSTHROUGH;
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Same as pintoRleEncodeColors() for all colors, but splits the
+	       colors into ranges that are done on their own threads.
+	\param[in] indexedData Palette index of each pixel, or -1 for transparent.
+	\param[in] pixelAmount Amount of pixels.
+	\param[in] colorAmount Amount of colors.
+	\param[in] threadCount Amount of threads to use.
+	\param[in] colorTexts Texts to add each color's RLE data to.
+	\return PINTO_RC
+
+	Each color's RLE data doesn't depend on any other color's, so this gives
+	the same texts as doing them all at once.
+*/
+static PINTO_RC pintoRleEncodeColorsParallel( const char *indexedData, s32 pixelAmount, s32 colorAmount, s32 threadCount, PintoText **colorTexts )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoRleJob *jobs = NULL;
+	s32 jobAmount = 0;
+	s32 job = 0;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( indexedData == NULL );
+	PARANOID_ERR_IF( colorTexts == NULL );
+
+	jobAmount = ( threadCount < colorAmount ? threadCount : colorAmount );
+
+	PINTO_MALLOC( jobs, PintoRleJob, jobAmount );
+
+	/* split colors into ranges */
+	for ( job = 0; job < jobAmount; job += 1 )
+	{
+		jobs[ job ].indexedData = indexedData;
+		jobs[ job ].pixelAmount = pixelAmount;
+		jobs[ job ].colorStart = ( colorAmount * job ) / jobAmount;
+		jobs[ job ].colorEnd = ( colorAmount * ( job + 1 ) ) / jobAmount;
+		jobs[ job ].colorTexts = colorTexts;
+		jobs[ job ].rc = PINTO_RC_SUCCESS;
+	}
+
+	pintoThreadsRun( pintoRleJob, jobs, sizeof( PintoRleJob ), jobAmount );
+
+	for ( job = 0; job < jobAmount; job += 1 )
+	{
+		rc = jobs[ job ].rc;
+		ERR_IF_PASSTHROUGH;
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( jobs );
+	jobs = NULL;
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Creates RLE data for one range of colors. See
+	       pintoRleEncodeColorsParallel().
+	\param[in] job The range's PintoRleJob.
+	\return void
+*/
+static void pintoRleJob( void *job )
+{
+	/* DATA */
+	PintoRleJob *rleJob = (PintoRleJob *) job;
+
+
+	/* CODE */
+	rleJob->rc = pintoRleEncodeColors( rleJob->indexedData, rleJob->pixelAmount, rleJob->colorStart, rleJob->colorEnd, rleJob->colorTexts );
+
+	return;
+}
+
+/******************************************************************************/
+/*!
+	\brief Decodes a string into an image.
+	\param[in] string The string to be decoded.
+	\param[out] image_A On success, the decoded image.
+		Will be allocated. The caller is responsible for freeing by passing the
+		image to the pintoImageFree() function.
+	\return PINTO_RC
+*/
+PINTO_RC pintoImageDecodeString( const char *string, PintoImage **image_A )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( string == NULL, PINTO_RC_ERROR_PRECOND );
+
+
+	/* CODE */
+	rc = pintoImageDecodeBuffer( string, strlen( string ), image_A );
+	ERR_IF_PASSTHROUGH;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Decodes a buffer into an image.
+	\param[in] data The characters to be decoded. Doesn't need to be '\0'
+		terminated.
+	\param[in] length Amount of characters.
+	\param[out] image_A On success, the decoded image.
+		Will be allocated. The caller is responsible for freeing by passing the
+		image to the pintoImageFree() function.
+	\return PINTO_RC
+
+	The characters are read where they are, without being copied first.
+	Characters that aren't used in encoding, like spaces and newlines, are
+	skipped.
+*/
+PINTO_RC pintoImageDecodeBuffer( const char *data, size_t length, PintoImage **image_A )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoText view;
+	PintoDecodeTarget target;
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( data == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( image_A == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( (*image_A) != NULL, PINTO_RC_ERROR_PRECOND );
+
+
+	/* CODE */
+	/* see pintoTextAddChar() */
+	ERR_IF( length > 0x7FFFFFFF, PINTO_RC_ERROR_FORMAT_TOO_LONG );
+
+	pintoTextInitView( &view, data, (s32) length );
+
+	memset( &target, 0, sizeof( PintoDecodeTarget ) );
+	target.mode = PINTO_DECODE_IMAGE;
+
+	rc = pintoDecode( &view, &target );
+	ERR_IF_PASSTHROUGH;
+
+	/* give back */
+	(*image_A) = target.image;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Decodes a buffer into RGBA memory owned by the caller.
+	\param[in] data The characters to be decoded. Doesn't need to be '\0'
+		terminated.
+	\param[in] length Amount of characters.
+	\param[in] rgba Memory to paint the image in, 4 bytes per pixel.
+	\param[in] rgbaSize Size of rgba, in bytes.
+	\param[in] offset Bytes from the start of rgba to the image's top left
+		pixel.
+	\param[in] stride Bytes from the start of one row of the image to the
+		next, or 0 if the rows are right after each other.
+	\param[out] width The image's width. Set if the buffer is too small.
+	\param[out] height The image's height. Set if the buffer is too small.
+	\return PINTO_RC
+
+	Every pixel of the image is written, fully transparent ones as 0, the same
+	as pintoImageDecodeString(). Bytes between rows aren't touched. If rgba is
+	too small, or the encoding is invalid, nothing is written.
+*/
+PINTO_RC pintoImageDecodeInto( const char *data, size_t length, u8 *rgba, s32 rgbaSize, s32 offset, s32 stride, s32 *width, s32 *height )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoText view;
+	PintoDecodeTarget target;
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( data == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( rgba == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( rgbaSize < 0, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( offset < 0, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( stride < 0, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( width == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( height == NULL, PINTO_RC_ERROR_PRECOND );
+
+
+	/* CODE */
+	/* see pintoTextAddChar() */
+	ERR_IF( length > 0x7FFFFFFF, PINTO_RC_ERROR_FORMAT_TOO_LONG );
+
+	pintoTextInitView( &view, data, (s32) length );
+
+	/* the image goes at offset, so only what's after it can be used */
+	if ( offset > rgbaSize )
+	{
+		offset = rgbaSize;
+	}
+
+	memset( &target, 0, sizeof( PintoDecodeTarget ) );
+	target.mode = PINTO_DECODE_RGBA;
+	target.pixels = rgba + offset;
+	target.pixelsSize = rgbaSize - offset;
+	target.stride = stride;
+
+	rc = pintoDecode( &view, &target );
+
+	/* give back, even if the buffer is too small */
+	(*width) = target.width;
+	(*height) = target.height;
+
+	ERR_IF_PASSTHROUGH;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Decodes a text into an image.
+	\param[in] text_F The text to be decoded. On success, this will be freed.
+	\param[out] image_A On success, the decoded image.
+		Will be allocated. The caller is responsible for freeing by passing the
+		image to pintoImageFree().
+	\return PINTO_RC
+*/
+PINTO_RC pintoImageDecodeText( PintoText **text_F, PintoImage **image_A )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoDecodeTarget target;
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( text_F == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( (*text_F) == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( image_A == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( (*image_A) != NULL, PINTO_RC_ERROR_PRECOND );
+
+
+	/* CODE */
+	memset( &target, 0, sizeof( PintoDecodeTarget ) );
+	target.mode = PINTO_DECODE_IMAGE;
+
+	rc = pintoDecode( (*text_F), &target );
+	ERR_IF_PASSTHROUGH;
+
+	/* give back */
+	(*image_A) = target.image;
+
+	pintoTextFree( text_F );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Decodes a buffer into an image with a palette index for each pixel.
+	\param[in] data The characters to be decoded. Doesn't need to be '\0'
+		terminated.
+	\param[in] length Amount of characters.
+	\param[out] image_A On success, the decoded image.
+		Will be allocated. The caller is responsible for freeing by passing the
+		image to pintoIndexedImageFree().
+	\return PINTO_RC
+
+	Fully transparent pixels have the index PINTO_INDEX_TRANSPARENT, which is
+	the image's transparentIndex. The palette has the image's colors in the
+	order they're painted, and can be empty if every pixel is transparent.
+*/
+PINTO_RC pintoIndexedImageDecode( const char *data, size_t length, PintoIndexedImage **image_A )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoText view;
+	PintoDecodeTarget target;
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( data == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( image_A == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( (*image_A) != NULL, PINTO_RC_ERROR_PRECOND );
+
+
+	/* CODE */
+	/* see pintoTextAddChar() */
+	ERR_IF( length > 0x7FFFFFFF, PINTO_RC_ERROR_FORMAT_TOO_LONG );
+
+	pintoTextInitView( &view, data, (s32) length );
+
+	memset( &target, 0, sizeof( PintoDecodeTarget ) );
+	target.mode = PINTO_DECODE_INDEXED_IMAGE;
+
+	rc = pintoDecode( &view, &target );
+	ERR_IF_PASSTHROUGH;
+
+	/* give back */
+	(*image_A) = target.indexedImage;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Frees an image from pintoIndexedImageDecode().
+	\param[in] image_F The image to be freed. Will be freed with
+		PINTO_HOOK_FREE(). On return, image_F will be NULL.
+	\return void.
+*/
+void pintoIndexedImageFree( PintoIndexedImage **image_F )
+{
+	/* CODE */
+	if ( image_F == NULL || (*image_F) == NULL )
+	{
+		return;
+	}
+
+	PINTO_HOOK_FREE( (*image_F)->palette );
+	(*image_F)->palette = NULL;
+
+	PINTO_HOOK_FREE( (*image_F)->indexes );
+	(*image_F)->indexes = NULL;
+
+	PINTO_HOOK_FREE( (*image_F) );
+	(*image_F) = NULL;
+
+	return;
+}
+
+/******************************************************************************/
+/*!
+	\brief Reads an image's size and palette, without decoding it.
+	\param[in] data The characters of the encoding. Doesn't need to be '\0'
+		terminated.
+	\param[in] length Amount of characters.
+	\param[out] info On success, the image's size and palette.
+	\return PINTO_RC
+
+	Only the header is inflated and read, so this is much faster than decoding
+	the image. The rest of the encoding isn't checked, so the image can still
+	fail to decode.
+*/
+PINTO_RC pintoImageGetInfo( const char *data, size_t length, PintoImageInfo *info )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoText view;
+
+	PintoInflater inflater;
+
+
+	/* PRECOND */
+	/* so cleanup is safe if a precondition fails */
+	memset( &inflater, 0, sizeof( PintoInflater ) );
+
+	FAILURE_POINT;
+	ERR_IF( data == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( info == NULL, PINTO_RC_ERROR_PRECOND );
+
+
+	/* CODE */
+	/* see pintoTextAddChar() */
+	ERR_IF( length > 0x7FFFFFFF, PINTO_RC_ERROR_FORMAT_TOO_LONG );
+
+	pintoTextInitView( &view, data, (s32) length );
+
+	/* only inflate as much as a header can take */
+	rc = pintoInflaterInit( &inflater, &view, PINTO_HEADER_SIZE_MAX );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoDecodeHeader( &inflater, &info->width, &info->height, &info->colorAmount, info->palette );
+	ERR_IF_PASSTHROUGH;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoInflaterFree( &inflater );
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Decodes a text into a target.
+	\param[in] deflatedText The text to be decoded, from its index on.
+	\param[in,out] target What to decode into. On success, has the new image
+		if one was made. Its width and height are set once they're known, even
+		on failure.
+	\return PINTO_RC
+*/
+static PINTO_RC pintoDecode( PintoText *deflatedText, PintoDecodeTarget *target )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoInflater inflater;
+	PintoInflaterMark mark;
+
+	/* where the inflater was, and the position, when each color starts */
+	PintoInflaterMark *marks = NULL;
+	s32 colorStarts[ PINTO_MAX_COLORS ];
+
+	s32 width = 0;
+	s32 height = 0;
+
+	s32 colorAmount = 0;
+	u8 palette[ PINTO_MAX_COLORS * 3 ];
+
+
+	/* CODE */
+	PARANOID_ERR_IF( deflatedText == NULL );
+	PARANOID_ERR_IF( target == NULL );
+	PARANOID_ERR_IF( target->image != NULL || target->indexedImage != NULL );
+
+	memset( &inflater, 0, sizeof( PintoInflater ) );
+
+	/* the text is inflated as it's read, so before reading a value we make
+	   sure the inflater has the most characters a value can take */
+	rc = pintoInflaterInit( &inflater, deflatedText, PINTO_INFLATE_WINDOW_SIZE );
+	ERR_IF_PASSTHROUGH;
+
+	/* the inflater keeps a mark, so each color can be read again from its
+	   start */
+	inflater.mark = &mark;
+
+	rc = pintoDecodeHeader( &inflater, &width, &height, &colorAmount, palette );
+	ERR_IF_PASSTHROUGH;
+
+	/* get what we're painting in ready */
+	rc = pintoDecodeTargetInit( target, width, height, colorAmount, palette );
+	ERR_IF_PASSTHROUGH;
+
+	if ( colorAmount > 0 )
+	{
+		PINTO_MALLOC( marks, PintoInflaterMark, colorAmount );
+	}
+
+	/* read every color's runs before painting, so nothing is painted if
+	   the encoding is invalid. only where each color starts is kept. */
+	rc = pintoDecodeRuns( &inflater, width * height, colorAmount, marks, colorStarts );
+	ERR_IF_PASSTHROUGH;
+
+	/* must be at end of text */
+	rc = pintoInflaterFill( &inflater, 1 );
+	ERR_IF_PASSTHROUGH;
+
+	ERR_IF( pintoInflaterAtEnd( &inflater ) == 0, PINTO_RC_ERROR_FORMAT_INVALID );
+
+	pintoInflaterFree( &inflater );
+
+	/* paint */
+	rc = pintoPaintColors( target, deflatedText, marks, colorStarts, colorAmount, palette );
+	ERR_IF_PASSTHROUGH;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoInflaterFree( &inflater );
+
+	PINTO_HOOK_FREE( marks );
+
+	if ( rc != PINTO_RC_SUCCESS )
+	{
+		pintoImageFree( &target->image );
+		pintoIndexedImageFree( &target->indexedImage );
+	}
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Reads the runs of every color, to check them, and marks where each
+	       color starts.
+	\param[in] inflater Inflater of the encoding, just after the header. Must
+		have a mark.
+	\param[in] pixelAmount Amount of pixels in the image.
+	\param[in] colorAmount Amount of colors in the palette.
+	\param[out] marks On success, the inflater's mark when each color starts.
+	\param[out] colorStarts On success, the position in the inflated text of
+		each color's first run.
+	\return PINTO_RC
+*/
+static PINTO_RC pintoDecodeRuns( PintoInflater *inflater, s32 pixelAmount, s32 colorAmount, PintoInflaterMark *marks, s32 *colorStarts )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoText *text = NULL;
+
+	s32 colorIndex = 0;
+	s32 pixelIndex = 0;
+
+	char ch = 0;
+	s32 value = 0;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( inflater == NULL );
+	PARANOID_ERR_IF( inflater->mark == NULL );
+	PARANOID_ERR_IF( colorAmount > 0 && marks == NULL );
+	PARANOID_ERR_IF( colorStarts == NULL );
+
+	text = &inflater->window;
+
+	/* foreach color */
+	for ( colorIndex = 0; colorIndex < colorAmount; colorIndex += 1 )
+	{
+		/* painting reads this color again, resumed from here */
+		marks[ colorIndex ] = (*inflater->mark);
+		colorStarts[ colorIndex ] = pintoInflaterPosition( inflater );
+
+		pixelIndex = 0;
+
+		/* rle decoding */
+		while ( 1 )
+		{
+			/* peek at current character to see if it's a '^', which
+			   signals end of current color */
+			rc = pintoInflaterFill( inflater, PINTO_VALUE_SIZE_MAX );
+			ERR_IF_PASSTHROUGH;
+
+			rc = pintoTextPeekChar( text, &ch );
+			ERR_IF_PASSTHROUGH;
+
+			if ( ch == '^' )
+			{
+				/* we just peeked, now we must remove it to move
+				   past it in the text */
+				rc = pintoTextGetChar( text, &ch );
+				PARANOID_ERR_IF( rc != PINTO_RC_SUCCESS );
+
+				break;
+			}
+
+			/* get the rle value */
+			rc = pintoTextGetValue( text, &value );
+			ERR_IF_PASSTHROUGH;
+
+			/* make sure it doesn't go past end of image */
+			ERR_IF( pixelIndex + value >= pixelAmount, PINTO_RC_ERROR_FORMAT_INVALID );
+
+			pixelIndex += value;
+
+		} /* end rle decoding */
+
+	} /* end foreach color */
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Reads a color's next span of pixels that are on.
+	\param[in] inflater Inflater of the color's runs, where its last span
+		ended.
+	\param[in] pixelAmount Amount of pixels in the image.
+	\param[in,out] position Pixel after the color's last run. Is moved past
+		the span.
+	\param[out] spanStart First pixel of the span.
+	\param[out] spanEnd Pixel after the span.
+	\return PINTO_RC
+
+	Spans with no pixels are skipped. Once the color has no more spans,
+	spanStart and spanEnd are both pixelAmount. The runs must have already
+	been checked by pintoDecodeRuns().
+*/
+static PINTO_RC pintoDecodeNextSpan( PintoInflater *inflater, s32 pixelAmount, s32 *position, s32 *spanStart, s32 *spanEnd )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoText *text = NULL;
+
+	char ch = 0;
+	s32 value = 0;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( inflater == NULL );
+	PARANOID_ERR_IF( position == NULL );
+	PARANOID_ERR_IF( spanStart == NULL );
+	PARANOID_ERR_IF( spanEnd == NULL );
+
+	text = &inflater->window;
+
+	do
+	{
+		/* off run, or the end of the color */
+		rc = pintoInflaterFill( inflater, PINTO_VALUE_SIZE_MAX );
+		ERR_IF_PASSTHROUGH;
+
+		rc = pintoTextPeekChar( text, &ch );
+		ERR_IF_PASSTHROUGH;
+
+		if ( ch == '^' )
+		{
+			(*spanStart) = pixelAmount;
+			(*spanEnd) = pixelAmount;
+
+			break;
+		}
+
+		rc = pintoTextGetValue( text, &value );
+		ERR_IF_PASSTHROUGH;
+
+		(*position) += value;
+		(*spanStart) = (*position);
+
+		/* on run. the last one is implicit, and goes to the end of the
+		   image. */
+		rc = pintoInflaterFill( inflater, PINTO_VALUE_SIZE_MAX );
+		ERR_IF_PASSTHROUGH;
+
+		rc = pintoTextPeekChar( text, &ch );
+		ERR_IF_PASSTHROUGH;
+
+		if ( ch == '^' )
+		{
+			(*position) = pixelAmount;
+		}
+		else
+		{
+			rc = pintoTextGetValue( text, &value );
+			ERR_IF_PASSTHROUGH;
+
+			(*position) += value;
+		}
+
+		(*spanEnd) = (*position);
+
+		PARANOID_ERR_IF( (*position) > pixelAmount );
+	}
+	while ( (*spanStart) == (*spanEnd) );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Paints every pixel once, in the last color that covers it.
+	\param[in] target Target to paint in.
+	\param[in] deflatedText The encoding. Its index isn't changed.
+	\param[in] marks Inflater's mark when each color starts.
+	\param[in] colorStarts Position in the inflated text of each color's
+		first run.
+	\param[in] colorAmount Amount of colors in the palette.
+	\param[in] palette Red, green, and blue of each color.
+	\return PINTO_RC
+
+	Goes one row at a time. Each color's spans in the row are painted in
+	order, as palette indexes, in a row of 1 byte per pixel. Then each run of
+	the same index is filled once in the target, with the color's 4 bytes.
+
+	Each color has its own inflater, resumed from its mark, that reads its
+	runs as its spans reach each row. So only a small window of each color's
+	inflated text is held at a time.
+*/
+static PINTO_RC pintoPaintColors( const PintoDecodeTarget *target, PintoText *deflatedText, const PintoInflaterMark *marks, const s32 *colorStarts, s32 colorAmount, const u8 *palette )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	s32 width = 0;
+	s32 pixelAmount = 0;
+
+	/* each color reads the encoding with its own index */
+	PintoText sources[ PINTO_MAX_COLORS ];
+	PintoInflater inflaters[ PINTO_MAX_COLORS ];
+
+	/* each color's pixel after its last run, and the span we're painting */
+	s32 position[ PINTO_MAX_COLORS ];
+	s32 spanStart[ PINTO_MAX_COLORS ];
+	s32 spanEnd[ PINTO_MAX_COLORS ];
+
+	u8 *rowIndexesBuffer = NULL;
+	u8 *rowIndexes = NULL;
+
+	/* 4 bytes of each color, then transparent */
+	u8 colorsRgba[ ( PINTO_MAX_COLORS + 1 ) * 4 ];
+	u8 *rgba = NULL;
+	u8 *pixel = NULL;
+
+	s32 row = 0;
+	s32 rowStart = 0;
+	s32 rowEnd = 0;
+
+	s32 colorIndex = 0;
+
+	s32 start = 0;
+	s32 end = 0;
+
+	s32 column = 0;
+	s32 runEnd = 0;
+	u8 index = 0;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( target == NULL );
+	PARANOID_ERR_IF( deflatedText == NULL );
+	PARANOID_ERR_IF( colorAmount > 0 && ( marks == NULL || colorStarts == NULL ) );
+
+	memset( inflaters, 0, sizeof( inflaters ) );
+
+	width = target->width;
+	pixelAmount = target->width * target->height;
+
+	/* an indexed image's rows are already indexes, so we paint in them */
+	if ( target->mode != PINTO_DECODE_INDEXED_IMAGE )
+	{
+		PINTO_MALLOC( rowIndexesBuffer, u8, width );
+	}
+
+	for ( colorIndex = 0; colorIndex < colorAmount; colorIndex += 1 )
+	{
+		sources[ colorIndex ] = (*deflatedText);
+
+		rc = pintoInflaterInit( &inflaters[ colorIndex ], &sources[ colorIndex ], PINTO_INFLATE_RESUME_SIZE );
+		ERR_IF_PASSTHROUGH;
+
+		rc = pintoInflaterResume( &inflaters[ colorIndex ], &marks[ colorIndex ], colorStarts[ colorIndex ] );
+		ERR_IF_PASSTHROUGH;
+
+		position[ colorIndex ] = 0;
+		spanStart[ colorIndex ] = 0;
+		spanEnd[ colorIndex ] = 0;
+
+		colorsRgba[ ( colorIndex * 4 )     ] = palette[ ( colorIndex * 3 )     ];
+		colorsRgba[ ( colorIndex * 4 ) + 1 ] = palette[ ( colorIndex * 3 ) + 1 ];
+		colorsRgba[ ( colorIndex * 4 ) + 2 ] = palette[ ( colorIndex * 3 ) + 2 ];
+		colorsRgba[ ( colorIndex * 4 ) + 3 ] = 255;
+	}
+
+	memset( colorsRgba + ( colorAmount * 4 ), 0, 4 );
+
+	for ( row = 0; row < target->height; row += 1 )
+	{
+		rowStart = row * width;
+		rowEnd = rowStart + width;
+
+		rowIndexes = ( rowIndexesBuffer != NULL ? rowIndexesBuffer : target->pixels + ( row * target->stride ) );
+
+		memset( rowIndexes, PINTO_INDEX_TRANSPARENT, width );
+
+		/* later colors paint over earlier colors */
+		for ( colorIndex = 0; colorIndex < colorAmount; colorIndex += 1 )
+		{
+			/* each span of this color in this row */
+			while ( 1 )
+			{
+				/* once a span is painted, read the next one */
+				if ( spanStart[ colorIndex ] == spanEnd[ colorIndex ] && spanStart[ colorIndex ] < pixelAmount )
+				{
+					rc = pintoDecodeNextSpan( &inflaters[ colorIndex ], pixelAmount, &position[ colorIndex ], &spanStart[ colorIndex ], &spanEnd[ colorIndex ] );
+					ERR_IF_PASSTHROUGH;
+				}
+
+				/* no spans left, or the span isn't in this row yet */
+				if ( spanStart[ colorIndex ] == spanEnd[ colorIndex ] || spanStart[ colorIndex ] >= rowEnd )
+				{
+					break;
+				}
+
+				/* the part of the span in this row */
+				start = ( spanStart[ colorIndex ] > rowStart ? spanStart[ colorIndex ] : rowStart ) - rowStart;
+				end = ( spanEnd[ colorIndex ] < rowEnd ? spanEnd[ colorIndex ] : rowEnd ) - rowStart;
+
+				memset( rowIndexes + start, colorIndex, end - start );
+
+				/* the rest of the span is in the next row */
+				if ( spanEnd[ colorIndex ] > rowEnd )
+				{
+					break;
+				}
+
+				spanStart[ colorIndex ] = spanEnd[ colorIndex ];
+			}
+		}
+
+		if ( rowIndexesBuffer == NULL )
+		{
+			continue;
+		}
+
+		/* paint each run of the same index */
+		column = 0;
+
+		while ( column < width )
+		{
+			index = rowIndexes[ column ];
+
+			runEnd = column + 1;
+
+			while ( runEnd < width && rowIndexes[ runEnd ] == index )
+			{
+				runEnd += 1;
+			}
+
+			rgba = colorsRgba + ( ( index == PINTO_INDEX_TRANSPARENT ? colorAmount : index ) * 4 );
+
+			pixel = target->pixels + ( row * target->stride ) + ( column * 4 );
+
+			/* a new image is already transparent, since it's calloced */
+			if ( index == PINTO_INDEX_TRANSPARENT && target->mode == PINTO_DECODE_IMAGE )
+			{
+				column = runEnd;
+			}
+
+			/* short runs aren't worth a call */
+			if ( runEnd - column >= PINTO_FILL_SHORT )
+			{
+				pintoPixelsFill( pixel, runEnd - column, rgba );
+
+				column = runEnd;
+			}
+
+			while ( column < runEnd )
+			{
+				memcpy( pixel, rgba, 4 );
+
+				pixel += 4;
+				column += 1;
+			}
+		}
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( rowIndexesBuffer );
+
+	for ( colorIndex = 0; colorIndex < colorAmount; colorIndex += 1 )
+	{
+		pintoInflaterFree( &inflaters[ colorIndex ] );
+	}
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Reads the header of an encoding.
+	\param[in] inflater Inflater of the encoding, before anything's been read.
+	\param[out] width Image's width.
+	\param[out] height Image's height.
+	\param[out] colorAmount Amount of colors in the palette.
+	\param[out] palette Red, green, and blue of each color. Must have room for
+		PINTO_MAX_COLORS colors.
+	\return PINTO_RC
+*/
+static PINTO_RC pintoDecodeHeader( PintoInflater *inflater, s32 *width, s32 *height, s32 *colorAmount, u8 *palette )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoText *text = NULL;
+
+	char header = 0;
+
+	s32 colorIndex = 0;
+
+	s32 value = 0;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( inflater == NULL );
+	PARANOID_ERR_IF( width == NULL );
+	PARANOID_ERR_IF( height == NULL );
+	PARANOID_ERR_IF( colorAmount == NULL );
+	PARANOID_ERR_IF( palette == NULL );
+
+	text = &inflater->window;
+
+	/* get header */
+	rc = pintoInflaterFill( inflater, PINTO_VALUE_SIZE_MAX );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoTextGetChar( text, &header );
+	ERR_IF_PASSTHROUGH;
+
+	/* standard header marker */
+	if ( header == 'a' )
+	{
+		/* get width */
+		rc = pintoInflaterFill( inflater, PINTO_VALUE_SIZE_MAX );
+		ERR_IF_PASSTHROUGH;
+
+		rc = pintoTextGetValue( text, width );
+		ERR_IF_PASSTHROUGH;
+
+		ERR_IF_1( (*width) <= 0, PINTO_RC_ERROR_FORMAT_INVALID, (*width) );
+		ERR_IF_1( (*width) > PINTO_MAX_WIDTH, PINTO_RC_ERROR_FORMAT_INVALID, (*width) );
+
+		/* get height */
+		rc = pintoInflaterFill( inflater, PINTO_VALUE_SIZE_MAX );
+		ERR_IF_PASSTHROUGH;
+
+		rc = pintoTextGetValue( text, height );
+		ERR_IF_PASSTHROUGH;
+
+		ERR_IF_1( (*height) <= 0, PINTO_RC_ERROR_FORMAT_INVALID, (*height) );
+		ERR_IF_1( (*height) > PINTO_MAX_HEIGHT, PINTO_RC_ERROR_FORMAT_INVALID, (*height) );
+
+		/* get number of colors in palette */
+		rc = pintoInflaterFill( inflater, PINTO_VALUE_SIZE_MAX );
+		ERR_IF_PASSTHROUGH;
+
+		rc = pintoTextGetValue( text, colorAmount );
+		ERR_IF_PASSTHROUGH;
+
+		ERR_IF_1( (*colorAmount) > PINTO_MAX_COLORS, PINTO_RC_ERROR_FORMAT_INVALID, (*colorAmount) );
+
+		/* read in colors */
+		for ( colorIndex = 0; colorIndex < ( (*colorAmount) * 3 ); colorIndex += 1 )
+		{
+			value = 0;
+
+			rc = pintoInflaterFill( inflater, 1 );
+			ERR_IF_PASSTHROUGH;
+
+			rc = pintoTextUpdateValue( text, &value );
+			ERR_IF_PASSTHROUGH;
+
+			palette[ colorIndex ] = PINTO_6_BITS_TO_8_BITS( value );
+		}
+	}
+	/* smaller header */
+	else
+	{
+		/* '0' is 8x8, '1' is 16x16, and so on up to '9', which is
+		   4096x4096 */
+		ERR_IF_1( header < '0' || header > '9', PINTO_RC_ERROR_FORMAT_INVALID, header );
+
+		(*width) = (*height) = 8 << ( header - '0' );
+
+		/* our single color is black */
+		(*colorAmount) = 1;
+
+		palette[ 0 ] = 0;
+		palette[ 1 ] = 0;
+		palette[ 2 ] = 0;
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Gets a decode target ready to be painted in.
+	\param[in] target Target.
+	\param[in] width Image's width.
+	\param[in] height Image's height.
+	\param[in] colorAmount Amount of colors in the palette.
+	\param[in] palette Red, green, and blue of each color.
+	\return PINTO_RC
+
+	Allocates the target's image, or checks that the target's memory is big
+	enough.
+*/
+static PINTO_RC pintoDecodeTargetInit( PintoDecodeTarget *target, s32 width, s32 height, s32 colorAmount, const u8 *palette )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoIndexedImage *newIndexedImage = NULL;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( target == NULL );
+	PARANOID_ERR_IF( palette == NULL );
+
+	target->width = width;
+	target->height = height;
+
+	/* a new image, which is already transparent */
+	if ( target->mode == PINTO_DECODE_IMAGE )
+	{
+		rc = pintoImageInit( width, height, &target->image );
+		ERR_IF_PASSTHROUGH;
+
+		target->pixels = target->image->rgba;
+		target->stride = width * 4;
+	}
+	/* a new indexed image */
+	else if ( target->mode == PINTO_DECODE_INDEXED_IMAGE )
+	{
+		PINTO_CALLOC( newIndexedImage, PintoIndexedImage, 1 );
+
+		newIndexedImage->width = width;
+		newIndexedImage->height = height;
+		newIndexedImage->colorAmount = colorAmount;
+		newIndexedImage->transparentIndex = PINTO_INDEX_TRANSPARENT;
+
+		if ( colorAmount > 0 )
+		{
+			PINTO_MALLOC( newIndexedImage->palette, u8, colorAmount * 3 );
+			memcpy( newIndexedImage->palette, palette, colorAmount * 3 );
+		}
+
+		PINTO_MALLOC( newIndexedImage->indexes, u8, width * height );
+
+		target->indexedImage = newIndexedImage;
+		newIndexedImage = NULL;
+
+		target->pixels = target->indexedImage->indexes;
+		target->stride = width;
+	}
+	/* the caller's memory */
+	else
+	{
+		PARANOID_ERR_IF( target->mode != PINTO_DECODE_RGBA );
+		PARANOID_ERR_IF( target->pixels == NULL );
+
+		if ( target->stride == 0 )
+		{
+			target->stride = width * 4;
+		}
+
+		ERR_IF( target->stride < width * 4, PINTO_RC_ERROR_PRECOND );
+
+		/* the last row only needs width pixels. tested this way so it can't
+		   overflow */
+		ERR_IF( target->pixelsSize < width * 4, PINTO_RC_ERROR_BUFFER_TOO_SMALL );
+		ERR_IF( height > 1 && ( target->pixelsSize - ( width * 4 ) ) / ( height - 1 ) < target->stride, PINTO_RC_ERROR_BUFFER_TOO_SMALL );
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoIndexedImageFree( &newIndexedImage );
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Allocates a new image that's all transparent.
+	\param[in] width The width of the image.
+	\param[in] height The height of the image.
+	\param[out] image_A On success, the decoded image.
+		Will be allocated. The caller is responsible for freeing by passing the
+		image to pintoImageFree().
+	\return PINTO_RC
+*/
+PINTO_RC pintoImageInit( s32 width, s32 height, PintoImage **image_A )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoImage *newImage = NULL;
+
+#if PINTO_RGBA_ALIGNMENT > 0
+	u8 *allocated = NULL;
+#endif
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF_1( width <= 0 || width > PINTO_MAX_WIDTH, PINTO_RC_ERROR_PRECOND, width );
+	ERR_IF_1( height <= 0 || height > PINTO_MAX_HEIGHT, PINTO_RC_ERROR_PRECOND, height );
+	ERR_IF( image_A == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( (*image_A) != NULL, PINTO_RC_ERROR_PRECOND );
+
+
+	/* CODE */
+	/* create our newImage */
+	PINTO_CALLOC( newImage, PintoImage, 1 );
+
+	/* allocate rgba */
+#if PINTO_RGBA_ALIGNMENT > 0
+	/* the pointer we allocated is kept just before rgba, so it can be freed */
+	PINTO_CALLOC( allocated, u8, ( width * height * 4 ) + sizeof( u8 * ) + PINTO_RGBA_ALIGNMENT - 1 );
+
+	newImage->rgba = allocated + sizeof( u8 * );
+	newImage->rgba += ( PINTO_RGBA_ALIGNMENT - ( (size_t) newImage->rgba & ( PINTO_RGBA_ALIGNMENT - 1 ) ) ) & ( PINTO_RGBA_ALIGNMENT - 1 );
+
+	memcpy( newImage->rgba - sizeof( u8 * ), &allocated, sizeof( u8 * ) );
+#else
+	PINTO_CALLOC( newImage->rgba, u8, width * height * 4 );
+#endif
+
+	newImage->width = width;
+	newImage->height = height;
+
+	/* give back */
+	(*image_A) = newImage;
+	newImage = NULL;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( newImage );
+	newImage = NULL;
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Frees an image.
+	\param[in] image_F The image to be freed. Will be freed with
+		PINTO_HOOK_FREE(). On return, image_F will be NULL.
+	\return void.
+*/
+void pintoImageFree( PintoImage **image_F )
+{
+	/* DATA */
+#if PINTO_RGBA_ALIGNMENT > 0
+	u8 *allocated = NULL;
+#endif
+
+
+	/* CODE */
+	if ( image_F == NULL || (*image_F) == NULL )
+	{
+		return;
+	}
+
+#if PINTO_RGBA_ALIGNMENT > 0
+	/* see pintoImageInit() */
+	if ( (*image_F)->rgba != NULL )
+	{
+		memcpy( &allocated, (*image_F)->rgba - sizeof( u8 * ), sizeof( u8 * ) );
+		PINTO_HOOK_FREE( allocated );
+	}
+#else
+	PINTO_HOOK_FREE( (*image_F)->rgba );
+#endif
+	(*image_F)->rgba = NULL;
+
+	PINTO_HOOK_FREE( (*image_F) );
+	(*image_F) = NULL;
+
+	return;
+}
+
+/******************************************************************************/
+/*!
+	\brief Compresses text with a simple version of deflate.
+	\param[in] textToDeflate_F text to be compressed. On success, will be freed.
+	\param[out] text_A On success, will be compressed text.
+		Will be allocated. The caller is responsible for freeing with
+		pintoTextFree().
+	\return PINTO_RC
+
+	Searches every position in the window for the best match.
+*/
+PINTO_RC pintoSimpleDeflate( PintoText **textToDeflate_F, PintoText **text_A )
+{
+	return pintoSimpleDeflateDepth( textToDeflate_F, PINTO_DEFLATE_CHAIN_DEPTH_MAX, text_A );
+}
+
+/******************************************************************************/
+/*!
+	\brief Compresses text with a simple version of deflate, limiting how hard
+	       we look for matches.
+	\param[in] textToDeflate_F text to be compressed. On success, will be freed.
+	\param[in] chainDepth Maximum amount of earlier positions to compare against
+		when looking for a match. Must be at least 1.
+		PINTO_DEFLATE_CHAIN_DEPTH_MAX compares against every position in the
+		window.
+	\param[out] text_A On success, will be compressed text.
+		Will be allocated. The caller is responsible for freeing with
+		pintoTextFree().
+	\return PINTO_RC
+*/
+PINTO_RC pintoSimpleDeflateDepth( PintoText **textToDeflate_F, s32 chainDepth, PintoText **text_A )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoText *newText = NULL;
+	PintoMatchFinder *finder = NULL;
+
+
+	/* CODE */
+	FAILURE_POINT;
+	PARANOID_ERR_IF( textToDeflate_F == NULL );
+	PARANOID_ERR_IF( (*textToDeflate_F) == NULL );
+	PARANOID_ERR_IF( chainDepth < 1 );
+	PARANOID_ERR_IF( text_A == NULL );
+	PARANOID_ERR_IF( (*text_A) != NULL );
+
+	/* create our match finder */
+	PINTO_MALLOC( finder, PintoMatchFinder, 1 );
+
+	pintoMatchFinderReset( finder, (*textToDeflate_F)->string, (*textToDeflate_F)->usedSize, chainDepth );
+
+	/* create our new text */
+	rc = pintoTextInit( &newText );
+	ERR_IF_PASSTHROUGH;
+
+	/* deflate */
+	rc = pintoDeflateGreedy( finder, newText );
+	ERR_IF_PASSTHROUGH;
+
+	/* free textToDeflate */
+	pintoTextFree( textToDeflate_F );
+
+	/* give back */
+	(*text_A) = newText;
+	newText = NULL;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoTextFree( &newText );
+
+	PINTO_HOOK_FREE( finder );
+	finder = NULL;
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Compresses text with a simple version of deflate, using threads.
+	\param[in] textToDeflate_F text to be compressed. On success, will be freed.
+	\param[in] chainDepth Maximum amount of earlier positions to compare against
+		for each match. See pintoSimpleDeflateDepth().
+	\param[in] threadCount Amount of threads to use.
+	\param[out] text_A On success, will be compressed text.
+		Will be allocated. The caller is responsible for freeing with
+		pintoTextFree().
+	\return PINTO_RC
+
+	Gives the exact same result as pintoSimpleDeflateDepth().
+	See pintoDeflateParallel().
+*/
+PINTO_RC pintoSimpleDeflateParallel( PintoText **textToDeflate_F, s32 chainDepth, s32 threadCount, PintoText **text_A )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoText *newText = NULL;
+	PintoMatchFinder *finder = NULL;
+
+
+	/* CODE */
+	FAILURE_POINT;
+	PARANOID_ERR_IF( textToDeflate_F == NULL );
+	PARANOID_ERR_IF( (*textToDeflate_F) == NULL );
+	PARANOID_ERR_IF( chainDepth < 1 );
+	PARANOID_ERR_IF( text_A == NULL );
+	PARANOID_ERR_IF( (*text_A) != NULL );
+
+	/* create our match finder */
+	PINTO_MALLOC( finder, PintoMatchFinder, 1 );
+
+	pintoMatchFinderReset( finder, (*textToDeflate_F)->string, (*textToDeflate_F)->usedSize, chainDepth );
+
+	/* create our new text */
+	rc = pintoTextInit( &newText );
+	ERR_IF_PASSTHROUGH;
+
+	/* deflate */
+	rc = pintoDeflateParallel( finder, threadCount, newText );
+	ERR_IF_PASSTHROUGH;
+
+	/* free textToDeflate */
+	pintoTextFree( textToDeflate_F );
+
+	/* give back */
+	(*text_A) = newText;
+	newText = NULL;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoTextFree( &newText );
+
+	PINTO_HOOK_FREE( finder );
+	finder = NULL;
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Deflates text greedily, using threads.
+	\param[in] finder Match finder, reset with the text to deflate and the
+		chain depth to use.
+	\param[in] threadCount Amount of threads to use.
+	\param[in] text Text to add the deflated text to.
+	\return PINTO_RC
+
+	Gives the exact same result as pintoDeflateGreedy().
+
+	The text is split into segments, and each segment is deflated greedily on
+	its own thread, starting at the beginning of the segment. Each thread has
+	its own match finder, filled with the window before its segment. The hash
+	chains in the window are the same as they would be deflating serially, so
+	for any chain depth every match it finds is the same one
+	pintoDeflateGreedy() would find at that position.
+
+	Then we walk the whole text one more time, the way pintoDeflateGreedy()
+	would. Wherever we land on a position the segment's thread also landed on,
+	everything from there on is the same, so we just copy its literals and
+	matches. Sometimes we land in the middle of one of the thread's matches,
+	usually right after a segment starts. Then we find matches ourselves until
+	we land on one of the thread's positions again, which is usually soon.
+*/
+static PINTO_RC pintoDeflateParallel( PintoMatchFinder *finder, s32 threadCount, PintoText *text )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	const char *string = NULL;
+	s32 stringLength = 0;
+
+	PintoDeflateJob *jobs = NULL;
+	s32 jobAmount = 0;
+	s32 job = 0;
+	s32 segmentLength = 0;
+
+	s32 i = 0;
+	s32 match = 0;
+
+	/* next position that needs to be inserted into our match finder */
+	s32 insertI = 0;
+
+	s32 bestMatchLength = 0;
+	s32 bestMatchDistance = 0;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( finder == NULL );
+	PARANOID_ERR_IF( threadCount < 1 );
+	PARANOID_ERR_IF( threadCount > PINTO_MAX_THREADS );
+	PARANOID_ERR_IF( text == NULL );
+
+	string = finder->string;
+	stringLength = finder->stringLength;
+
+	/* not worth splitting small texts, each thread has to look through a whole
+	   window before it can start */
+	jobAmount = stringLength / ( PINTO_DEFLATE_WINDOW_SIZE * 4 );
+	if ( jobAmount > threadCount )
+	{
+		jobAmount = threadCount;
+	}
+
+	if ( jobAmount <= 1 )
+	{
+		rc = pintoDeflateGreedy( finder, text );
+		goto cleanup;
+	}
+
+	segmentLength = ( stringLength + jobAmount - 1 ) / jobAmount;
+
+	/* create each segment's job */
+	PINTO_CALLOC( jobs, PintoDeflateJob, jobAmount );
+
+	for ( job = 0; job < jobAmount; job += 1 )
+	{
+		jobs[ job ].start = job * segmentLength;
+		jobs[ job ].end = jobs[ job ].start + segmentLength;
+		if ( jobs[ job ].end > stringLength )
+		{
+			jobs[ job ].end = stringLength;
+		}
+
+		PINTO_MALLOC( jobs[ job ].finder, PintoMatchFinder, 1 );
+		pintoMatchFinderReset( jobs[ job ].finder, string, stringLength, finder->chainDepth );
+
+		/* every match is at least 4 characters */
+		PINTO_MALLOC( jobs[ job ].matches, PintoDeflateMatch, ( segmentLength / 4 ) + 1 );
+		jobs[ job ].matchAmount = 0;
+	}
+
+	/* find each segment's matches */
+	pintoThreadsRun( pintoDeflateJob, jobs, sizeof( PintoDeflateJob ), jobAmount );
+
+	/* now walk the text, like pintoDeflateGreedy() */
+	i = 0;
+	job = 0;
+	match = 0;
+	while ( i <= (stringLength - 4) )
+	{
+		/* which segment are we in? */
+		while ( i >= jobs[ job ].end )
+		{
+			job += 1;
+			match = 0;
+		}
+
+		/* skip the segment's matches that end before us */
+		while (    match < jobs[ job ].matchAmount
+		        && jobs[ job ].matches[ match ].position + jobs[ job ].matches[ match ].length <= i
+		      )
+		{
+			match += 1;
+		}
+
+		/* in the middle of one of the segment's matches? then the segment's
+		   thread never looked at this position, so we have to */
+		if ( match < jobs[ job ].matchAmount && jobs[ job ].matches[ match ].position < i )
+		{
+			/* every position in the window before i must be in the match
+			   finder. anything before the window doesn't matter. */
+			if ( insertI < i - PINTO_DEFLATE_WINDOW_SIZE )
+			{
+				insertI = i - PINTO_DEFLATE_WINDOW_SIZE;
+			}
+
+			while ( insertI < i )
+			{
+				pintoMatchFinderInsert( finder, insertI );
+				insertI += 1;
+			}
+
+			pintoMatchFinderFind( finder, i, &bestMatchLength, &bestMatchDistance );
+
+			/* see pintoDeflateGreedy() */
+			if ( bestMatchLength == 0 || ( bestMatchLength == 4 && bestMatchDistance >= 64 ) )
+			{
+				bestMatchLength = 0;
+			}
+		}
+		/* does the segment's thread have a match here? */
+		else if ( match < jobs[ job ].matchAmount && jobs[ job ].matches[ match ].position == i )
+		{
+			bestMatchLength = jobs[ job ].matches[ match ].length;
+			bestMatchDistance = jobs[ job ].matches[ match ].distance;
+		}
+		/* then it has a literal here */
+		else
+		{
+			bestMatchLength = 0;
+		}
+
+		if ( bestMatchLength == 0 )
+		{
+			rc = pintoTextAddChar( text, string[ i ] );
+			ERR_IF_PASSTHROUGH;
+
+			i += 1;
+		}
+		else
+		{
+			rc = pintoDeflateAddMatch( text, bestMatchDistance, bestMatchLength );
+			ERR_IF_PASSTHROUGH;
+
+			i += bestMatchLength;
+		}
+	}
+
+	/* add rest of string to text */
+	while ( i < stringLength )
+	{
+		rc = pintoTextAddChar( text, string[ i ] );
+		ERR_IF_PASSTHROUGH;
+
+		i += 1;
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	if ( jobs != NULL )
+	{
+		for ( job = 0; job < jobAmount; job += 1 )
+		{
+			PINTO_HOOK_FREE( jobs[ job ].finder );
+			PINTO_HOOK_FREE( jobs[ job ].matches );
+		}
+
+		PINTO_HOOK_FREE( jobs );
+		jobs = NULL;
+	}
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Finds the matches of a greedy parse of one segment. See
+	       pintoSimpleDeflateParallel().
+	\param[in] job The segment's PintoDeflateJob.
+	\return void
+*/
+static void pintoDeflateJob( void *job )
+{
+	/* DATA */
+	PintoDeflateJob *deflateJob = (PintoDeflateJob *) job;
+	PintoMatchFinder *finder = deflateJob->finder;
+
+	s32 i = 0;
+	s32 insertI = 0;
+
+	s32 bestMatchLength = 0;
+	s32 bestMatchDistance = 0;
+
+
+	/* CODE */
+	/* only the window before the segment matters */
+	insertI = deflateJob->start - PINTO_DEFLATE_WINDOW_SIZE;
+	if ( insertI < 0 )
+	{
+		insertI = 0;
+	}
+
+	i = deflateJob->start;
+	while ( i < deflateJob->end && i <= (finder->stringLength - 4) )
+	{
+		while ( insertI < i )
+		{
+			pintoMatchFinderInsert( finder, insertI );
+			insertI += 1;
+		}
+
+		pintoMatchFinderFind( finder, i, &bestMatchLength, &bestMatchDistance );
+
+		/* see pintoDeflateGreedy() */
+		if ( bestMatchLength == 0 || ( bestMatchLength == 4 && bestMatchDistance >= 64 ) )
+		{
+			i += 1;
+		}
+		else
+		{
+			deflateJob->matches[ deflateJob->matchAmount ].position = i;
+			deflateJob->matches[ deflateJob->matchAmount ].length = bestMatchLength;
+			deflateJob->matches[ deflateJob->matchAmount ].distance = bestMatchDistance;
+			deflateJob->matchAmount += 1;
+
+			i += bestMatchLength;
+		}
+	}
+
+	return;
+}
+
+/******************************************************************************/
+/*!
+	\brief Deflates the finder's string by always taking the longest match.
+	\param[in] finder Match finder, reset with the string to deflate.
+	\param[in] text Text to add the deflated string to.
+	\return PINTO_RC
+*/
+static PINTO_RC pintoDeflateGreedy( PintoMatchFinder *finder, PintoText *text )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	const char *string = NULL;
+	s32 stringLength = 0;
+
+	s32 i = 0;
+
+	/* next position that needs to be inserted into the match finder */
+	s32 insertI = 0;
+
+	s32 bestMatchLength = 0;
+	s32 bestMatchDistance = 0;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( finder == NULL );
+	PARANOID_ERR_IF( text == NULL );
+
+	string = finder->string;
+	stringLength = finder->stringLength;
+
+	/* go through string */
+	i = 0;
+	/* we go until there's only 4 characters left, since we can only deflate
+	   at least 4 characters */
+	while ( i <= (stringLength - 4) )
+	{
+		/* every position before i must be in the match finder, including
+		   positions we skipped over with a match */
+		while ( insertI < i )
+		{
+			pintoMatchFinderInsert( finder, insertI );
+			insertI += 1;
+		}
+
+		pintoMatchFinderFind( finder, i, &bestMatchLength, &bestMatchDistance );
+
+		/*    if no match*/
+		/* or if best match length was 4 and the distance was farther than 64, then
+		      the match is 4 characters and the encoding will be 4 characters, so there
+		      is no point deflating. */
+		if (    bestMatchLength == 0
+		     || ( bestMatchLength == 4 && bestMatchDistance >= 64 )
+		   )
+		{
+			rc = pintoTextAddChar( text, string[ i ] );
+			ERR_IF_PASSTHROUGH;
+
+			/* increment i */
+			i += 1;
+		}
+		/* there was a match */
+		else
+		{
+			rc = pintoDeflateAddMatch( text, bestMatchDistance, bestMatchLength );
+			ERR_IF_PASSTHROUGH;
+
+			/* increment i */
+			i += bestMatchLength;
+		}
+	}
+
+	/* add rest of string to text */
+	while ( i < stringLength )
+	{
+		rc = pintoTextAddChar( text, string[ i ] );
+		ERR_IF_PASSTHROUGH;
+
+		/* *** */
+		i += 1;
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Compresses text with a simple version of deflate, finding the
+	       smallest encoding we can.
+	\param[in] textToDeflate_F text to be compressed. On success, will be freed.
+	\param[out] text_A On success, will be compressed text.
+		Will be allocated. The caller is responsible for freeing with
+		pintoTextFree().
+	\return PINTO_RC
+
+	Always taking the longest match isn't always the smallest encoding. A '?'
+	match costs 3 or more characters, an '@' match 4 or more, and the length
+	costs 1 to 5 characters depending on its size, so sometimes a shorter
+	match or a few literal characters is cheaper.
+
+	Finds the cheapest way to encode each part of the text, then also deflates
+	the text greedily like pintoSimpleDeflate(), and gives back whichever is
+	smaller. So this is never worse than pintoSimpleDeflate().
+*/
+PINTO_RC pintoSimpleDeflateOptimal( PintoText **textToDeflate_F, PintoText **text_A )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoText *newText = NULL;
+	PintoText *greedyText = NULL;
+	PintoText *smallestText = NULL;
+	PintoMatchFinder *finder = NULL;
+	PintoOptimalParser *parser = NULL;
+
+
+	/* CODE */
+	FAILURE_POINT;
+	PARANOID_ERR_IF( textToDeflate_F == NULL );
+	PARANOID_ERR_IF( (*textToDeflate_F) == NULL );
+	PARANOID_ERR_IF( text_A == NULL );
+	PARANOID_ERR_IF( (*text_A) != NULL );
+
+	/* create our work space */
+	PINTO_MALLOC( finder, PintoMatchFinder, 1 );
+	PINTO_MALLOC( parser, PintoOptimalParser, 1 );
+
+	/* create our new texts */
+	rc = pintoTextInit( &newText );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoTextInit( &greedyText );
+	ERR_IF_PASSTHROUGH;
+
+	/* deflate */
+	rc = pintoDeflateSmallest( finder, parser, (*textToDeflate_F), newText, greedyText, &smallestText );
+	ERR_IF_PASSTHROUGH;
+
+	if ( smallestText == greedyText )
+	{
+		greedyText = newText;
+		newText = smallestText;
+	}
+
+	/* free textToDeflate */
+	pintoTextFree( textToDeflate_F );
+
+	/* give back */
+	(*text_A) = newText;
+	newText = NULL;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoTextFree( &newText );
+	pintoTextFree( &greedyText );
+
+	PINTO_HOOK_FREE( finder );
+	finder = NULL;
+
+	PINTO_HOOK_FREE( parser );
+	parser = NULL;
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Deflates text both optimally and greedily, and picks whichever is
+	       smaller.
+	\param[in] finder Match finder to use.
+	\param[in] parser Optimal parser to use.
+	\param[in] textToDeflate Text to deflate.
+	\param[in] optimalText Empty text to add the optimal deflate to.
+	\param[in] greedyText Empty text to add the greedy deflate to.
+	\param[out] smallestText On success, either optimalText or greedyText.
+		Greedy is picked if it's the same size.
+	\return PINTO_RC
+*/
+static PINTO_RC pintoDeflateSmallest( PintoMatchFinder *finder, PintoOptimalParser *parser, const PintoText *textToDeflate, PintoText *optimalText, PintoText *greedyText, PintoText **smallestText )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( finder == NULL );
+	PARANOID_ERR_IF( parser == NULL );
+	PARANOID_ERR_IF( textToDeflate == NULL );
+	PARANOID_ERR_IF( optimalText == NULL );
+	PARANOID_ERR_IF( greedyText == NULL );
+	PARANOID_ERR_IF( smallestText == NULL );
+
+	/* deflate optimally */
+	pintoMatchFinderReset( finder, textToDeflate->string, textToDeflate->usedSize, PINTO_DEFLATE_CHAIN_DEPTH_MAX );
+
+	rc = pintoDeflateOptimal( finder, parser, optimalText );
+	ERR_IF_PASSTHROUGH;
+
+	/* deflate greedily */
+	pintoMatchFinderReset( finder, textToDeflate->string, textToDeflate->usedSize, PINTO_DEFLATE_CHAIN_DEPTH_MAX );
+
+	rc = pintoDeflateGreedy( finder, greedyText );
+	ERR_IF_PASSTHROUGH;
+
+	/* use whichever is smaller */
+	(*smallestText) = ( greedyText->usedSize <= optimalText->usedSize ? greedyText : optimalText );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Deflates the finder's string by finding the cheapest sequence of
+	       literals and matches.
+	\param[in] finder Match finder, reset with the string to deflate.
+	\param[in] parser Work space.
+	\param[in] text Text to add the deflated string to.
+	\return PINTO_RC
+
+	Works on PINTO_DEFLATE_OPTIMAL_WINDOW positions at a time. For each
+	position in the window, we know the cheapest way to reach it, and from
+	there we try a literal and every length of every match, to see if that's a
+	cheaper way to reach a later position. Then we walk back from the end of
+	the window to get the cheapest way to encode the whole window.
+
+	Matches of PINTO_DEFLATE_NICE_LENGTH or more are always taken, which ends
+	the window early. Long matches are almost always the right choice, and this
+	keeps us from trying every length of a very long match.
+*/
+static PINTO_RC pintoDeflateOptimal( PintoMatchFinder *finder, PintoOptimalParser *parser, PintoText *text )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	const char *string = NULL;
+	s32 stringLength = 0;
+
+	/* start of the current window */
+	s32 position = 0;
+	/* next position that needs to be inserted into the match finder */
+	s32 insertI = 0;
+
+	/* these are relative to position */
+	s32 i = 0;
+	s32 end = 0;
+	s32 next = 0;
+
+	s32 matchAmount = 0;
+	s32 match = 0;
+	s32 length = 0;
+	s32 shortestLength = 0;
+	s32 price = 0;
+
+	s32 longMatchLength = 0;
+	s32 longMatchDistance = 0;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( finder == NULL );
+	PARANOID_ERR_IF( parser == NULL );
+	PARANOID_ERR_IF( text == NULL );
+
+	string = finder->string;
+	stringLength = finder->stringLength;
+
+	while ( position < stringLength )
+	{
+		end = stringLength - position;
+		if ( end > PINTO_DEFLATE_OPTIMAL_WINDOW )
+		{
+			end = PINTO_DEFLATE_OPTIMAL_WINDOW;
+		}
+
+		longMatchLength = 0;
+
+		/* nothing is reachable yet, except the start of the window */
+		parser->price[ 0 ] = 0;
+		for ( i = 1; i < end + PINTO_DEFLATE_NICE_LENGTH; i += 1 )
+		{
+			parser->price[ i ] = 0x7FFFFFFF;
+		}
+
+		for ( i = 0; i < end; i += 1 )
+		{
+			/* try a literal */
+			price = parser->price[ i ] + 1;
+			if ( price < parser->price[ i + 1 ] )
+			{
+				parser->price[ i + 1 ] = price;
+				parser->length[ i + 1 ] = 1;
+				parser->distance[ i + 1 ] = 0;
+			}
+
+			/* we can only deflate at least 4 characters */
+			if ( position + i > stringLength - 4 )
+			{
+				continue;
+			}
+
+			/* every position before this one must be in the match finder */
+			while ( insertI < position + i )
+			{
+				pintoMatchFinderInsert( finder, insertI );
+				insertI += 1;
+			}
+
+			pintoMatchFinderFindAll( finder, position + i, PINTO_DEFLATE_NICE_LENGTH, parser->matchLengths, parser->matchDistances, &matchAmount );
+
+			/* is there a long match? then just take it */
+			if ( matchAmount > 0 && parser->matchLengths[ matchAmount - 1 ] == PINTO_DEFLATE_NICE_LENGTH )
+			{
+				longMatchDistance = parser->matchDistances[ matchAmount - 1 ];
+				longMatchLength = PINTO_DEFLATE_NICE_LENGTH;
+				while (    position + i + longMatchLength < stringLength
+				        && string[ position + i + longMatchLength ] == string[ position + i + longMatchLength - longMatchDistance ]
+				      )
+				{
+					longMatchLength += 1;
+				}
+
+				/* end the window here */
+				end = i;
+				break;
+			}
+
+			/* try every length of every match.
+			   the matches come back from closest to farthest, each one longer
+			   than the last, so each length is tried with the closest match
+			   that's long enough, which is the cheapest. */
+			shortestLength = 4;
+			for ( match = 0; match < matchAmount; match += 1 )
+			{
+				for ( length = shortestLength; length <= parser->matchLengths[ match ]; length += 1 )
+				{
+					price = parser->price[ i ] + pintoDeflateMatchCost( parser->matchDistances[ match ], length );
+					if ( price < parser->price[ i + length ] )
+					{
+						parser->price[ i + length ] = price;
+						parser->length[ i + length ] = length;
+						parser->distance[ i + length ] = parser->matchDistances[ match ];
+					}
+				}
+
+				shortestLength = parser->matchLengths[ match ] + 1;
+			}
+		}
+
+		/* walk back from the end of the window, and point the start of each
+		   literal or match at its end. we're done with the prices, so we
+		   reuse them for this. */
+		i = end;
+		while ( i > 0 )
+		{
+			next = i;
+			i -= parser->length[ next ];
+			parser->price[ i ] = next;
+		}
+
+		/* now walk forward, adding the literals and matches */
+		i = 0;
+		while ( i < end )
+		{
+			next = parser->price[ i ];
+
+			if ( parser->length[ next ] == 1 )
+			{
+				rc = pintoTextAddChar( text, string[ position + i ] );
+				ERR_IF_PASSTHROUGH;
+			}
+			else
+			{
+				rc = pintoDeflateAddMatch( text, parser->distance[ next ], parser->length[ next ] );
+				ERR_IF_PASSTHROUGH;
+			}
+
+			i = next;
+		}
+
+		position += end;
+
+		/* add the long match that ended the window */
+		if ( longMatchLength > 0 )
+		{
+			rc = pintoDeflateAddMatch( text, longMatchDistance, longMatchLength );
+			ERR_IF_PASSTHROUGH;
+
+			position += longMatchLength;
+		}
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief How many characters a deflate match will be encoded as.
+	\param[in] distance How far back the match starts.
+	\param[in] length Length of the match.
+	\return s32 Amount of characters.
+
+	See pintoDeflateAddMatch() and pintoTextAddValue().
+*/
+static s32 pintoDeflateMatchCost( s32 distance, s32 length )
+{
+	/* DATA */
+	s32 cost = 0;
+
+
+	/* CODE */
+	/* '?' and 1 character, or '@' and 2 characters */
+	cost = ( distance < 64 ? 2 : 3 );
+
+	if ( length < 64 )
+	{
+		cost += 1;
+	}
+	else if ( length < ( 64 * 14 ) )
+	{
+		cost += 2;
+	}
+	else if ( length < ( 64 * 64 ) )
+	{
+		cost += 3;
+	}
+	else if ( length < ( 64 * 64 * 64 ) )
+	{
+		cost += 4;
+	}
+	else
+	{
+		cost += 5;
+	}
+
+	return cost;
+}
+
+/******************************************************************************/
+/*!
+	\brief Adds a deflate match to text.
+	\param[in] text Text.
+	\param[in] distance How far back the match starts. 1 to ( 64 * 64 ) - 1.
+	\param[in] length Length of the match.
+	\return PINTO_RC
+
+	Distances 1-63 are encoded as '?' followed by a single character.
+	Distances 64-4095 are encoded as '@' followed by two characters.
+	Both are then followed by the length, encoded with pintoTextAddValue().
+*/
+static PINTO_RC pintoDeflateAddMatch( PintoText *text, s32 distance, s32 length )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( text == NULL );
+	PARANOID_ERR_IF( distance < 1 );
+	PARANOID_ERR_IF( distance >= ( 64 * 64 ) );
+	PARANOID_ERR_IF( length < 4 );
+
+	if ( distance < 64 )
+	{
+		rc = pintoTextAddChar( text, '?' );
+		ERR_IF_PASSTHROUGH;
+
+		rc = pintoTextAddValue( text, distance );
+		ERR_IF_PASSTHROUGH;
+	}
+	else
+	{
+		rc = pintoTextAddChar( text, '@' );
+		ERR_IF_PASSTHROUGH;
+
+		rc = pintoTextAddChar( text, valueToChar[ ( (distance) / 64 ) % 64 ] );
+		ERR_IF_PASSTHROUGH;
+
+		rc = pintoTextAddChar( text, valueToChar[   (distance)        % 64 ] );
+		ERR_IF_PASSTHROUGH;
+	}
+
+	rc = pintoTextAddValue( text, length );
+	ERR_IF_PASSTHROUGH;
+
+
+	/* CLEANUP */
+	cleanup:
 
 	return rc;
 }
 
+/******************************************************************************/
+/* Hashes the 4 characters starting at s, which is the shortest match deflate
+   will use. */
+#define PINTO_DEFLATE_HASH( s ) \
+	( ( ( (   ( ( (u32) (u8) (s)[ 0 ] ) << 24 ) \
+	        | ( ( (u32) (u8) (s)[ 1 ] ) << 16 ) \
+	        | ( ( (u32) (u8) (s)[ 2 ] ) <<  8 ) \
+	        |   ( (u32) (u8) (s)[ 3 ] ) \
+	      ) * 2654435761U ) >> 20 ) & ( PINTO_DEFLATE_HASH_SIZE - 1 ) )
+
 /******************************************************************************/
 /*!
-	\brief Decodes a text into an image.
-	\param[in] text_F The text to be decoded. On success, this will be freed.
-	\param[out] image_A On success, the decoded image.
-		Will be allocated. The caller is responsible for freeing by passing the
-		image to pintoImageFree().
-	\return PINTO_RC
+	\brief Resets a match finder so it can find matches in a new string.
+	\param[in] finder Match finder.
+	\param[in] string String to find matches in. Must stay valid while the
+		match finder is used.
+	\param[in] stringLength Length of string.
+	\param[in] chainDepth Maximum amount of earlier positions to compare against
+		when finding a match.
+	\return void
 */
-PINTO_RC pintoImageDecodeText( PintoText **text_F, PintoImage **image_A )
+void pintoMatchFinderReset( PintoMatchFinder *finder, const char *string, s32 stringLength, s32 chainDepth )
 {
 	/* DATA */
-	PINTO_RC rc = PINTO_RC_SUCCESS;
-
-	PintoText *text = NULL;
-
-	PintoImage *newImage = NULL;
-
-	char header = 0;
-
-	s32 colorIndex = 0;
 	s32 i = 0;
-	s32 pixelIndex = 0;
 
-	char ch = 0;
-	s32 value = 0;
 
-	s32 width = 0;
-	s32 height = 0;
+	/* CODE */
+	PARANOID_ERR_IF( finder == NULL );
+	PARANOID_ERR_IF( string == NULL );
+	PARANOID_ERR_IF( stringLength < 0 );
+	PARANOID_ERR_IF( chainDepth < 1 );
 
-	s32 colorAmount = 0;
-	u8 *palette = NULL;
+	finder->string = string;
+	finder->stringLength = stringLength;
+	finder->chainDepth = chainDepth;
 
-	char flagOn = 0;
+	for ( i = 0; i < PINTO_DEFLATE_HASH_SIZE; i += 1 )
+	{
+		finder->head[ i ] = -1;
+	}
 
+	return;
+}
 
-	/* PRECOND */
-	FAILURE_POINT;
-	ERR_IF( text_F == NULL, PINTO_RC_ERROR_PRECOND );
-	ERR_IF( (*text_F) == NULL, PINTO_RC_ERROR_PRECOND );
-	ERR_IF( image_A == NULL, PINTO_RC_ERROR_PRECOND );
-	ERR_IF( (*image_A) != NULL, PINTO_RC_ERROR_PRECOND );
+/******************************************************************************/
+/*!
+	\brief Inserts a position into the match finder, so later positions can
+	       match against it.
+	\param[in] finder Match finder.
+	\param[in] position Position to insert. Positions must be inserted in
+		increasing order.
+	\return void
+*/
+void pintoMatchFinderInsert( PintoMatchFinder *finder, s32 position )
+{
+	/* DATA */
+	u32 hash = 0;
 
 
 	/* CODE */
+	PARANOID_ERR_IF( finder == NULL );
+	PARANOID_ERR_IF( position < 0 );
 
-	/* inflate */
-	rc = pintoSimpleInflate( text_F, &text );
-	ERR_IF_PASSTHROUGH;
-
-	/* get header */
-	rc = pintoTextGetChar( text, &header );
-	ERR_IF_PASSTHROUGH;
-
-	/* standard header marker */
-	if ( header == 'a' )
+	/* positions that don't have 4 characters after them can never be
+	   matched against */
+	if ( position > finder->stringLength - 4 )
 	{
-		/* get width */
-		rc = pintoTextGetValue( text, &width );
-		ERR_IF_PASSTHROUGH;
+		return;
+	}
 
-		ERR_IF_1( width <= 0, PINTO_RC_ERROR_FORMAT_INVALID, width );
-		ERR_IF_1( width > PINTO_MAX_WIDTH, PINTO_RC_ERROR_FORMAT_INVALID, width );
+	hash = PINTO_DEFLATE_HASH( finder->string + position );
 
-		/* get height */
-		rc = pintoTextGetValue( text, &height );
-		ERR_IF_PASSTHROUGH;
+	finder->prev[ position & ( PINTO_DEFLATE_WINDOW_SIZE - 1 ) ] = finder->head[ hash ];
+	finder->head[ hash ] = position;
 
-		ERR_IF_1( height <= 0, PINTO_RC_ERROR_FORMAT_INVALID, height );
-		ERR_IF_1( height > PINTO_MAX_HEIGHT, PINTO_RC_ERROR_FORMAT_INVALID, height );
+	return;
+}
 
-		/* allocate new image */
-		rc = pintoImageInit( width, height, &newImage );
-		ERR_IF_PASSTHROUGH;
+/******************************************************************************/
+/*!
+	\brief Finds the longest match for a position.
+	\param[in] finder Match finder. Every position before position must have
+		been inserted.
+	\param[in] position Position to find a match for. Must have at least 4
+		characters after it.
+	\param[out] length Length of the longest match, or 0 if there was no
+		match of at least 4 characters.
+	\param[out] distance How far back the longest match is. If more than one
+		match has the longest length, this will be the closest one.
+	\return void
+
+	Walks the hash chain from the closest position to the farthest, so with a
+	chain depth of PINTO_DEFLATE_CHAIN_DEPTH_MAX this gives the exact same match
+	as comparing against every position in the window.
+*/
+void pintoMatchFinderFind( PintoMatchFinder *finder, s32 position, s32 *length, s32 *distance )
+{
+	/* DATA */
+	const char *string = NULL;
+	const char *current = NULL;
+	const char *match = NULL;
 
-		/* get number of colors in palette */
-		rc = pintoTextGetValue( text, &colorAmount );
-		ERR_IF_PASSTHROUGH;
+	s32 matchI = 0;
+	s32 matchLength = 0;
+	s32 maxMatchLength = 0;
 
-		ERR_IF_1( colorAmount > PINTO_MAX_COLORS, PINTO_RC_ERROR_FORMAT_INVALID, colorAmount );
+	s32 depth = 0;
 
-		if ( colorAmount > 0 )
-		{
-			/* allocate palette */
-			PINTO_CALLOC( palette, u8, colorAmount * 3 );
 
-			/* read in colors */
-			for ( colorIndex = 0; colorIndex < ( colorAmount * 3 ); colorIndex += 1 )
+	/* CODE */
+	PARANOID_ERR_IF( finder == NULL );
+	PARANOID_ERR_IF( position < 0 );
+	PARANOID_ERR_IF( position > finder->stringLength - 4 );
+	PARANOID_ERR_IF( length == NULL );
+	PARANOID_ERR_IF( distance == NULL );
+
+	(*length) = 0;
+	(*distance) = 0;
+
+	string = finder->string;
+	current = string + position;
+
+	/* we dont need to worry about a match becoming larger than we can
+	   encode, because we only allow PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT
+	   characters in the string, so the max we'll have to encode is
+	   ( PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT ) - 1
+	   which is exactly the max we can encode. (given than the max width
+	   and height is 4096 and we use 4 64 values in encoding) */
+	maxMatchLength = finder->stringLength - position;
+
+	matchI = finder->head[ PINTO_DEFLATE_HASH( current ) ];
+	depth = finder->chainDepth;
+
+	/* positions in the chain only get farther away, so once we're outside the
+	   window we're done */
+	while ( matchI >= 0 && ( position - matchI ) < PINTO_DEFLATE_WINDOW_SIZE && depth > 0 )
+	{
+		match = string + matchI;
+
+		/* do at least 4 characters match?
+		   different strings can have the same hash, so we need to check */
+		if (    match[ 0 ] == current[ 0 ]
+		     && match[ 1 ] == current[ 1 ]
+		     && match[ 2 ] == current[ 2 ]
+		     && match[ 3 ] == current[ 3 ]
+		   )
+		{
+			/* see how long the match is */
+			matchLength = 4;
+			while ( matchLength < maxMatchLength && match[ matchLength ] == current[ matchLength ] )
 			{
-				value = 0;
+				matchLength += 1;
+			}
 
-				rc = pintoTextUpdateValue( text, &value );
-				ERR_IF_PASSTHROUGH;
+			/* is this our best match? */
+			if ( matchLength > (*length) )
+			{
+				(*length) = matchLength;
+				(*distance) = position - matchI;
 
-				palette[ colorIndex ] = PINTO_6_BITS_TO_8_BITS( value );
+				/* nothing farther away can be longer */
+				if ( matchLength == maxMatchLength )
+				{
+					break;
+				}
 			}
-
 		}
+
+		/* try the next position with the same hash */
+		matchI = finder->prev[ matchI & ( PINTO_DEFLATE_WINDOW_SIZE - 1 ) ];
+		depth -= 1;
 	}
-	/* smaller header */
-	else
-	{
-		if ( header == '0' )
-		{
-			width = height = 8;
-		}
-		else if ( header == '1' )
-		{
-			width = height = 16;
-		}
-		else if ( header == '2' )
-		{
-			width = height = 32;
-		}
-		else if ( header == '3' )
-		{
-			width = height = 64;
-		}
-		else if ( header == '4' )
-		{
-			width = height = 128;
-		}
-		else if ( header == '5' )
-		{
-			width = height = 256;
-		}
-		else if ( header == '6' )
-		{
-			width = height = 512;
-		}
-		else if ( header == '7' )
-		{
-			width = height = 1024;
-		}
-		else if ( header == '8' )
-		{
-			width = height = 2048;
-		}
-		else if ( header == '9' )
-		{
-			width = height = 4096;
-		}
-		else
-		{
-			ERR_IF_1( 1, PINTO_RC_ERROR_FORMAT_INVALID, header );
-		}
 
-		/* allocate new image */
-		rc = pintoImageInit( width, height, &newImage );
-		ERR_IF_PASSTHROUGH;
+	return;
+}
 
-		colorAmount = 1;
+/******************************************************************************/
+/*!
+	\brief Finds every match for a position that's longer than the closer
+	       matches.
+	\param[in] finder Match finder. Every position before position must have
+		been inserted.
+	\param[in] position Position to find matches for. Must have at least 4
+		characters after it.
+	\param[in] maxLength Don't look at more than this many characters of a
+		match. Must be at least 4.
+	\param[out] lengths Lengths of the matches. Must have room for the
+		finder's chain depth.
+	\param[out] distances Distances of the matches. Must have room for the
+		finder's chain depth.
+	\param[out] amount Amount of matches found.
+	\return void
+
+	Matches are given back from closest to farthest, and each one is longer
+	than the one before it. So the closest match for any length is the first
+	one that's at least that long. If a match reaches maxLength, it's the last
+	one given back.
+*/
+void pintoMatchFinderFindAll( PintoMatchFinder *finder, s32 position, s32 maxLength, s32 *lengths, s32 *distances, s32 *amount )
+{
+	/* DATA */
+	const char *string = NULL;
+	const char *current = NULL;
+	const char *match = NULL;
 
-		/* allocate palette */
-		/* since this is calloc, our single color will be black, which is
-		   what we want */
-		PINTO_CALLOC( palette, u8, colorAmount * 3 );
-	}
+	s32 matchI = 0;
+	s32 matchLength = 0;
+	s32 bestMatchLength = 0;
 
-	/* foreach color */
-	for ( colorIndex = 0; colorIndex < colorAmount; colorIndex += 1 )
-	{
-		pixelIndex = 0;
-		flagOn = 0;
+	s32 depth = 0;
 
-		/* rle decoding */
-		while ( 1 )
-		{
-			/* peek at current character to see if it's a '^', which
-			   signals end of current color */
-			rc = pintoTextPeekChar( text, &ch );
-			ERR_IF_PASSTHROUGH;
 
-			if ( ch == '^' )
-			{
-				/* we just peeked, now we must remove it to move
-				   past it in the text */
-				rc = pintoTextGetChar( text, &ch );
-				PARANOID_ERR_IF( rc != PINTO_RC_SUCCESS );
+	/* CODE */
+	PARANOID_ERR_IF( finder == NULL );
+	PARANOID_ERR_IF( position < 0 );
+	PARANOID_ERR_IF( position > finder->stringLength - 4 );
+	PARANOID_ERR_IF( maxLength < 4 );
+	PARANOID_ERR_IF( lengths == NULL );
+	PARANOID_ERR_IF( distances == NULL );
+	PARANOID_ERR_IF( amount == NULL );
 
-				break;
-			}
+	(*amount) = 0;
 
-			/* get the rle value */
-			rc = pintoTextGetValue( text, &value );
-			ERR_IF_PASSTHROUGH;
+	string = finder->string;
+	current = string + position;
+
+	if ( maxLength > finder->stringLength - position )
+	{
+		maxLength = finder->stringLength - position;
+	}
+
+	matchI = finder->head[ PINTO_DEFLATE_HASH( current ) ];
+	depth = finder->chainDepth;
 
-			/* make sure it doesn't go past end of rgba array */
-			ERR_IF( pixelIndex + ( value * 4 ) >= ( width * height * 4 ), PINTO_RC_ERROR_FORMAT_INVALID );
+	while ( matchI >= 0 && ( position - matchI ) < PINTO_DEFLATE_WINDOW_SIZE && depth > 0 )
+	{
+		match = string + matchI;
 
-			/* if we're in off state, just increment our pixelIndex */
-			if ( flagOn == 0 )
+		if (    match[ 0 ] == current[ 0 ]
+		     && match[ 1 ] == current[ 1 ]
+		     && match[ 2 ] == current[ 2 ]
+		     && match[ 3 ] == current[ 3 ]
+		   )
+		{
+			matchLength = 4;
+			while ( matchLength < maxLength && match[ matchLength ] == current[ matchLength ] )
 			{
-				pixelIndex += ( value * 4 );
+				matchLength += 1;
 			}
-			/* else we're in the on state, so draw our run */
-			else
+
+			if ( matchLength > bestMatchLength )
 			{
-				for ( i = 0; i < value; i += 1, pixelIndex += 4 )
+				bestMatchLength = matchLength;
+
+				lengths[ (*amount) ] = matchLength;
+				distances[ (*amount) ] = position - matchI;
+				(*amount) += 1;
+
+				if ( matchLength == maxLength )
 				{
-					newImage->rgba[ pixelIndex     ] = palette[ ( colorIndex * 3 )     ];
-					newImage->rgba[ pixelIndex + 1 ] = palette[ ( colorIndex * 3 ) + 1 ];
-					newImage->rgba[ pixelIndex + 2 ] = palette[ ( colorIndex * 3 ) + 2 ];
-					newImage->rgba[ pixelIndex + 3 ] = 255;
+					break;
 				}
 			}
+		}
 
-			/* switch states */
-			flagOn = ( ! flagOn );
+		matchI = finder->prev[ matchI & ( PINTO_DEFLATE_WINDOW_SIZE - 1 ) ];
+		depth -= 1;
+	}
 
-		} /* end rle decoding */
+	return;
+}
+
+/******************************************************************************/
+/*!
+	\brief Uncompresses text with a simple version of deflate (inflate here).
+	\param[in] textToDeflate_F text to be uncompressed. On success, will be freed.
+	\param[out] text_A On success, will be uncompressed text.
+		Will be allocated. The caller is responsible for freeing with
+		pintoTextFree().
+	\return PINTO_RC
+*/
+PINTO_RC pintoSimpleInflate( PintoText **textToInflate_F, PintoText **text_A )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoInflater inflater;
+	PintoText *window = &inflater.window;
+
+	s32 inflatedSize = 0;
+	PintoText *newText = NULL;
+
+
+	/* CODE */
+	FAILURE_POINT;
+	PARANOID_ERR_IF( textToInflate_F == NULL );
+	PARANOID_ERR_IF( (*textToInflate_F) == NULL );
+	PARANOID_ERR_IF( text_A == NULL );
+	PARANOID_ERR_IF( (*text_A) != NULL );
+
+	memset( &inflater, 0, sizeof( PintoInflater ) );
 
-		/* the last rleValue is implicit,
-		   if we're in on state */
-		if ( flagOn )
+	rc = pintoInflaterInit( &inflater, (*textToInflate_F), PINTO_INFLATE_WINDOW_SIZE );
+	ERR_IF_PASSTHROUGH;
+
+	/* create our new text. if we know how big it'll be, it never needs to
+	   grow. if we don't, the text is invalid, and inflating will find out
+	   why. */
+	inflatedSize = pintoInflatedSize( (*textToInflate_F) );
+
+	if ( inflatedSize >= 0 )
+	{
+		rc = pintoTextInitSize( &newText, inflatedSize + 1 );
+		ERR_IF_PASSTHROUGH;
+	}
+	else
+	{
+		rc = pintoTextInit( &newText );
+		ERR_IF_PASSTHROUGH;
+	}
+
+	/* add each piece as it's inflated */
+	while ( 1 )
+	{
+		rc = pintoInflaterFill( &inflater, 1 );
+		ERR_IF_PASSTHROUGH;
+
+		if ( pintoInflaterAtEnd( &inflater ) )
 		{
-			/* draw until end of image */
-			for ( ; pixelIndex < ( width * height * 4 ); pixelIndex += 4 )
-			{
-				newImage->rgba[ pixelIndex     ] = palette[ ( colorIndex * 3 )     ];
-				newImage->rgba[ pixelIndex + 1 ] = palette[ ( colorIndex * 3 ) + 1 ];
-				newImage->rgba[ pixelIndex + 2 ] = palette[ ( colorIndex * 3 ) + 2 ];
-				newImage->rgba[ pixelIndex + 3 ] = 255;
-			}
+			break;
 		}
 
-	} /* end foreach color */
+		rc = pintoTextAddChars( newText, window->string + window->index, window->usedSize - window->index );
+		ERR_IF_PASSTHROUGH;
 
-	/* must be at end of text */
-	ERR_IF( pintoTextAtEnd( text ) == 0, PINTO_RC_ERROR_FORMAT_INVALID );
+		window->index = window->usedSize;
+	}
 
 	/* give back */
-	(*image_A) = newImage;
-	newImage = NULL;
+	(*text_A) = newText;
+	newText = NULL;
 
-	pintoTextFree( text_F );
+	pintoTextFree( textToInflate_F );
 
 
 	/* CLEANUP */
 	cleanup:
 
-	PINTO_HOOK_FREE( palette );
-	palette = NULL;
+	pintoTextFree( &newText );
+
+	pintoInflaterFree( &inflater );
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Finds how many characters a text inflates to, without inflating it.
+	\param[in] text Text to be uncompressed, from its index on.
+	\return s32 Amount of characters, or -1 if the text has an invalid value,
+		an invalid reference, or is too long.
+
+	References are checked the same as pintoInflaterFill() checks them, so a
+	bad reference can't make the text look big.
+*/
+static s32 pintoInflatedSize( const PintoText *text )
+{
+	/* DATA */
+	PintoText scan;
+
+	s32 size = 0;
+
+	char ch = 0;
+	s32 distance = 0;
+	s32 length = 0;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( text == NULL );
+
+	/* read a copy, so text's index doesn't move */
+	scan = (*text);
+
+	while ( ! pintoTextAtEnd( &scan ) )
+	{
+		pintoTextGetChar( &scan, &ch );
+
+		if ( ch == '?' || ch == '@' )
+		{
+			distance = 0;
+
+			if ( pintoTextUpdateValue( &scan, &distance ) != PINTO_RC_SUCCESS )
+			{
+				return -1;
+			}
+
+			if ( ch == '@' && pintoTextUpdateValue( &scan, &distance ) != PINTO_RC_SUCCESS )
+			{
+				return -1;
+			}
+
+			if ( pintoTextGetValue( &scan, &length ) != PINTO_RC_SUCCESS )
+			{
+				return -1;
+			}
+
+			if ( distance == 0 || length == 0 || distance > size )
+			{
+				return -1;
+			}
 
-	pintoTextFree( &text );
+			size += length;
+		}
+		else
+		{
+			size += 1;
 
-	pintoImageFree( &newImage );
+			/* count the plain chars after it at once */
+			while (    scan.index < scan.usedSize
+			        && scan.string[ scan.index ] != '?'
+			        && scan.string[ scan.index ] != '@'
+			      )
+			{
+				size += PINTO_CHAR_IS_VALID( scan.string[ scan.index ] );
+				scan.index += 1;
+			}
+		}
 
-	return rc;
+		if ( size > ( PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT ) )
+		{
+			return -1;
+		}
+	}
+
+	return size;
 }
 
 /******************************************************************************/
 /*!
-	\brief Allocates a new image that's all transparent.
-	\param[in] width The width of the image.
-	\param[in] height The height of the image.
-	\param[out] image_A On success, the decoded image.
-		Will be allocated. The caller is responsible for freeing by passing the
-		image to pintoImageFree().
+	\brief Sets up an inflater.
+	\param[in] inflater Inflater.
+	\param[in] source Text to be uncompressed, from its index on.
+	\param[in] bufferSize Amount of inflated characters to hold at a time.
+		Normally PINTO_INFLATE_WINDOW_SIZE. Use PINTO_DEFLATE_WINDOW_SIZE or
+		less to only inflate the start of the text.
 	\return PINTO_RC
+
+	On success or failure, the inflater must be given to pintoInflaterFree().
 */
-PINTO_RC pintoImageInit( s32 width, s32 height, PintoImage **image_A )
+static PINTO_RC pintoInflaterInit( PintoInflater *inflater, PintoText *source, s32 bufferSize )
 {
 	/* DATA */
 	PINTO_RC rc = PINTO_RC_SUCCESS;
 
-	PintoImage *newImage = NULL;
-
-
-	/* PRECOND */
-	FAILURE_POINT;
-	ERR_IF_1( width <= 0 || width > PINTO_MAX_WIDTH, PINTO_RC_ERROR_PRECOND, width );
-	ERR_IF_1( height <= 0 || height > PINTO_MAX_HEIGHT, PINTO_RC_ERROR_PRECOND, height );
-	ERR_IF( image_A == NULL, PINTO_RC_ERROR_PRECOND );
-	ERR_IF( (*image_A) != NULL, PINTO_RC_ERROR_PRECOND );
-
 
 	/* CODE */
-	/* create our newImage */
-	PINTO_CALLOC( newImage, PintoImage, 1 );
+	PARANOID_ERR_IF( inflater == NULL );
+	PARANOID_ERR_IF( source == NULL );
+	PARANOID_ERR_IF( bufferSize <= 0 || bufferSize > PINTO_INFLATE_WINDOW_SIZE );
 
-	/* allocate rgba */
-	PINTO_CALLOC( newImage->rgba, u8, width * height * 4 );
+	memset( inflater, 0, sizeof( PintoInflater ) );
 
-	newImage->width = width;
-	newImage->height = height;
+	inflater->source = source;
 
-	/* give back */
-	(*image_A) = newImage;
-	newImage = NULL;
+	PINTO_MALLOC( inflater->buffer, char, bufferSize );
+	inflater->bufferSize = bufferSize;
+
+	/* the window starts empty */
+	inflater->window.string = inflater->buffer;
 
 
 	/* CLEANUP */
 	cleanup:
 
-	PINTO_HOOK_FREE( newImage );
-	newImage = NULL;
-
 	return rc;
 }
 
 /******************************************************************************/
 /*!
-	\brief Frees an image.
-	\param[in] image_F The image to be freed. Will be freed with
-		PINTO_HOOK_FREE(). On return, image_F will be NULL.
-	\return void.
+	\brief Frees what an inflater holds.
+	\param[in] inflater Inflater.
+	\return void
 */
-void pintoImageFree( PintoImage **image_F )
+static void pintoInflaterFree( PintoInflater *inflater )
 {
 	/* CODE */
-	if ( image_F == NULL || (*image_F) == NULL )
-	{
-		return;
-	}
-
-	PINTO_HOOK_FREE( (*image_F)->rgba );
-	(*image_F)->rgba = NULL;
+	PARANOID_ERR_IF( inflater == NULL );
 
-	PINTO_HOOK_FREE( (*image_F) );
-	(*image_F) = NULL;
+	PINTO_HOOK_FREE( inflater->buffer );
+	inflater->buffer = NULL;
 
 	return;
 }
 
 /******************************************************************************/
 /*!
-	\brief Compresses text with a simple version of deflate.
-	\param[in] textToDeflate_F text to be compressed. On success, will be freed.
-	\param[out] text_A On success, will be compressed text.
-		Will be allocated. The caller is responsible for freeing with
-		pintoTextFree().
+	\brief Inflates more characters into the inflater's window, if there are
+		fewer than amount left to read in it.
+	\param[in] inflater Inflater.
+	\param[in] amount Amount of characters that the caller wants to read.
 	\return PINTO_RC
+
+	When it inflates, it fills the whole window, so most calls only need to
+	compare. There can still be fewer than amount characters left to read
+	afterwards, if the source ends.
+
+	The characters that have been read are dropped from the start of the
+	window, except the last ones that a reference can still copy.
 */
-PINTO_RC pintoSimpleDeflate( PintoText **textToDeflate_F, PintoText **text_A )
+static PINTO_RC pintoInflaterFill( PintoInflater *inflater, s32 amount )
 {
 	/* DATA */
 	PINTO_RC rc = PINTO_RC_SUCCESS;
 
-	PintoText *newText = NULL;
-	char *string = NULL;
-	s32 stringLength = 0;
+	PintoText *window = NULL;
+	PintoText *source = NULL;
 
-	s32 i = 0;
+	s32 keepStart = 0;
 
-	s32 matchI = 0;
-	s32 matchLength = 0;
+	char ch = 0;
 
-	s32 bestMatchLength = 0;
-	s32 bestMatchDistance = 0;
+	s32 amountToAdd = 0;
+	s32 copyAmount = 0;
+	s32 runStart = 0;
+	s32 runEnd = 0;
+
+	char *to = NULL;
+	const char *from = NULL;
 
 
 	/* CODE */
-	FAILURE_POINT;
-	PARANOID_ERR_IF( textToDeflate_F == NULL );
-	PARANOID_ERR_IF( (*textToDeflate_F) == NULL );
-	PARANOID_ERR_IF( text_A == NULL );
-	PARANOID_ERR_IF( (*text_A) != NULL );
+	PARANOID_ERR_IF( inflater == NULL );
+	PARANOID_ERR_IF( amount <= 0 || amount > PINTO_VALUE_SIZE_MAX );
 
-	/* get string length */
-	stringLength = (*textToDeflate_F)->usedSize;
+	window = &inflater->window;
+	source = inflater->source;
 
-	/* get string */
-	pintoTextFreeAndGetString( textToDeflate_F, &string );
+	if ( window->usedSize - window->index >= amount )
+	{
+		goto cleanup;
+	}
 
-	/* create our new text */
-	rc = pintoTextInit( &newText );
-	ERR_IF_PASSTHROUGH;
+	/* drop what's been read, but keep what a reference can copy */
+	keepStart = window->usedSize - PINTO_DEFLATE_WINDOW_SIZE;
+	if ( keepStart > window->index )
+	{
+		keepStart = window->index;
+	}
 
-	/* go through string */
-	i = 0;
-	/* we go until there's only 4 characters left, since we can only deflate
-	   at least 4 characters */
-	while ( i <= (stringLength - 4) )
+	if ( keepStart > 0 )
 	{
-		/* reset our length variables */
-		matchLength = 0;
-		bestMatchLength = 0;
+		memmove( inflater->buffer, inflater->buffer + keepStart, window->usedSize - keepStart );
+		window->usedSize -= keepStart;
+		window->index -= keepStart;
+	}
 
-		/* set matchI */
-		matchI = i - 1;
+	/* keep where we are, so we can be resumed from here */
+	if ( inflater->mark != NULL )
+	{
+		pintoInflaterSaveMark( inflater );
+	}
 
-		/* go up to 64 * 64 characters back, finding the best match */
-		while ( matchI >= 0 && ( i - matchI ) < (64 * 64) )
+	/* fill the window */
+	while ( window->usedSize < inflater->bufferSize )
+	{
+		/* finish copying the current reference */
+		if ( inflater->length > 0 )
 		{
-			/* do at least 4 characters match? */
-			if (    string[ matchI     ] == string[ i     ]
-			     && string[ matchI + 1 ] == string[ i + 1 ]
-			     && string[ matchI + 2 ] == string[ i + 2 ]
-			     && string[ matchI + 3 ] == string[ i + 3 ]
-			   )
+			amountToAdd = inflater->bufferSize - window->usedSize;
+			if ( amountToAdd > inflater->length )
 			{
-				/* see how long the match is */
-				/* we don't need to worry about going past the end of the string, because
-				   before we go past the end of the string we won't match the terminating
-				   '\0' and break out anyway */
-				/* we dont need to worry about matchLength becoming larger than we can
-				   encode, because we only allow PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT
-				   characters in the string, so the max we'll have to encode is
-				   ( PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT ) - 1
-				   which is exactly the max we can encode. (given than the max width
-				   and height is 4096 and we use 4 64 values in encoding) */
-				matchLength = 4;
-				while ( string[ matchI + matchLength ] == string[ i + matchLength ] )
-				{
-					matchLength += 1;
-				}
+				amountToAdd = inflater->length;
+			}
 
-				/* is this our best match? */
-				if ( matchLength > bestMatchLength )
+			to = inflater->buffer + window->usedSize;
+			from = to - inflater->distance;
+
+			window->usedSize += amountToAdd;
+			inflater->length -= amountToAdd;
+
+			/* a reference can overlap what it adds, so we only copy what's
+			   already there. what's between from and to repeats every
+			   distance characters, so each copy can be twice as big as the
+			   last. */
+			while ( amountToAdd > 0 )
+			{
+				copyAmount = to - from;
+				if ( copyAmount > amountToAdd )
 				{
-					bestMatchLength = matchLength;
-					bestMatchDistance = i - matchI;
+					copyAmount = amountToAdd;
 				}
+
+				memcpy( to, from, copyAmount );
+				to += copyAmount;
+				amountToAdd -= copyAmount;
 			}
 
-			/* decrement matchI
-			   try to find match at next spot */
-			matchI -= 1;
+			continue;
 		}
 
-		/*    if no match*/
-		/* or if best match length was 4 and the distance was farther than 64, then
-		      the match is 4 characters and the encoding will be 4 characters, so there
-		      is no point deflating. */
-		if (    bestMatchLength == 0
-		     || ( bestMatchLength == 4 && bestMatchDistance >= 64 )
-		   )
+		/* is there another char to get? */
+		if ( pintoTextAtEnd( source ) )
 		{
-			rc = pintoTextAddChar( newText, string[ i ] );
-			ERR_IF_PASSTHROUGH;
-
-			/* increment i */
-			i += 1;
+			break;
 		}
-		/* there was a match */
-		else
+
+		/* get next char */
+		pintoTextGetChar( source, &ch );
+		/* since we just called pintoTextAtEnd there is guaranteed to be a char to get.
+		   so no need to check for error
+		*/
+
+		/* '?' is used for distances 1-63, and '@' is used for distances
+		   64-4095 */
+		if ( ch == '?' || ch == '@' )
 		{
-			if ( bestMatchDistance < 64 )
-			{
-				rc = pintoTextAddChar( newText, '?' );
-				ERR_IF_PASSTHROUGH;
+			/* get distance */
+			inflater->distance = 0;
 
-				rc = pintoTextAddValue( newText, bestMatchDistance );
-				ERR_IF_PASSTHROUGH;
+			rc = pintoTextUpdateValue( source, &inflater->distance );
+			ERR_IF_PASSTHROUGH;
 
-				rc = pintoTextAddValue( newText, bestMatchLength );
+			if ( ch == '@' )
+			{
+				rc = pintoTextUpdateValue( source, &inflater->distance );
 				ERR_IF_PASSTHROUGH;
 			}
-			else
-			{
-				PARANOID_ERR_IF( bestMatchDistance >= ( 64 * 64 ) );
 
-				rc = pintoTextAddChar( newText, '@' );
-				ERR_IF_PASSTHROUGH;
+			/* get length */
+			rc = pintoTextGetValue( source, &inflater->length );
+			ERR_IF_PASSTHROUGH;
 
-				rc = pintoTextAddChar( newText, valueToChar[ ( (bestMatchDistance) / 64 ) % 64 ] );
-				ERR_IF_PASSTHROUGH;
+			ERR_IF( inflater->distance == 0, PINTO_RC_ERROR_FORMAT_INVALID );
+			ERR_IF( inflater->length == 0, PINTO_RC_ERROR_FORMAT_INVALID );
 
-				rc = pintoTextAddChar( newText, valueToChar[   (bestMatchDistance)        % 64 ] );
-				ERR_IF_PASSTHROUGH;
+			/* make sure distance is not too big */
+			ERR_IF( inflater->distance > inflater->inflatedSize, PINTO_RC_ERROR_FORMAT_INVALID );
 
-				rc = pintoTextAddValue( newText, bestMatchLength );
-				ERR_IF_PASSTHROUGH;
-			}
+			/* No text should ever reach this size, so we put this in to
+			   prevent a small malicious encoding from inflating forever. */
+			ERR_IF( inflater->inflatedSize + inflater->length > ( PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT ), PINTO_RC_ERROR_FORMAT_TOO_LONG );
 
-			/* increment i */
-			i += bestMatchLength;
+			inflater->inflatedSize += inflater->length;
 		}
-	}
+		/* no inflate marker, so add it and all the plain chars after it at
+		   once */
+		else
+		{
+			runStart = source->index - 1;
+			runEnd = source->index;
+
+			while (    runEnd < source->usedSize
+			        && runEnd - runStart < inflater->bufferSize - window->usedSize
+			        && PINTO_CHAR_IS_VALID( source->string[ runEnd ] )
+			        && source->string[ runEnd ] != '?'
+			        && source->string[ runEnd ] != '@'
+			      )
+			{
+				runEnd += 1;
+			}
 
-	/* add rest of string to newText */
-	while ( i < stringLength )
-	{
-		rc = pintoTextAddChar( newText, string[ i ] );
-		ERR_IF_PASSTHROUGH;
+			amountToAdd = runEnd - runStart;
 
-		/* *** */
-		i += 1;
-	}
+			ERR_IF( inflater->inflatedSize + amountToAdd > ( PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT ), PINTO_RC_ERROR_FORMAT_TOO_LONG );
 
-	/* free textToDeflate */
-	pintoTextFree( textToDeflate_F );
+			memcpy( inflater->buffer + window->usedSize, source->string + runStart, amountToAdd );
+			window->usedSize += amountToAdd;
+			inflater->inflatedSize += amountToAdd;
 
-	/* give back */
-	(*text_A) = newText;
-	newText = NULL;
+			source->index = runEnd;
+		}
+	}
 
 
 	/* CLEANUP */
 	cleanup:
 
-	pintoTextFree( &newText );
+	return rc;
+}
 
-	PINTO_HOOK_FREE( string );
-	string = NULL;
+/******************************************************************************/
+/*!
+	\brief Used to see if everything has been inflated and read.
+	\param[in] inflater Inflater, after a call to pintoInflaterFill().
+	\return s32 True if there are no characters left.
+*/
+static s32 pintoInflaterAtEnd( PintoInflater *inflater )
+{
+	/* CODE */
+	PARANOID_ERR_IF( inflater == NULL );
 
-	return rc;
+	return inflater->window.index == inflater->window.usedSize;
 }
 
 /******************************************************************************/
 /*!
-	\brief Uncompresses text with a simple version of deflate (inflate here).
-	\param[in] textToDeflate_F text to be uncompressed. On success, will be freed.
-	\param[out] text_A On success, will be uncompressed text.
-		Will be allocated. The caller is responsible for freeing with
-		pintoTextFree().
-	\return PINTO_RC
+	\brief Gets the position in the inflated text of the next character to be
+	       read.
+	\param[in] inflater Inflater.
+	\return s32 Position.
 */
-PINTO_RC pintoSimpleInflate( PintoText **textToInflate_F, PintoText **text_A )
+static s32 pintoInflaterPosition( const PintoInflater *inflater )
 {
-	/* DATA */
-	PINTO_RC rc = PINTO_RC_SUCCESS;
+	/* CODE */
+	PARANOID_ERR_IF( inflater == NULL );
 
-	PintoText *newText = NULL;
+	/* characters of a reference that haven't been copied yet are already
+	   counted in inflatedSize */
+	return ( inflater->inflatedSize - inflater->length ) - ( inflater->window.usedSize - inflater->window.index );
+}
 
-	char ch = 0;
+/******************************************************************************/
+/*!
+	\brief Saves an inflater's state in its mark.
+	\param[in] inflater Inflater, just before it inflates more.
+	\return void
 
-	s32 distance = 0;
-	s32 length = 0;
+	Only the characters a reference can still copy are kept, which are
+	always enough, since this is only done when there are fewer than
+	PINTO_VALUE_SIZE_MAX characters left to read.
+*/
+static void pintoInflaterSaveMark( PintoInflater *inflater )
+{
+	/* DATA */
+	PintoText *window = NULL;
+	PintoInflaterMark *mark = NULL;
 
 
 	/* CODE */
-	FAILURE_POINT;
-	PARANOID_ERR_IF( textToInflate_F == NULL );
-	PARANOID_ERR_IF( (*textToInflate_F) == NULL );
-	PARANOID_ERR_IF( text_A == NULL );
-	PARANOID_ERR_IF( (*text_A) != NULL );
+	PARANOID_ERR_IF( inflater == NULL );
+	PARANOID_ERR_IF( inflater->mark == NULL );
 
-	/* create our new text */
-	rc = pintoTextInit( &newText );
-	ERR_IF_PASSTHROUGH;
+	window = &inflater->window;
+	mark = inflater->mark;
 
-	/* go through string, inflating */
-	while ( 1 )
+	mark->historySize = window->usedSize;
+	if ( mark->historySize > PINTO_DEFLATE_WINDOW_SIZE )
 	{
-		/* is there another char to get? */
-		if ( pintoTextAtEnd( (*textToInflate_F) ) )
-		{
-			break;
-		}
+		mark->historySize = PINTO_DEFLATE_WINDOW_SIZE;
+	}
 
-		/* get next char */
-		pintoTextGetChar( (*textToInflate_F), &ch );
-		/* since we just called pintoTextAtEnd there is guaranteed to be a char to get.
-		   so no need to check for error
-		*/
+	memcpy( mark->history, window->string + window->usedSize - mark->historySize, mark->historySize );
 
-		/* '?' is used for distances 1-63 */
-		if ( ch == '?' )
-		{
-			/* get distance */
-			distance = 0;
+	mark->unreadSize = window->usedSize - window->index;
+	PARANOID_ERR_IF( mark->unreadSize > mark->historySize );
 
-			rc = pintoTextUpdateValue( (*textToInflate_F), &distance );
-			ERR_IF_PASSTHROUGH;
+	mark->sourceIndex = inflater->source->index;
+	mark->distance = inflater->distance;
+	mark->length = inflater->length;
+	mark->inflatedSize = inflater->inflatedSize;
+	mark->position = pintoInflaterPosition( inflater );
 
-			/* get length */
-			rc = pintoTextGetValue( (*textToInflate_F), &length );
-			ERR_IF_PASSTHROUGH;
+	return;
+}
 
-			/* inflate */
-			rc = pintoTextInflateHelper( newText, distance, length );
-			ERR_IF_PASSTHROUGH;
-		}
-		/* '@' is used for distances 64-4095 */
-		else if ( ch == '@' )
-		{
-			/* get distance */
-			distance = 0;
+/******************************************************************************/
+/*!
+	\brief Resumes an inflater from a mark another inflater saved, and
+	       inflates up to a position.
+	\param[in] inflater Inflater that nothing's been read from yet, over its
+		own copy of the source.
+	\param[in] mark Mark, from before position.
+	\param[in] position Position in the inflated text to read from next.
+	\return PINTO_RC
+*/
+static PINTO_RC pintoInflaterResume( PintoInflater *inflater, const PintoInflaterMark *mark, s32 position )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
 
-			rc = pintoTextUpdateValue( (*textToInflate_F), &distance );
-			ERR_IF_PASSTHROUGH;
-			rc = pintoTextUpdateValue( (*textToInflate_F), &distance );
-			ERR_IF_PASSTHROUGH;
+	PintoText *window = NULL;
 
-			/* get length */
-			rc = pintoTextGetValue( (*textToInflate_F), &length );
-			ERR_IF_PASSTHROUGH;
+	s32 skip = 0;
+	s32 amount = 0;
 
-			/* inflate */
-			rc = pintoTextInflateHelper( newText, distance, length );
-			ERR_IF_PASSTHROUGH;
-		}
-		/* no inflate marker, just add char */
-		else
+
+	/* CODE */
+	PARANOID_ERR_IF( inflater == NULL );
+	PARANOID_ERR_IF( mark == NULL );
+	PARANOID_ERR_IF( inflater->bufferSize <= PINTO_DEFLATE_WINDOW_SIZE );
+	PARANOID_ERR_IF( position < mark->position );
+
+	window = &inflater->window;
+
+	memcpy( inflater->buffer, mark->history, mark->historySize );
+	window->usedSize = mark->historySize;
+	window->index = mark->historySize - mark->unreadSize;
+
+	inflater->source->index = mark->sourceIndex;
+	inflater->distance = mark->distance;
+	inflater->length = mark->length;
+	inflater->inflatedSize = mark->inflatedSize;
+
+	/* inflate and skip what's before position */
+	skip = position - mark->position;
+
+	while ( skip > 0 )
+	{
+		rc = pintoInflaterFill( inflater, 1 );
+		ERR_IF_PASSTHROUGH;
+
+		amount = window->usedSize - window->index;
+		ERR_IF( amount == 0, PINTO_RC_ERROR_FORMAT_INVALID );
+
+		if ( amount > skip )
 		{
-			rc = pintoTextAddChar( newText, ch );
-			ERR_IF_PASSTHROUGH;
+			amount = skip;
 		}
-	}
 
-	pintoTextFree( textToInflate_F );
-
-	/* give back */
-	(*text_A) = newText;
-	newText = NULL;
+		window->index += amount;
+		skip -= amount;
+	}
 
 
 	/* CLEANUP */
 	cleanup:
 
-	pintoTextFree( &newText );
-
 	return rc;
 }
 
@@ -1173,7 +5452,9 @@ const char *pintoRCToString( PINTO_RC rc )
 		"Image Partial Transparency Error",
 		"Image Too Small Error",
 		"Format Invalid Error",
-		"Format Too Long Error"
+		"Format Too Long Error",
+		"Buffer Too Small Error",
+		"Write Failed Error"
 	};
 
 	static const char *rcUnknown = "Unknown Error";
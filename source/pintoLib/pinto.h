@@ -31,6 +31,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef pinto_H
 #define pinto_H
 
+/******************************************************************************/
+#include <stddef.h> /* for size_t */
+
 /******************************************************************************/
 #define PINTO_NAME "Pinto"
 
@@ -78,10 +81,12 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define PINTO_RC_ERROR_IMAGE_TOO_SMALL            1004
 #define PINTO_RC_ERROR_FORMAT_INVALID             1005
 #define PINTO_RC_ERROR_FORMAT_TOO_LONG            1006
+#define PINTO_RC_ERROR_BUFFER_TOO_SMALL           1007
+#define PINTO_RC_ERROR_WRITE_FAILED               1008
 
 /* These must be kept in sync with the above defines */
 #define PINTO_RC_PINTO_ERRORS_MIN                 1001
-#define PINTO_RC_PINTO_ERRORS_MAX                 1006
+#define PINTO_RC_PINTO_ERRORS_MAX                 1008
 
 
 /******************************************************************************/
@@ -102,19 +107,168 @@ typedef struct
 	s32 width;
 	/*! Height */
 	s32 height;
-	/*! Red, Green, Blue, and Alpha data. Size is (width * height * 4) */
+	/*! Red, Green, Blue, and Alpha data. Size is (width * height * 4). If
+	    Pinto is built with PINTO_RGBA_ALIGNMENT defined, it's aligned to that
+	    many bytes, and isn't the start of what was allocated, so it must only
+	    be released with pintoImageFree(), and never freed or replaced by the
+	    caller. */
 	u8 *rgba;
 } PintoImage;
 
+/* Pixel formats of an image view */
+/*! 4 bytes per pixel: red, green, blue, alpha */
+#define PINTO_FORMAT_RGBA 0
+/*! 4 bytes per pixel: blue, green, red, alpha */
+#define PINTO_FORMAT_BGRA 1
+/*! 4 bytes per pixel: alpha, red, green, blue */
+#define PINTO_FORMAT_ARGB 2
+/*! 3 bytes per pixel: red, green, blue. Pixels that are the color key are
+    transparent. */
+#define PINTO_FORMAT_RGB  3
+/*! 1 byte per pixel: gray. Pixels darker than the threshold are
+    transparent. */
+#define PINTO_FORMAT_GRAY 4
+
+/*! View of pixels that are owned by someone else, like part of a larger
+    framebuffer. Nothing is copied when it's encoded. */
+typedef struct
+{
+	/*! Width */
+	s32 width;
+	/*! Height */
+	s32 height;
+	/*! One of the PINTO_FORMAT_* values */
+	s32 format;
+	/*! First pixel of the first row */
+	const u8 *pixels;
+	/*! Bytes from the start of one row to the start of the next. Can be
+	    negative for images that are stored bottom row first. 0 means rows
+	    are right after each other. */
+	s32 stride;
+	/*! For PINTO_FORMAT_RGB, the color that's transparent, as 0xRRGGBB, or -1
+	    for none. */
+	s32 colorKey;
+	/*! For PINTO_FORMAT_GRAY, pixels less than this are transparent. 0 for
+	    none. */
+	s32 threshold;
+} PintoImageView;
+
+/*! Image structure that holds a palette index for each pixel */
+typedef struct
+{
+	/*! Width */
+	s32 width;
+	/*! Height */
+	s32 height;
+	/*! Amount of colors in the palette, from 0 to 256. 0 means every pixel
+	    is transparent. */
+	s32 colorAmount;
+	/*! Red, Green, and Blue of each color. Size is (colorAmount * 3). Can be
+	    NULL if colorAmount is 0. */
+	u8 *palette;
+	/*! Palette index of each pixel. Size is (width * height) */
+	u8 *indexes;
+	/*! Index that means a pixel is fully transparent, or -1 if there isn't
+	    one. Doesn't need to be in the palette. */
+	s32 transparentIndex;
+} PintoIndexedImage;
+
+/*! Index of fully transparent pixels in a PintoIndexedImage from
+    pintoIndexedImageDecode() */
+#define PINTO_INDEX_TRANSPARENT 0xFF
+
+/*! What pintoImageGetInfo() reads from an encoding's header */
+typedef struct
+{
+	/*! Width */
+	s32 width;
+	/*! Height */
+	s32 height;
+	/*! Amount of colors in the palette, from 0 to PINTO_MAX_COLORS */
+	s32 colorAmount;
+	/*! Red, Green, and Blue of each color, in the order they're painted */
+	u8 palette[ PINTO_MAX_COLORS * 3 ];
+} PintoImageInfo;
+
 typedef struct PintoText_STRUCT PintoText;
 
+/******************************************************************************/
+/* Encoding levels */
+/*! Don't deflate. Fastest to encode, but the biggest. */
+#define PINTO_LEVEL_NONE    0
+/*! Deflate, but only look at a few of the closest matches */
+#define PINTO_LEVEL_FAST    1
+/*! Deflate by always taking the longest match */
+#define PINTO_LEVEL_DEFAULT 2
+/*! Deflate by finding the smallest possible encoding. Slower to encode, but
+    decodes just as fast. */
+#define PINTO_LEVEL_MAX     3
+
+/*! Most threads an encode can use */
+#define PINTO_MAX_THREADS 64
+
+/*! Encoding options */
+typedef struct
+{
+	/*! One of the PINTO_LEVEL_* values. */
+	s32 level;
+	/*! Amount of threads to use, from 1 to PINTO_MAX_THREADS. The encoding is
+	    the same for any amount. Only used if Pinto is built with
+	    PINTO_ENABLE_THREADS, otherwise everything runs on the calling
+	    thread. */
+	s32 threadCount;
+	/*! If not 0, colors are painted in an order picked to need fewer runs,
+	    instead of in order of first appearance. This usually makes the
+	    encoding smaller, but takes longer. */
+	s32 reorderColors;
+} PintoEncodeOptions;
+
+typedef struct PintoEncoder_STRUCT PintoEncoder;
+
+/*! Function that's given an encoding a piece at a time, as it's made.
+    Returns 0 on success. Anything else stops the encoding with
+    PINTO_RC_ERROR_WRITE_FAILED. */
+typedef s32 (*PintoWriteFunc)( void *userData, const char *data, s32 size );
+
 /******************************************************************************/
 /* pinto.c */
 PINTO_RC pintoImageEncode( const PintoImage *image, char **string_A );
+PINTO_RC pintoImageEncodeEx( const PintoImage *image, const PintoEncodeOptions *options, char **string_A );
+void pintoEncodeOptionsInit( PintoEncodeOptions *options );
+
+PINTO_RC pintoEncoderInit( PintoEncoder **encoder_A );
+void pintoEncoderFree( PintoEncoder **encoder_F );
+PINTO_RC pintoEncoderEncode( PintoEncoder *encoder, const PintoImage *image, const PintoEncodeOptions *options, const char **string );
+
+PINTO_RC pintoEncoderBegin( PintoEncoder *encoder, s32 width, s32 height, const PintoEncodeOptions *options );
+PINTO_RC pintoEncoderAddRows( PintoEncoder *encoder, const u8 *rgba, s32 rowAmount );
+PINTO_RC pintoEncoderFinish( PintoEncoder *encoder, const char **string );
+PINTO_RC pintoEncoderFinishToSink( PintoEncoder *encoder, PintoWriteFunc writeFunc, void *userData );
+
+PINTO_RC pintoImageEncodedSize( const PintoImage *image, s32 *size );
+PINTO_RC pintoImageEncodeInto( const PintoImage *image, const PintoEncodeOptions *options, char *buffer, s32 bufferSize, s32 *usedSize );
+PINTO_RC pintoEncoderEncodeInto( PintoEncoder *encoder, const PintoImage *image, const PintoEncodeOptions *options, char *buffer, s32 bufferSize, s32 *usedSize );
+
+PINTO_RC pintoImageEncodeToSink( const PintoImage *image, const PintoEncodeOptions *options, PintoWriteFunc writeFunc, void *userData );
+PINTO_RC pintoEncoderEncodeToSink( PintoEncoder *encoder, const PintoImage *image, const PintoEncodeOptions *options, PintoWriteFunc writeFunc, void *userData );
+s32 pintoFileWrite( void *file, const char *data, s32 size );
+
+void pintoImageViewInit( PintoImageView *view, s32 width, s32 height, s32 format, const u8 *pixels );
+PINTO_RC pintoImageViewEncode( const PintoImageView *view, const PintoEncodeOptions *options, char **string_A );
+PINTO_RC pintoEncoderEncodeView( PintoEncoder *encoder, const PintoImageView *view, const PintoEncodeOptions *options, const char **string );
+
+PINTO_RC pintoIndexedImageEncode( const PintoIndexedImage *image, const PintoEncodeOptions *options, char **string_A );
 
 PINTO_RC pintoImageDecodeString( const char *string, PintoImage **image_A );
+PINTO_RC pintoImageDecodeBuffer( const char *data, size_t length, PintoImage **image_A );
+PINTO_RC pintoImageDecodeInto( const char *data, size_t length, u8 *rgba, s32 rgbaSize, s32 offset, s32 stride, s32 *width, s32 *height );
 PINTO_RC pintoImageDecodeText( PintoText **text_F, PintoImage **image_A );
 
+PINTO_RC pintoIndexedImageDecode( const char *data, size_t length, PintoIndexedImage **image_A );
+void pintoIndexedImageFree( PintoIndexedImage **image_F );
+
+PINTO_RC pintoImageGetInfo( const char *data, size_t length, PintoImageInfo *info );
+
 PINTO_RC pintoImageInit( s32 width, s32 height, PintoImage **image_A );
 void pintoImageFree( PintoImage **image_F );
 
@@ -128,6 +282,7 @@ PINTO_RC pintoTextInit( PintoText **text_A );
 void pintoTextFree( PintoText **text_F );
 
 PINTO_RC pintoTextAddChar( PintoText *text, char ch );
+PINTO_RC pintoTextAddBuffer( PintoText *text, const char *buffer, s32 length, s32 *strayIndex );
 
 /******************************************************************************/
 #endif
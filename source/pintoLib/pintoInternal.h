@@ -34,9 +34,16 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /******************************************************************************/
 #include <stdio.h> /* for printf, fprintf, fflush */
 #include <stdlib.h> /* for NULL */
+#include <string.h> /* for memcpy */
 
 #include "pinto.h"
 
+/******************************************************************************/
+/* This defines u32 as an unsigned 32-bit integer */
+#ifndef u32
+#define u32 unsigned int
+#endif
+
 /******************************************************************************/
 #define ERR_IF( cond, error_to_return ) \
 	if ( (cond) ) \
@@ -113,6 +120,18 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define PINTO_6_BITS_TO_8_BITS( x ) ( ( (x) << 2   ) | ( (x) >> 4 ) )
 
+/******************************************************************************/
+/* If not 0, PintoImage.rgba is aligned to this many bytes, which must be a
+   power of 2. Build with -DPINTO_RGBA_ALIGNMENT=32 to keep AVX2 stores aligned
+   when decoding. */
+#ifndef PINTO_RGBA_ALIGNMENT
+#define PINTO_RGBA_ALIGNMENT 0
+#endif
+
+#if PINTO_RGBA_ALIGNMENT < 0 || ( PINTO_RGBA_ALIGNMENT & ( PINTO_RGBA_ALIGNMENT - 1 ) )
+#error PINTO_RGBA_ALIGNMENT must be 0 or a power of 2
+#endif
+
 /******************************************************************************/
 extern s32 PINTO_TEXT_SIZE_GROWTH;
 
@@ -129,25 +148,303 @@ struct PintoText_STRUCT
 	s32 usedSize;
 	/*! Index in string where we will read next */
 	s32 index;
+	/*! If not NULL, the string is given to this and emptied whenever it's
+	    full, instead of growing. See pintoTextSetSink(). */
+	PintoWriteFunc writeFunc;
+	/*! Passed to writeFunc. */
+	void *userData;
+	/*! How many characters have been given to writeFunc. For a text over a
+	    fixed buffer, how many didn't fit. */
+	s32 writtenSize;
+	/*! If not 0, string is a buffer that belongs to someone else, and can't
+	    grow. See pintoTextInitBuffer(). */
+	s32 fixed;
 };
 
 /******************************************************************************/
+/*! True if a character is used in encoding. Other characters are skipped, so
+    encodings can be word wrapped, or have spaces or tabs. */
+#define PINTO_CHAR_IS_VALID( ch ) \
+	( (ch) >= '#' && (ch) <= 'z' && (ch) != '[' && (ch) != '\\' && (ch) != ']' && (ch) != '_' && (ch) != '`' )
+
+/*! Whether a character is whitespace, which is skipped in a text like any
+    other character that isn't valid, but is expected there */
+#define PINTO_CHAR_IS_SPACE( ch ) \
+	( (ch) == ' ' || (ch) == '\t' || (ch) == '\n' || (ch) == '\r' || (ch) == '\v' || (ch) == '\f' )
+
+/******************************************************************************/
+/*! Size of the buffer of a text that gives its characters to a sink */
+#define PINTO_TEXT_SINK_SIZE 4096
+
+/******************************************************************************/
+/* Deflate can reference characters up to ( 64 * 64 ) - 1 characters back */
+#define PINTO_DEFLATE_WINDOW_SIZE ( 64 * 64 )
+
+/* Walking this many positions down a hash chain will visit every position in
+   the window, so deflating with this chain depth gives the exact same result
+   as comparing against every position in the window. */
+#define PINTO_DEFLATE_CHAIN_DEPTH_MAX PINTO_DEFLATE_WINDOW_SIZE
+
+/* Chain depth used when deflating with PINTO_LEVEL_FAST */
+#define PINTO_DEFLATE_CHAIN_DEPTH_FAST 8
+
+/* Must be a power of 2 */
+#define PINTO_DEFLATE_HASH_SIZE 4096
+
+/* When deflating with PINTO_LEVEL_MAX, this many positions are parsed at a
+   time to find the smallest encoding for them */
+#define PINTO_DEFLATE_OPTIMAL_WINDOW 4096
+
+/* When deflating with PINTO_LEVEL_MAX, a match this long is always taken,
+   without looking at shorter matches */
+#define PINTO_DEFLATE_NICE_LENGTH 256
+
+/*! Hash chain match finder used when deflating */
+typedef struct
+{
+	/*! String we're finding matches in. */
+	const char *string;
+	/*! Length of string. */
+	s32 stringLength;
+	/*! Maximum amount of positions to compare against when finding a match. */
+	s32 chainDepth;
+	/*! Most recently inserted position for each hash, or -1 if none. */
+	s32 head[ PINTO_DEFLATE_HASH_SIZE ];
+	/*! The previously inserted position with the same hash. Indexed by
+	    ( position % PINTO_DEFLATE_WINDOW_SIZE ). */
+	s32 prev[ PINTO_DEFLATE_WINDOW_SIZE ];
+} PintoMatchFinder;
+
+/*! Work space used when deflating with PINTO_LEVEL_MAX */
+typedef struct
+{
+	/*! Smallest amount of characters needed to encode up to each position in
+	    the current window. */
+	s32 price[ PINTO_DEFLATE_OPTIMAL_WINDOW + PINTO_DEFLATE_NICE_LENGTH ];
+	/*! Length of the last literal (1) or match used to reach each position. */
+	s32 length[ PINTO_DEFLATE_OPTIMAL_WINDOW + PINTO_DEFLATE_NICE_LENGTH ];
+	/*! Distance of the last match used to reach each position. */
+	s32 distance[ PINTO_DEFLATE_OPTIMAL_WINDOW + PINTO_DEFLATE_NICE_LENGTH ];
+	/*! Matches found at the current position. */
+	s32 matchLengths[ PINTO_DEFLATE_CHAIN_DEPTH_MAX ];
+	s32 matchDistances[ PINTO_DEFLATE_CHAIN_DEPTH_MAX ];
+} PintoOptimalParser;
+
+/******************************************************************************/
+/* Amount of inflated characters an inflater holds at a time. Must be more than
+   PINTO_DEFLATE_WINDOW_SIZE, so there's room left after the characters that
+   can still be referenced. */
+#define PINTO_INFLATE_WINDOW_SIZE ( 64 * 1024 )
+
+/* Most characters a value can be encoded with. See pintoTextAddValue(). */
+#define PINTO_VALUE_SIZE_MAX 5
+
+/* Most characters a header can take: 'a', width, height, amount of colors,
+   and 3 characters for each color */
+#define PINTO_HEADER_SIZE_MAX ( 1 + ( PINTO_VALUE_SIZE_MAX * 3 ) + ( PINTO_MAX_COLORS * 3 ) )
+
+/*! An inflater's state, from which it can be resumed. See
+    pintoInflaterResume(). */
+typedef struct
+{
+	/*! The last inflated characters, which references can still copy. The
+	    ones not read yet are at the end. */
+	char history[ PINTO_DEFLATE_WINDOW_SIZE ];
+	/*! Amount of characters in history. */
+	s32 historySize;
+	/*! Amount of characters at the end of history that haven't been read. */
+	s32 unreadSize;
+	/*! Index of the source's next character. */
+	s32 sourceIndex;
+	/*! Inflater's distance, length, and inflatedSize. */
+	s32 distance;
+	s32 length;
+	s32 inflatedSize;
+	/*! Position in the inflated text of the first character not read. */
+	s32 position;
+} PintoInflaterMark;
+
+/*! Inflates a text a piece at a time, so the whole inflated text doesn't need
+    to be held */
+typedef struct
+{
+	/*! Deflated text we're inflating, read from its index on. */
+	PintoText *source;
+	/*! Inflated characters. Read these with the pintoText functions, after
+	    calling pintoInflaterFill(). Its string is buffer. */
+	PintoText window;
+	/*! Holds the last inflated characters. */
+	char *buffer;
+	/*! Size of buffer. If it's PINTO_DEFLATE_WINDOW_SIZE or less, only this
+	    many characters can ever be inflated. */
+	s32 bufferSize;
+	/*! Distance of the reference we're copying. */
+	s32 distance;
+	/*! Amount of characters still to copy from the reference. */
+	s32 length;
+	/*! Amount of characters inflated so far. */
+	s32 inflatedSize;
+	/*! If not NULL, the inflater's state is saved here each time it inflates
+	    more, so it can later be resumed from anywhere after that. */
+	PintoInflaterMark *mark;
+} PintoInflater;
+
+/* Amount of inflated characters each color's inflater holds while painting.
+   Must be more than PINTO_DEFLATE_WINDOW_SIZE. */
+#define PINTO_INFLATE_RESUME_SIZE ( PINTO_DEFLATE_WINDOW_SIZE * 4 )
+
+/******************************************************************************/
+/* Runs of fewer pixels than this are painted one pixel at a time, instead of
+   with pintoPixelsFill() */
+#define PINTO_FILL_SHORT 8
+
+/******************************************************************************/
+/* What pintoDecode() decodes into */
+/*! A new PintoImage */
+#define PINTO_DECODE_IMAGE         0
+/*! A new PintoIndexedImage */
+#define PINTO_DECODE_INDEXED_IMAGE 1
+/*! RGBA memory owned by the caller */
+#define PINTO_DECODE_RGBA          2
+
+/*! Where pintoDecode() paints */
+typedef struct
+{
+	/*! One of the PINTO_DECODE_* values. */
+	s32 mode;
+	/*! First pixel of the first row. For PINTO_DECODE_RGBA, set by the
+	    caller, otherwise set to the new image's pixels. */
+	u8 *pixels;
+	/*! For PINTO_DECODE_RGBA, size of pixels, in bytes. */
+	s32 pixelsSize;
+	/*! Bytes from the start of one row to the next. For PINTO_DECODE_RGBA, 0
+	    means rows are right after each other. */
+	s32 stride;
+	/*! Image's width and height, set once they're known. */
+	s32 width;
+	s32 height;
+	/*! For PINTO_DECODE_IMAGE, the new image. */
+	PintoImage *image;
+	/*! For PINTO_DECODE_INDEXED_IMAGE, the new image. */
+	PintoIndexedImage *indexedImage;
+} PintoDecodeTarget;
+
+/******************************************************************************/
+/*! Amount of slots in a palette's hash table. Must be a power of 2, and more
+    than PINTO_MAX_COLORS so there's always an empty slot. */
+#define PINTO_PALETTE_HASH_SIZE 128
+
+/*! Packs a pixel's red, green, and blue into an 18-bit key, 6 bits each. */
+#define PINTO_PALETTE_KEY( red, green, blue ) ( ( ( (s32)(red) >> 2 ) << 12 ) | ( ( (s32)(green) >> 2 ) << 6 ) | ( (s32)(blue) >> 2 ) )
+
+/*! The palette of an image being encoded */
+typedef struct
+{
+	/*! Red, green, and blue of each color, already reduced to 6 bits with
+	    PINTO_8_BITS_TO_6_BITS. */
+	u8 colors[ PINTO_MAX_COLORS * 3 ];
+	/*! Amount of colors. */
+	s32 colorAmount;
+	/*! Key of the color in each slot, or -1 if the slot is empty. */
+	s32 keys[ PINTO_PALETTE_HASH_SIZE ];
+	/*! Index of the color in each slot. */
+	char indexes[ PINTO_PALETTE_HASH_SIZE ];
+} PintoPalette;
+
+/*! How many pixels are converted to keys at a time when encoding */
+#define PINTO_KEY_BLOCK_SIZE 1024
+
+/*! Marks an index of a PintoIndexedImage that hasn't been seen yet */
+#define PINTO_INDEX_NOT_SEEN ( (char) -2 )
+
+/******************************************************************************/
+/*! Encoder, which keeps its buffers between encodes */
+struct PintoEncoder_STRUCT
+{
+	/*! Palette index of each pixel, or -1 for transparent. */
+	char *indexedData;
+	/*! How many pixels indexedData has room for. */
+	s32 indexedDataSize;
+	/*! Scratch space for reordering colors. Same size as indexedData, or NULL
+	    if colors haven't been reordered yet. */
+	char *sequence;
+	/*! Palette of the image being encoded. */
+	PintoPalette palette;
+	/*! Header and RLE data. */
+	PintoText *text;
+	/*! RLE data for each color. */
+	PintoText *colorTexts[ PINTO_MAX_COLORS ];
+	/*! Deflated text. */
+	PintoText *deflatedText;
+	/*! Greedily deflated text, for PINTO_LEVEL_MAX. */
+	PintoText *greedyText;
+	/*! Text that gives the encoding to a sink, a piece at a time. */
+	PintoText *sinkText;
+	/*! Match finder for deflating. */
+	PintoMatchFinder *finder;
+	/*! Optimal parser, for PINTO_LEVEL_MAX. */
+	PintoOptimalParser *parser;
+	/*! Options of the image being encoded a row at a time. */
+	PintoEncodeOptions rowOptions;
+	/*! Width of the image being encoded a row at a time. */
+	s32 rowWidth;
+	/*! Height of the image being encoded a row at a time, or 0 if there
+	    isn't one. */
+	s32 rowHeight;
+	/*! How many rows have been added so far. */
+	s32 rowsAdded;
+};
+
+/******************************************************************************/
+/*! A function that does one job. See pintoThreadsRun(). */
+typedef void (*PintoJobFunc)( void *job );
+
+/******************************************************************************/
+PINTO_RC pintoTextAddChars( PintoText *text, const char *chars, s32 amount );
+PINTO_RC pintoTextAddText( PintoText *text, const PintoText *textToAdd );
+void pintoTextInitView( PintoText *text, const char *data, s32 length );
+void pintoTextInitBuffer( PintoText *text, char *buffer, s32 size );
+void pintoTextReset( PintoText *text );
+PINTO_RC pintoTextInitSink( PintoText **text_A );
+PINTO_RC pintoTextInitSize( PintoText **text_A, s32 size );
+void pintoTextSetSink( PintoText *text, PintoWriteFunc writeFunc, void *userData );
+PINTO_RC pintoTextFlush( PintoText *text );
+
 s32 pintoTextAtEnd( PintoText *text );
 PINTO_RC pintoTextPeekChar( PintoText *text, char *ch );
 PINTO_RC pintoTextGetChar( PintoText *text, char *ch );
 
 PINTO_RC pintoTextAddValue( PintoText *text, s32 value );
+s32 pintoTextValueSize( s32 value );
 
 PINTO_RC pintoTextGetValue( PintoText *text, s32 *value );
 PINTO_RC pintoTextUpdateValue( PintoText *text, s32 *value );
 
-PINTO_RC pintoTextInflateHelper( PintoText *text, s32 distance, s32 length );
-
 void pintoTextFreeAndGetString( PintoText **text_F, char **string_A );
 
 PINTO_RC pintoSimpleDeflate( PintoText **textToDeflate_F, PintoText **text_A );
+PINTO_RC pintoSimpleDeflateDepth( PintoText **textToDeflate_F, s32 chainDepth, PintoText **text_A );
+PINTO_RC pintoSimpleDeflateParallel( PintoText **textToDeflate_F, s32 chainDepth, s32 threadCount, PintoText **text_A );
+PINTO_RC pintoSimpleDeflateOptimal( PintoText **textToDeflate_F, PintoText **text_A );
 PINTO_RC pintoSimpleInflate( PintoText **textToInflate_F, PintoText **text_A );
 
+void pintoThreadsRun( PintoJobFunc func, void *jobs, size_t jobSize, s32 jobAmount );
+
+s32 pintoPixelsToKeys( const u8 *rgba, s32 pixelAmount, s32 *keys );
+s32 pintoViewPixelsToKeys( const PintoImageView *view, const u8 *pixels, s32 pixelAmount, s32 *keys );
+s32 pintoFormatPixelSize( s32 format );
+void pintoPixelsFill( u8 *pixels, s32 pixelAmount, const u8 *value );
+
+void pintoPaletteInit( PintoPalette *palette );
+PINTO_RC pintoPaletteGetIndex( PintoPalette *palette, s32 key, s32 *index );
+
+PINTO_RC pintoRleEncodeColors( const char *indexedData, s32 pixelAmount, s32 colorStart, s32 colorEnd, PintoText **colorTexts );
+
+void pintoMatchFinderReset( PintoMatchFinder *finder, const char *string, s32 stringLength, s32 chainDepth );
+void pintoMatchFinderInsert( PintoMatchFinder *finder, s32 position );
+void pintoMatchFinderFind( PintoMatchFinder *finder, s32 position, s32 *length, s32 *distance );
+void pintoMatchFinderFindAll( PintoMatchFinder *finder, s32 position, s32 maxLength, s32 *lengths, s32 *distances, s32 *amount );
+
 /******************************************************************************/
 #ifdef PINTO_DEBUG
 
@@ -0,0 +1,556 @@
+/*
+Copyright (C) 2012-2014 Jeremiah Martell
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    - Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    - Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+    - Neither the name of Jeremiah Martell nor the name of GeekHorse nor the
+      name of Pinto nor the names of its contributors may be used to endorse
+      or promote products derived from this software without specific prior
+      written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/******************************************************************************/
+/*!
+	\file
+	Converting pixels to palette keys, and filling pixels with a color.
+*/
+#undef PINTO_FILE_NUMBER
+#define PINTO_FILE_NUMBER 3
+
+/******************************************************************************/
+#include "pinto.h"
+#include "pintoInternal.h"
+
+#if defined( __AVX2__ )
+	#include <immintrin.h>
+	#define PINTO_SIMD_SIZE 32
+#elif defined( __SSE2__ )
+	#include <emmintrin.h>
+	#define PINTO_SIMD_SIZE 16
+#endif
+
+/******************************************************************************/
+static s32 pintoPixelsToKeysOrdered( const u8 *pixels, s32 pixelAmount, s32 redByte, s32 greenByte, s32 blueByte, s32 alphaByte, s32 *keys );
+static s32 pintoPixelsToKeysScalar( const u8 *pixels, s32 pixelAmount, s32 redByte, s32 greenByte, s32 blueByte, s32 alphaByte, s32 *keys );
+static s32 pintoRgbToKeys( const u8 *pixels, s32 pixelAmount, s32 colorKey, s32 *keys );
+static s32 pintoGrayToKeys( const u8 *pixels, s32 pixelAmount, s32 threshold, s32 *keys );
+
+/******************************************************************************/
+/*!
+	\brief Converts RGBA pixels to palette keys.
+	\param[in] rgba Pixels, 4 bytes each.
+	\param[in] pixelAmount Amount of pixels.
+	\param[out] keys Key of each pixel, see PINTO_PALETTE_KEY, or -1 if the
+		pixel is fully transparent.
+	\return s32 Amount of pixels converted. If this is less than pixelAmount,
+		the next pixel is partially transparent.
+
+	This reads every byte of the image, so it's done 8 pixels at a time with
+	AVX2, or 4 pixels at a time with SSE2, if the compiler has them enabled.
+*/
+s32 pintoPixelsToKeys( const u8 *rgba, s32 pixelAmount, s32 *keys )
+{
+	/* DATA */
+	s32 pixel = 0;
+
+#if defined( __AVX2__ )
+	__m256i pixels;
+	__m256i alpha;
+	__m256i transparent;
+	__m256i opaque;
+	__m256i key;
+
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i full = _mm256_set1_epi32( 255 );
+	const __m256i redMask = _mm256_set1_epi32( 0x000000FC );
+	const __m256i greenMask = _mm256_set1_epi32( 0x0000FC00 );
+	const __m256i blueMask = _mm256_set1_epi32( 0x00FC0000 );
+#elif defined( __SSE2__ )
+	__m128i pixels;
+	__m128i alpha;
+	__m128i transparent;
+	__m128i opaque;
+	__m128i key;
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi32( 255 );
+	const __m128i redMask = _mm_set1_epi32( 0x000000FC );
+	const __m128i greenMask = _mm_set1_epi32( 0x0000FC00 );
+	const __m128i blueMask = _mm_set1_epi32( 0x00FC0000 );
+#endif
+
+
+	/* CODE */
+	PARANOID_ERR_IF( rgba == NULL );
+	PARANOID_ERR_IF( pixelAmount < 0 );
+	PARANOID_ERR_IF( keys == NULL );
+
+	/* Each pixel is loaded as a little endian 32-bit value, so red is in the
+	   lowest byte and alpha in the highest. The key is then:
+	   ( red & 0xFC ) << 10 | ( green & 0xFC ) << 4 | ( blue & 0xFC ) >> 2
+	   and transparent pixels are or'd with all 1s to make them -1. */
+
+#if defined( __AVX2__ )
+	while ( pixel + 8 <= pixelAmount )
+	{
+		pixels = _mm256_loadu_si256( (const __m256i *)( rgba + ( pixel * 4 ) ) );
+
+		alpha = _mm256_srli_epi32( pixels, 24 );
+		transparent = _mm256_cmpeq_epi32( alpha, zero );
+		opaque = _mm256_cmpeq_epi32( alpha, full );
+
+		/* partially transparent pixel? let the scalar version find it */
+		if ( _mm256_movemask_epi8( _mm256_or_si256( transparent, opaque ) ) != -1 )
+		{
+			break;
+		}
+
+		key = _mm256_or_si256(
+			_mm256_or_si256(
+				_mm256_slli_epi32( _mm256_and_si256( pixels, redMask ), 10 ),
+				_mm256_srli_epi32( _mm256_and_si256( pixels, greenMask ), 4 ) ),
+			_mm256_srli_epi32( _mm256_and_si256( pixels, blueMask ), 18 ) );
+		key = _mm256_or_si256( key, transparent );
+
+		_mm256_storeu_si256( (__m256i *)( keys + pixel ), key );
+
+		pixel += 8;
+	}
+#elif defined( __SSE2__ )
+	while ( pixel + 4 <= pixelAmount )
+	{
+		pixels = _mm_loadu_si128( (const __m128i *)( rgba + ( pixel * 4 ) ) );
+
+		alpha = _mm_srli_epi32( pixels, 24 );
+		transparent = _mm_cmpeq_epi32( alpha, zero );
+		opaque = _mm_cmpeq_epi32( alpha, full );
+
+		/* partially transparent pixel? let the scalar version find it */
+		if ( _mm_movemask_epi8( _mm_or_si128( transparent, opaque ) ) != 0xFFFF )
+		{
+			break;
+		}
+
+		key = _mm_or_si128(
+			_mm_or_si128(
+				_mm_slli_epi32( _mm_and_si128( pixels, redMask ), 10 ),
+				_mm_srli_epi32( _mm_and_si128( pixels, greenMask ), 4 ) ),
+			_mm_srli_epi32( _mm_and_si128( pixels, blueMask ), 18 ) );
+		key = _mm_or_si128( key, transparent );
+
+		_mm_storeu_si128( (__m128i *)( keys + pixel ), key );
+
+		pixel += 4;
+	}
+#endif
+
+	/* the rest of the pixels */
+	return pixel + pintoPixelsToKeysScalar( rgba + ( pixel * 4 ), pixelAmount - pixel, 0, 1, 2, 3, keys + pixel );
+}
+
+/******************************************************************************/
+/*!
+	\brief Sets pixels to the same 4 bytes.
+	\param[in] pixels Pixels, 4 bytes each.
+	\param[in] pixelAmount Amount of pixels.
+	\param[in] value The 4 bytes of each pixel.
+	\return void
+
+	Decoding spends most of its time here, so it's done 8 pixels at a time
+	with AVX2, or 4 pixels at a time with SSE2, if the compiler has them
+	enabled, and a machine word at a time otherwise. Once pixels is aligned,
+	so are the stores.
+*/
+void pintoPixelsFill( u8 *pixels, s32 pixelAmount, const u8 *value )
+{
+	/* DATA */
+	u32 pixel = 0;
+
+#if defined( __AVX2__ )
+	__m256i wide;
+#elif defined( __SSE2__ )
+	__m128i wide;
+#else
+	unsigned long word = 0;
+	u8 wordBytes[ sizeof( unsigned long ) ];
+	size_t i = 0;
+#endif
+
+
+	/* CODE */
+	PARANOID_ERR_IF( pixels == NULL );
+	PARANOID_ERR_IF( pixelAmount < 0 );
+	PARANOID_ERR_IF( value == NULL );
+
+	/* transparent, or a gray with every byte the same */
+	if ( value[ 0 ] == value[ 1 ] && value[ 0 ] == value[ 2 ] && value[ 0 ] == value[ 3 ] )
+	{
+		memset( pixels, value[ 0 ], pixelAmount * 4 );
+
+		return;
+	}
+
+	memcpy( &pixel, value, 4 );
+
+#if defined( __AVX2__ ) || defined( __SSE2__ )
+	/* get to an aligned address, if pixels lets us */
+	if ( ( (size_t) pixels & 3 ) == 0 )
+	{
+		while ( pixelAmount > 0 && ( (size_t) pixels & ( PINTO_SIMD_SIZE - 1 ) ) != 0 )
+		{
+			memcpy( pixels, &pixel, 4 );
+
+			pixels += 4;
+			pixelAmount -= 1;
+		}
+	}
+#endif
+
+#if defined( __AVX2__ )
+	wide = _mm256_set1_epi32( (int) pixel );
+
+	while ( pixelAmount >= 8 )
+	{
+		_mm256_storeu_si256( (__m256i *) pixels, wide );
+
+		pixels += 32;
+		pixelAmount -= 8;
+	}
+#elif defined( __SSE2__ )
+	wide = _mm_set1_epi32( (int) pixel );
+
+	while ( pixelAmount >= 4 )
+	{
+		_mm_storeu_si128( (__m128i *) pixels, wide );
+
+		pixels += 16;
+		pixelAmount -= 4;
+	}
+#else
+	for ( i = 0; i < sizeof( unsigned long ); i += 4 )
+	{
+		memcpy( wordBytes + i, &pixel, 4 );
+	}
+
+	memcpy( &word, wordBytes, sizeof( unsigned long ) );
+
+	while ( pixelAmount >= (s32)( sizeof( unsigned long ) / 4 ) )
+	{
+		memcpy( pixels, &word, sizeof( unsigned long ) );
+
+		pixels += sizeof( unsigned long );
+		pixelAmount -= (s32)( sizeof( unsigned long ) / 4 );
+	}
+#endif
+
+	while ( pixelAmount > 0 )
+	{
+		memcpy( pixels, &pixel, 4 );
+
+		pixels += 4;
+		pixelAmount -= 1;
+	}
+
+	return;
+}
+
+/******************************************************************************/
+/*!
+	\brief Converts pixels of an image view to palette keys.
+	\param[in] view Image view, for its format, color key, and threshold.
+	\param[in] pixels Pixels in the view's format.
+	\param[in] pixelAmount Amount of pixels.
+	\param[out] keys Key of each pixel, see PINTO_PALETTE_KEY, or -1 if the
+		pixel is fully transparent.
+	\return s32 Amount of pixels converted. See pintoPixelsToKeys().
+*/
+s32 pintoViewPixelsToKeys( const PintoImageView *view, const u8 *pixels, s32 pixelAmount, s32 *keys )
+{
+	/* CODE */
+	PARANOID_ERR_IF( view == NULL );
+
+	switch ( view->format )
+	{
+		case PINTO_FORMAT_BGRA:
+			return pintoPixelsToKeysOrdered( pixels, pixelAmount, 2, 1, 0, 3, keys );
+		case PINTO_FORMAT_ARGB:
+			return pintoPixelsToKeysOrdered( pixels, pixelAmount, 1, 2, 3, 0, keys );
+		case PINTO_FORMAT_RGB:
+			return pintoRgbToKeys( pixels, pixelAmount, view->colorKey, keys );
+		case PINTO_FORMAT_GRAY:
+			return pintoGrayToKeys( pixels, pixelAmount, view->threshold, keys );
+		default:
+			return pintoPixelsToKeys( pixels, pixelAmount, keys );
+	}
+}
+
+/******************************************************************************/
+/*!
+	\brief Gets how many bytes a pixel takes in a format.
+	\param[in] format One of the PINTO_FORMAT_* values.
+	\return s32 Bytes per pixel, or 0 if the format isn't valid.
+*/
+s32 pintoFormatPixelSize( s32 format )
+{
+	/* CODE */
+	switch ( format )
+	{
+		case PINTO_FORMAT_RGBA:
+		case PINTO_FORMAT_BGRA:
+		case PINTO_FORMAT_ARGB:
+			return 4;
+		case PINTO_FORMAT_RGB:
+			return 3;
+		case PINTO_FORMAT_GRAY:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+/******************************************************************************/
+/*!
+	\brief Converts 4 byte pixels to palette keys.
+	\param[in] pixels Pixels, 4 bytes each.
+	\param[in] pixelAmount Amount of pixels.
+	\param[in] redByte Which of the 4 bytes is red.
+	\param[in] greenByte Which of the 4 bytes is green.
+	\param[in] blueByte Which of the 4 bytes is blue.
+	\param[in] alphaByte Which of the 4 bytes is alpha.
+	\param[out] keys Key of each pixel, or -1 if the pixel is fully
+		transparent.
+	\return s32 Amount of pixels converted. See pintoPixelsToKeys().
+
+	Same as pintoPixelsToKeys(), but the shifts depend on the byte order, so
+	it's a bit slower.
+*/
+static s32 pintoPixelsToKeysOrdered( const u8 *pixels, s32 pixelAmount, s32 redByte, s32 greenByte, s32 blueByte, s32 alphaByte, s32 *keys )
+{
+	/* DATA */
+	s32 pixel = 0;
+
+#if defined( __AVX2__ )
+	__m256i data;
+	__m256i alpha;
+	__m256i transparent;
+	__m256i opaque;
+	__m256i key;
+
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i full = _mm256_set1_epi32( 255 );
+	const __m256i sixBits = _mm256_set1_epi32( 0x3F );
+	const __m128i redShift = _mm_cvtsi32_si128( ( redByte * 8 ) + 2 );
+	const __m128i greenShift = _mm_cvtsi32_si128( ( greenByte * 8 ) + 2 );
+	const __m128i blueShift = _mm_cvtsi32_si128( ( blueByte * 8 ) + 2 );
+	const __m128i alphaShift = _mm_cvtsi32_si128( alphaByte * 8 );
+#elif defined( __SSE2__ )
+	__m128i data;
+	__m128i alpha;
+	__m128i transparent;
+	__m128i opaque;
+	__m128i key;
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi32( 255 );
+	const __m128i sixBits = _mm_set1_epi32( 0x3F );
+	const __m128i redShift = _mm_cvtsi32_si128( ( redByte * 8 ) + 2 );
+	const __m128i greenShift = _mm_cvtsi32_si128( ( greenByte * 8 ) + 2 );
+	const __m128i blueShift = _mm_cvtsi32_si128( ( blueByte * 8 ) + 2 );
+	const __m128i alphaShift = _mm_cvtsi32_si128( alphaByte * 8 );
+#endif
+
+
+	/* CODE */
+	PARANOID_ERR_IF( pixels == NULL );
+	PARANOID_ERR_IF( pixelAmount < 0 );
+	PARANOID_ERR_IF( keys == NULL );
+
+	/* Each pixel is loaded as a little endian 32-bit value, so byte 0 is the
+	   lowest. Each color's top 6 bits are shifted down and masked, and then
+	   put in place:
+	   red << 12 | green << 6 | blue
+	   and transparent pixels are or'd with all 1s to make them -1. */
+
+#if defined( __AVX2__ )
+	while ( pixel + 8 <= pixelAmount )
+	{
+		data = _mm256_loadu_si256( (const __m256i *)( pixels + ( pixel * 4 ) ) );
+
+		alpha = _mm256_and_si256( _mm256_srl_epi32( data, alphaShift ), full );
+		transparent = _mm256_cmpeq_epi32( alpha, zero );
+		opaque = _mm256_cmpeq_epi32( alpha, full );
+
+		/* partially transparent pixel? let the scalar version find it */
+		if ( _mm256_movemask_epi8( _mm256_or_si256( transparent, opaque ) ) != -1 )
+		{
+			break;
+		}
+
+		key = _mm256_or_si256(
+			_mm256_or_si256(
+				_mm256_slli_epi32( _mm256_and_si256( _mm256_srl_epi32( data, redShift ), sixBits ), 12 ),
+				_mm256_slli_epi32( _mm256_and_si256( _mm256_srl_epi32( data, greenShift ), sixBits ), 6 ) ),
+			_mm256_and_si256( _mm256_srl_epi32( data, blueShift ), sixBits ) );
+		key = _mm256_or_si256( key, transparent );
+
+		_mm256_storeu_si256( (__m256i *)( keys + pixel ), key );
+
+		pixel += 8;
+	}
+#elif defined( __SSE2__ )
+	while ( pixel + 4 <= pixelAmount )
+	{
+		data = _mm_loadu_si128( (const __m128i *)( pixels + ( pixel * 4 ) ) );
+
+		alpha = _mm_and_si128( _mm_srl_epi32( data, alphaShift ), full );
+		transparent = _mm_cmpeq_epi32( alpha, zero );
+		opaque = _mm_cmpeq_epi32( alpha, full );
+
+		/* partially transparent pixel? let the scalar version find it */
+		if ( _mm_movemask_epi8( _mm_or_si128( transparent, opaque ) ) != 0xFFFF )
+		{
+			break;
+		}
+
+		key = _mm_or_si128(
+			_mm_or_si128(
+				_mm_slli_epi32( _mm_and_si128( _mm_srl_epi32( data, redShift ), sixBits ), 12 ),
+				_mm_slli_epi32( _mm_and_si128( _mm_srl_epi32( data, greenShift ), sixBits ), 6 ) ),
+			_mm_and_si128( _mm_srl_epi32( data, blueShift ), sixBits ) );
+		key = _mm_or_si128( key, transparent );
+
+		_mm_storeu_si128( (__m128i *)( keys + pixel ), key );
+
+		pixel += 4;
+	}
+#endif
+
+	/* the rest of the pixels */
+	return pixel + pintoPixelsToKeysScalar( pixels + ( pixel * 4 ), pixelAmount - pixel, redByte, greenByte, blueByte, alphaByte, keys + pixel );
+}
+
+/******************************************************************************/
+/*!
+	\brief Converts 4 byte pixels to palette keys, one pixel at a time.
+	\param[in] pixels Pixels, 4 bytes each.
+	\param[in] pixelAmount Amount of pixels.
+	\param[in] redByte Which of the 4 bytes is red.
+	\param[in] greenByte Which of the 4 bytes is green.
+	\param[in] blueByte Which of the 4 bytes is blue.
+	\param[in] alphaByte Which of the 4 bytes is alpha.
+	\param[out] keys Key of each pixel, or -1 if the pixel is fully
+		transparent.
+	\return s32 Amount of pixels converted. See pintoPixelsToKeys().
+*/
+static s32 pintoPixelsToKeysScalar( const u8 *pixels, s32 pixelAmount, s32 redByte, s32 greenByte, s32 blueByte, s32 alphaByte, s32 *keys )
+{
+	/* DATA */
+	s32 pixel = 0;
+	const u8 *data = NULL;
+
+
+	/* CODE */
+	for ( pixel = 0; pixel < pixelAmount; pixel += 1 )
+	{
+		data = pixels + ( pixel * 4 );
+
+		if ( data[ alphaByte ] == 0 )
+		{
+			keys[ pixel ] = -1;
+		}
+		else if ( data[ alphaByte ] == 255 )
+		{
+			keys[ pixel ] = PINTO_PALETTE_KEY( data[ redByte ], data[ greenByte ], data[ blueByte ] );
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	return pixel;
+}
+
+/******************************************************************************/
+/*!
+	\brief Converts 3 byte RGB pixels to palette keys.
+	\param[in] pixels Pixels, 3 bytes each.
+	\param[in] pixelAmount Amount of pixels.
+	\param[in] colorKey Color that's transparent, as 0xRRGGBB, or -1 for
+		none.
+	\param[out] keys Key of each pixel, or -1 if the pixel is transparent.
+	\return s32 Amount of pixels converted, which is always pixelAmount.
+*/
+static s32 pintoRgbToKeys( const u8 *pixels, s32 pixelAmount, s32 colorKey, s32 *keys )
+{
+	/* DATA */
+	s32 pixel = 0;
+	const u8 *data = NULL;
+
+
+	/* CODE */
+	for ( pixel = 0; pixel < pixelAmount; pixel += 1 )
+	{
+		data = pixels + ( pixel * 3 );
+
+		if ( ( ( (s32) data[ 0 ] << 16 ) | ( (s32) data[ 1 ] << 8 ) | (s32) data[ 2 ] ) == colorKey )
+		{
+			keys[ pixel ] = -1;
+		}
+		else
+		{
+			keys[ pixel ] = PINTO_PALETTE_KEY( data[ 0 ], data[ 1 ], data[ 2 ] );
+		}
+	}
+
+	return pixel;
+}
+
+/******************************************************************************/
+/*!
+	\brief Converts 1 byte gray pixels to palette keys.
+	\param[in] pixels Pixels, 1 byte each.
+	\param[in] pixelAmount Amount of pixels.
+	\param[in] threshold Pixels less than this are transparent.
+	\param[out] keys Key of each pixel, or -1 if the pixel is transparent.
+	\return s32 Amount of pixels converted, which is always pixelAmount.
+*/
+static s32 pintoGrayToKeys( const u8 *pixels, s32 pixelAmount, s32 threshold, s32 *keys )
+{
+	/* DATA */
+	s32 pixel = 0;
+
+
+	/* CODE */
+	for ( pixel = 0; pixel < pixelAmount; pixel += 1 )
+	{
+		if ( pixels[ pixel ] < threshold )
+		{
+			keys[ pixel ] = -1;
+		}
+		else
+		{
+			keys[ pixel ] = PINTO_PALETTE_KEY( pixels[ pixel ], pixels[ pixel ], pixels[ pixel ] );
+		}
+	}
+
+	return pixel;
+}
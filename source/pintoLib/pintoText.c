@@ -39,10 +39,27 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "pinto.h"
 #include "pintoInternal.h"
 
+#if defined( __AVX2__ )
+	#include <immintrin.h>
+	#define PINTO_SIMD_TEXT_SIZE 32
+#elif defined( __SSE2__ )
+	#include <emmintrin.h>
+	#define PINTO_SIMD_TEXT_SIZE 16
+#else
+	#define PINTO_SIMD_TEXT_SIZE 16
+#endif
+
+/* pintoTextAddBuffer() gathers this many valid characters at a time */
+#define PINTO_TEXT_CHUNK_SIZE 1024
+
 /******************************************************************************/
 /* How much increase the size of our buffer, via realloc, if we need more */
 s32 PINTO_TEXT_SIZE_GROWTH = 1024;
 
+/******************************************************************************/
+static void pintoTextSkipInvalid( PintoText *text );
+static void pintoTextDrop( PintoText *text, s32 amount );
+
 /******************************************************************************/
 const char valueToChar[ 64 ] = {
 	'0', '1', '2', '3', '4', '5', '6', '7', '8', '9',
@@ -53,6 +70,37 @@ const char valueToChar[ 64 ] = {
 	'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X',
 	'Y', 'Z', ':', ';' };
 
+/******************************************************************************/
+/* Entries of charToValue[] that aren't values */
+#define PINTO_CHAR_NOT_VALUE 64
+#define PINTO_CHAR_NOT_VALID 65
+
+/* The value of each character, the opposite of valueToChar[].
+   PINTO_CHAR_NOT_VALUE is a character used in encoding, like '#' or '^', and
+   PINTO_CHAR_NOT_VALID is a character that's skipped, like PINTO_CHAR_IS_VALID().
+   One lookup both checks and decodes a character. */
+#define NV PINTO_CHAR_NOT_VALUE
+#define XX PINTO_CHAR_NOT_VALID
+static const u8 charToValue[ 256 ] = {
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, NV, NV, NV, NV, NV, NV, NV, NV, NV, NV, NV, NV, NV,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 62, 63, NV, NV, NV, NV,
+	NV, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50,
+	51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, XX, XX, XX, NV, XX,
+	XX, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+	25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX };
+#undef NV
+#undef XX
+
 /******************************************************************************/
 /*!
 	\brief Initialize a text object.
@@ -62,6 +110,43 @@ const char valueToChar[ 64 ] = {
 	\return PINTO_RC
 */
 PINTO_RC pintoTextInit( PintoText **text_A )
+{
+	/* CODE */
+	FAILURE_POINT;
+
+	return pintoTextInitSize( text_A, PINTO_TEXT_SIZE_GROWTH );
+}
+
+/******************************************************************************/
+/*!
+	\brief Initialize a text object for giving text to a sink.
+	\param[out] text_A The new text object.
+		Will be allocated. Caller is responsible for freeing by passing the text
+		object to pintoTextFree().
+	\return PINTO_RC
+
+	The text's buffer is always PINTO_TEXT_SINK_SIZE. Use pintoTextSetSink()
+	to set where the text goes.
+*/
+PINTO_RC pintoTextInitSink( PintoText **text_A )
+{
+	/* CODE */
+	FAILURE_POINT;
+
+	return pintoTextInitSize( text_A, PINTO_TEXT_SINK_SIZE );
+}
+
+/******************************************************************************/
+/*!
+	\brief Initialize a text object with a buffer size.
+	\param[out] text_A The new text object.
+		Will be allocated. Caller is responsible for freeing by passing the text
+		object to pintoTextFree().
+	\param[in] size Size of the text's buffer. The text can hold one less than
+		this many characters before it grows, because of the '\0'.
+	\return PINTO_RC
+*/
+PINTO_RC pintoTextInitSize( PintoText **text_A, s32 size )
 {
 	/* DATA */
 	PINTO_RC rc = PINTO_RC_SUCCESS;
@@ -70,14 +155,14 @@ PINTO_RC pintoTextInit( PintoText **text_A )
 
 
 	/* CODE */
-	FAILURE_POINT;
 	ERR_IF( text_A == NULL, PINTO_RC_ERROR_PRECOND );
 	ERR_IF( (*text_A) != NULL, PINTO_RC_ERROR_PRECOND );
 
+	/* writeFunc starts out NULL */
 	PINTO_CALLOC( newText, PintoText, 1 );
 
-	PINTO_CALLOC( newText->string, char, PINTO_TEXT_SIZE_GROWTH );
-	newText->allocedSize = PINTO_TEXT_SIZE_GROWTH;
+	PINTO_CALLOC( newText->string, char, size );
+	newText->allocedSize = size;
 
 	newText->usedSize = 0;
 	newText->index = 0;
@@ -102,6 +187,68 @@ PINTO_RC pintoTextInit( PintoText **text_A )
 	return rc;
 }
 
+/******************************************************************************/
+/*!
+	\brief Sets up a text that reads characters that belong to someone else.
+	\param[in] text Text to set up. Must not be freed or added to.
+	\param[in] data Characters to read. Don't need to be '\0' terminated, and
+		can have characters that aren't used in encoding, which are skipped.
+	\param[in] length Amount of characters.
+	\return void
+
+	Lets a buffer be read where it is, instead of copying it into a text with
+	pintoTextAddChar().
+*/
+void pintoTextInitView( PintoText *text, const char *data, s32 length )
+{
+	/* CODE */
+	PARANOID_ERR_IF( text == NULL );
+	PARANOID_ERR_IF( data == NULL && length != 0 );
+
+	memset( text, 0, sizeof( PintoText ) );
+
+	text->string = (char *) data;
+	text->usedSize = length;
+	text->index = 0;
+
+	return;
+}
+
+/******************************************************************************/
+/*!
+	\brief Sets up a text that adds characters into a buffer that belongs to
+	       someone else.
+	\param[in] text Text to set up. Must not be freed.
+	\param[in] buffer Buffer to add characters to.
+	\param[in] size Size of buffer.
+	\return void
+
+	The text never grows. Characters fill all of buffer, with a '\0' after
+	them if there's room. Once a character doesn't fit, it and every character
+	after it are only counted in writtenSize, so the text still knows how big
+	a buffer it needed.
+*/
+void pintoTextInitBuffer( PintoText *text, char *buffer, s32 size )
+{
+	/* CODE */
+	PARANOID_ERR_IF( text == NULL );
+	PARANOID_ERR_IF( buffer == NULL );
+	PARANOID_ERR_IF( size < 0 );
+
+	memset( text, 0, sizeof( PintoText ) );
+
+	text->string = buffer;
+	text->allocedSize = size;
+	text->fixed = 1;
+
+	if ( size > 0 )
+	{
+		buffer[ 0 ] = '\0';
+	}
+
+	return;
+}
+
 /******************************************************************************/
 /*!
 	\brief Frees a text object.
@@ -151,7 +298,7 @@ PINTO_RC pintoTextAddChar( PintoText *text, char ch )
 	/* only add characters that are valid.
 	   skipping invalid characters allows clients to wordwrap
 	   the text, or add tabs or spaces. */
-	if ( ch < '#' || ch > 'z' || ch == '[' || ch == '\\' || ch == ']' || ch == '_' || ch == '`' )
+	if ( ! PINTO_CHAR_IS_VALID( ch ) )
 	{
 		/* not a valid character, don't add */
 		goto cleanup;
@@ -162,21 +309,413 @@ PINTO_RC pintoTextAddChar( PintoText *text, char ch )
 	   The fear is a malicious person crafting a small pinto encoding, that will
 	   deflate to take up huge amounts of ram ... if you consider more than 16MB to be huge :)
 	   That probably won't happen in this function, but we still enforce the constraint */
-	ERR_IF( text->usedSize + 1 > ( PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT ), PINTO_RC_ERROR_FORMAT_TOO_LONG );
+	ERR_IF( text->writtenSize + text->usedSize + 1 > ( PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT ), PINTO_RC_ERROR_FORMAT_TOO_LONG );
 
-	/* do we need to resize our buffer? */
+	/* do we need to resize our buffer, or give it to our sink? */
 	if ( text->usedSize + 1 >= text->allocedSize )
 	{
-		PINTO_REALLOC( reallocedText, text->string, char, text->allocedSize + PINTO_TEXT_SIZE_GROWTH );
-
-		text->allocedSize += PINTO_TEXT_SIZE_GROWTH;
-		text->string = reallocedText;
+		if ( text->writeFunc != NULL )
+		{
+			rc = pintoTextFlush( text );
+			ERR_IF_PASSTHROUGH;
+		}
+		else if ( text->fixed )
+		{
+			if ( text->usedSize + 1 > text->allocedSize )
+			{
+				pintoTextDrop( text, 1 );
+
+				goto cleanup;
+			}
+		}
+		else
+		{
+			PINTO_REALLOC( reallocedText, text->string, char, text->allocedSize + PINTO_TEXT_SIZE_GROWTH );
+
+			text->allocedSize += PINTO_TEXT_SIZE_GROWTH;
+			text->string = reallocedText;
+		}
 	}
 
-	/* add */
+	/* add. a full fixed buffer has no room for the '\0'. */
 	text->string[ text->usedSize ] = ch;
 	text->usedSize += 1;
-	text->string[ text->usedSize ] = '\0';
+
+	if ( text->usedSize < text->allocedSize )
+	{
+		text->string[ text->usedSize ] = '\0';
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Adds characters to the end of a text.
+	\param[in] text Text to add to.
+	\param[in] chars Characters to add. Must all be valid, see
+		PINTO_CHAR_IS_VALID().
+	\param[in] amount Amount of characters.
+	\return PINTO_RC
+
+	Same as calling pintoTextAddChar() for each character, but only grows the
+	buffer once.
+*/
+PINTO_RC pintoTextAddChars( PintoText *text, const char *chars, s32 amount )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	char *reallocedText = NULL;
+
+	s32 added = 0;
+	s32 piece = 0;
+	s32 fit = 0;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( text == NULL );
+	PARANOID_ERR_IF( chars == NULL && amount != 0 );
+
+	/* see pintoTextAddChar() */
+	ERR_IF( text->writtenSize + text->usedSize + amount > ( PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT ), PINTO_RC_ERROR_FORMAT_TOO_LONG );
+
+	/* fill our buffer and give it to our sink, until it's all added */
+	if ( text->writeFunc != NULL )
+	{
+		added = 0;
+		while ( added < amount )
+		{
+			if ( text->usedSize + 1 >= text->allocedSize )
+			{
+				rc = pintoTextFlush( text );
+				ERR_IF_PASSTHROUGH;
+			}
+
+			piece = text->allocedSize - 1 - text->usedSize;
+			if ( piece > amount - added )
+			{
+				piece = amount - added;
+			}
+
+			memcpy( text->string + text->usedSize, chars + added, piece );
+			text->usedSize += piece;
+			added += piece;
+		}
+
+		text->string[ text->usedSize ] = '\0';
+
+		goto cleanup;
+	}
+
+	/* do we need to resize our buffer? */
+	if ( text->usedSize + amount >= text->allocedSize )
+	{
+		if ( text->fixed )
+		{
+			if ( text->usedSize + amount > text->allocedSize )
+			{
+				/* fill what's left, and count the rest */
+				fit = text->allocedSize - text->usedSize;
+
+				memcpy( text->string + text->usedSize, chars, fit );
+				text->usedSize += fit;
+
+				pintoTextDrop( text, amount - fit );
+
+				goto cleanup;
+			}
+		}
+		else
+		{
+			PINTO_REALLOC( reallocedText, text->string, char, text->usedSize + amount + PINTO_TEXT_SIZE_GROWTH );
+
+			text->allocedSize = text->usedSize + amount + PINTO_TEXT_SIZE_GROWTH;
+			text->string = reallocedText;
+		}
+	}
+
+	/* add. a full fixed buffer has no room for the '\0'. */
+	memcpy( text->string + text->usedSize, chars, amount );
+	text->usedSize += amount;
+
+	if ( text->usedSize < text->allocedSize )
+	{
+		text->string[ text->usedSize ] = '\0';
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Adds a buffer of characters to the end of a text, skipping the
+		characters that aren't used in encoding.
+	\param[in] text Text to add to.
+	\param[in] buffer Characters to add. Can be word wrapped, or have any other
+		characters that aren't valid, see PINTO_CHAR_IS_VALID().
+	\param[in] length Amount of characters in buffer.
+	\param[out] strayIndex If not NULL, on success, index in buffer of the
+		first character that was skipped and isn't whitespace, or -1 if there
+		isn't one. Anything else skipped might mean the encoding was mangled.
+	\return PINTO_RC
+
+	Same as calling pintoTextAddChar() for each character, but only grows the
+	text once. Characters are checked 32 at a time with AVX2, or 16 at a time
+	with SSE2, if the compiler has them enabled, and blocks that are all valid
+	are copied at once.
+*/
+PINTO_RC pintoTextAddBuffer( PintoText *text, const char *buffer, s32 length, s32 *strayIndex )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	char *reallocedText = NULL;
+	s32 reserve = 0;
+
+	/* valid characters are gathered here, then added at once */
+	char chunk[ PINTO_TEXT_CHUNK_SIZE ];
+	s32 chunkAmount = 0;
+
+	s32 i = 0;
+	s32 blockEnd = 0;
+	s32 stray = -1;
+
+#if defined( __AVX2__ )
+	__m256i chars;
+	__m256i valid;
+
+	const __m256i low = _mm256_set1_epi8( '#' - 1 );
+	const __m256i high = _mm256_set1_epi8( 'z' + 1 );
+	const __m256i bracketsLow = _mm256_set1_epi8( '[' - 1 );
+	const __m256i bracketsHigh = _mm256_set1_epi8( ']' + 1 );
+	const __m256i quotesLow = _mm256_set1_epi8( '_' - 1 );
+	const __m256i quotesHigh = _mm256_set1_epi8( '`' + 1 );
+#elif defined( __SSE2__ )
+	__m128i chars;
+	__m128i valid;
+
+	const __m128i low = _mm_set1_epi8( '#' - 1 );
+	const __m128i high = _mm_set1_epi8( 'z' + 1 );
+	const __m128i bracketsLow = _mm_set1_epi8( '[' - 1 );
+	const __m128i bracketsHigh = _mm_set1_epi8( ']' + 1 );
+	const __m128i quotesLow = _mm_set1_epi8( '_' - 1 );
+	const __m128i quotesHigh = _mm_set1_epi8( '`' + 1 );
+#endif
+
+
+	/* PRECOND */
+	FAILURE_POINT;
+	ERR_IF( text == NULL, PINTO_RC_ERROR_PRECOND );
+	ERR_IF( buffer == NULL && length != 0, PINTO_RC_ERROR_PRECOND );
+	ERR_IF_1( length < 0, PINTO_RC_ERROR_PRECOND, length );
+
+
+	/* CODE */
+
+	/* grow once for all of it, but not past what a text can hold. a text
+	   with a sink gives its characters away instead, and a text over a fixed
+	   buffer can't grow. */
+	reserve = ( PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT ) - text->writtenSize - text->usedSize;
+	if ( reserve > length )
+	{
+		reserve = length;
+	}
+
+	if ( text->writeFunc == NULL && ! text->fixed && text->usedSize + reserve >= text->allocedSize )
+	{
+		PINTO_REALLOC( reallocedText, text->string, char, text->usedSize + reserve + 1 );
+
+		text->allocedSize = text->usedSize + reserve + 1;
+		text->string = reallocedText;
+	}
+
+	while ( i < length )
+	{
+		chunkAmount = 0;
+
+		while ( i < length && chunkAmount + PINTO_SIMD_TEXT_SIZE <= PINTO_TEXT_CHUNK_SIZE )
+		{
+			blockEnd = i + PINTO_SIMD_TEXT_SIZE;
+
+#if defined( __AVX2__ )
+			/* characters are signed here, so ones above 127 are below low.
+			   '[' to ']', and '_' to '`' aren't valid. */
+			if ( blockEnd <= length )
+			{
+				chars = _mm256_loadu_si256( (const __m256i *)( buffer + i ) );
+
+				valid = _mm256_and_si256( _mm256_cmpgt_epi8( chars, low ), _mm256_cmpgt_epi8( high, chars ) );
+				valid = _mm256_andnot_si256( _mm256_and_si256( _mm256_cmpgt_epi8( chars, bracketsLow ), _mm256_cmpgt_epi8( bracketsHigh, chars ) ), valid );
+				valid = _mm256_andnot_si256( _mm256_and_si256( _mm256_cmpgt_epi8( chars, quotesLow ), _mm256_cmpgt_epi8( quotesHigh, chars ) ), valid );
+
+				if ( _mm256_movemask_epi8( valid ) == -1 )
+				{
+					_mm256_storeu_si256( (__m256i *)( chunk + chunkAmount ), chars );
+
+					chunkAmount += PINTO_SIMD_TEXT_SIZE;
+					i = blockEnd;
+
+					continue;
+				}
+			}
+#elif defined( __SSE2__ )
+			/* characters are signed here, so ones above 127 are below low.
+			   '[' to ']', and '_' to '`' aren't valid. */
+			if ( blockEnd <= length )
+			{
+				chars = _mm_loadu_si128( (const __m128i *)( buffer + i ) );
+
+				valid = _mm_and_si128( _mm_cmpgt_epi8( chars, low ), _mm_cmplt_epi8( chars, high ) );
+				valid = _mm_andnot_si128( _mm_and_si128( _mm_cmpgt_epi8( chars, bracketsLow ), _mm_cmplt_epi8( chars, bracketsHigh ) ), valid );
+				valid = _mm_andnot_si128( _mm_and_si128( _mm_cmpgt_epi8( chars, quotesLow ), _mm_cmplt_epi8( chars, quotesHigh ) ), valid );
+
+				if ( _mm_movemask_epi8( valid ) == 0xFFFF )
+				{
+					_mm_storeu_si128( (__m128i *)( chunk + chunkAmount ), chars );
+
+					chunkAmount += PINTO_SIMD_TEXT_SIZE;
+					i = blockEnd;
+
+					continue;
+				}
+			}
+#endif
+
+			/* the block has characters to skip, so go one at a time */
+			if ( blockEnd > length )
+			{
+				blockEnd = length;
+			}
+
+			while ( i < blockEnd )
+			{
+				if ( PINTO_CHAR_IS_VALID( buffer[ i ] ) )
+				{
+					chunk[ chunkAmount ] = buffer[ i ];
+					chunkAmount += 1;
+				}
+				else if ( stray == -1 && ! PINTO_CHAR_IS_SPACE( buffer[ i ] ) )
+				{
+					stray = i;
+				}
+
+				i += 1;
+			}
+		}
+
+		rc = pintoTextAddChars( text, chunk, chunkAmount );
+		ERR_IF_PASSTHROUGH;
+	}
+
+	if ( strayIndex != NULL )
+	{
+		(*strayIndex) = stray;
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/*!
+	\brief Adds all the characters of one text to the end of another.
+	\param[in] text Text to add to.
+	\param[in] textToAdd Text whose characters get added.
+	\return PINTO_RC
+
+	See pintoTextAddChars().
+*/
+PINTO_RC pintoTextAddText( PintoText *text, const PintoText *textToAdd )
+{
+	/* CODE */
+	PARANOID_ERR_IF( textToAdd == NULL );
+
+	return pintoTextAddChars( text, textToAdd->string, textToAdd->usedSize );
+}
+
+/******************************************************************************/
+/*!
+	\brief Empties a text object, keeping its buffer.
+	\param[in] text Text.
+	\return void
+*/
+void pintoTextReset( PintoText *text )
+{
+	/* CODE */
+	PARANOID_ERR_IF( text == NULL );
+
+	text->usedSize = 0;
+	text->index = 0;
+	text->string[ 0 ] = '\0';
+
+	text->writeFunc = NULL;
+	text->userData = NULL;
+	text->writtenSize = 0;
+
+	return;
+}
+
+/******************************************************************************/
+/*!
+	\brief Empties a text object, and sets the sink to give its characters to.
+	\param[in] text Text, from pintoTextInitSink().
+	\param[in] writeFunc Function to give the characters to.
+	\param[in] userData Passed to writeFunc.
+	\return void
+
+	Characters are given to the sink whenever the text's buffer is full, and
+	by pintoTextFlush().
+*/
+void pintoTextSetSink( PintoText *text, PintoWriteFunc writeFunc, void *userData )
+{
+	/* CODE */
+	PARANOID_ERR_IF( text == NULL );
+	PARANOID_ERR_IF( text->allocedSize < 2 );
+
+	pintoTextReset( text );
+
+	text->writeFunc = writeFunc;
+	text->userData = userData;
+
+	return;
+}
+
+/******************************************************************************/
+/*!
+	\brief Gives all of a text's characters to its sink, and empties it.
+	\param[in] text Text with a sink.
+	\return PINTO_RC
+*/
+PINTO_RC pintoTextFlush( PintoText *text )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+
+	/* CODE */
+	PARANOID_ERR_IF( text == NULL );
+	PARANOID_ERR_IF( text->writeFunc == NULL );
+
+	if ( text->usedSize > 0 )
+	{
+		ERR_IF( text->writeFunc( text->userData, text->string, text->usedSize ) != 0, PINTO_RC_ERROR_WRITE_FAILED );
+	}
+
+	text->writtenSize += text->usedSize;
+	text->usedSize = 0;
+	text->string[ 0 ] = '\0';
 
 
 	/* CLEANUP */
@@ -185,6 +724,28 @@ PINTO_RC pintoTextAddChar( PintoText *text, char ch )
 	return rc;
 }
 
+/******************************************************************************/
+/*!
+	\brief Counts characters that don't fit in a text over a fixed buffer.
+	\param[in] text Text from pintoTextInitBuffer().
+	\param[in] amount Amount of characters that didn't fit.
+	\return void
+
+	The text is marked full, so every character added after these is counted
+	too, instead of added after a gap.
+*/
+static void pintoTextDrop( PintoText *text, s32 amount )
+{
+	/* CODE */
+	PARANOID_ERR_IF( text == NULL );
+	PARANOID_ERR_IF( ! text->fixed );
+
+	text->allocedSize = text->usedSize;
+	text->writtenSize += amount;
+
+	return;
+}
+
 /******************************************************************************/
 /*!
 	\brief Used to see if we're at the end of the text.
@@ -196,9 +757,31 @@ s32 pintoTextAtEnd( PintoText *text )
 	/* CODE */
 	PARANOID_ERR_IF( text == NULL );
 
+	pintoTextSkipInvalid( text );
+
 	return text->index == text->usedSize;
 }
 
+/******************************************************************************/
+/*!
+	\brief Moves past characters that aren't used in encoding.
+	\param[in] text Text.
+	\return void
+
+	Only a text from pintoTextInitView() can have them, since
+	pintoTextAddChar() doesn't add them.
+*/
+static void pintoTextSkipInvalid( PintoText *text )
+{
+	/* CODE */
+	while ( text->index < text->usedSize && charToValue[ (u8) text->string[ text->index ] ] == PINTO_CHAR_NOT_VALID )
+	{
+		text->index += 1;
+	}
+
+	return;
+}
+
 /******************************************************************************/
 /*!
 	\brief Peeks at next character in text.
@@ -216,6 +799,8 @@ PINTO_RC pintoTextPeekChar( PintoText *text, char *ch )
 	PARANOID_ERR_IF( text == NULL );
 	PARANOID_ERR_IF( ch == NULL );
 
+	pintoTextSkipInvalid( text );
+
 	ERR_IF( text->index == text->usedSize, PINTO_RC_ERROR_FORMAT_INVALID );
 
 	(*ch) = text->string[ text->index ];
@@ -244,6 +829,8 @@ PINTO_RC pintoTextGetChar( PintoText *text, char *ch )
 	PARANOID_ERR_IF( text == NULL );
 	PARANOID_ERR_IF( ch == NULL );
 
+	pintoTextSkipInvalid( text );
+
 	ERR_IF( text->index == text->usedSize, PINTO_RC_ERROR_FORMAT_INVALID );
 
 	(*ch) = text->string[ text->index ];
@@ -321,69 +908,75 @@ PINTO_RC pintoTextAddValue( PintoText *text, s32 value )
 	/* DATA */
 	PINTO_RC rc = PINTO_RC_SUCCESS;
 
+	char chars[ PINTO_VALUE_SIZE_MAX ];
+	s32 amount = 0;
+	char *to = NULL;
+
 
 	/* CODE */
 	PARANOID_ERR_IF( text == NULL );
 	PARANOID_ERR_IF( value < 0 );
 	PARANOID_ERR_IF( value >= (64 * 64 * 64 * 64) );
 
+	/* there's usually room, so write straight into the text. otherwise
+	   pintoTextAddChars() grows it, or gives it to the sink. */
+	if (    text->usedSize + PINTO_VALUE_SIZE_MAX < text->allocedSize
+	     && text->writtenSize + text->usedSize + PINTO_VALUE_SIZE_MAX <= ( PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT )
+	   )
+	{
+		to = text->string + text->usedSize;
+	}
+	else
+	{
+		to = chars;
+	}
+
 	if ( value < 64 )
 	{
-		rc = pintoTextAddChar( text, valueToChar[ value % 64 ] );
-		ERR_IF_PASSTHROUGH;
+		to[ 0 ] = valueToChar[ value ];
+		amount = 1;
 	}
 	else if ( value < (64 * 14) )
 	{
-		rc = pintoTextAddChar( text, '\"' + ( value / 64 ) );
-		ERR_IF_PASSTHROUGH;
-
-		rc = pintoTextAddChar( text, valueToChar[ value % 64 ] );
-		ERR_IF_PASSTHROUGH;
+		to[ 0 ] = (char)( '\"' + ( value / 64 ) );
+		to[ 1 ] = valueToChar[ value % 64 ];
+		amount = 2;
 	}
 	else if ( value < (64 * 64) )
 	{
-		rc = pintoTextAddChar( text, '<' );
-		ERR_IF_PASSTHROUGH;
-
-		rc = pintoTextAddChar( text, valueToChar[ ( (value) / 64 ) % 64 ] );
-		ERR_IF_PASSTHROUGH;
-
-		rc = pintoTextAddChar( text, valueToChar[   (value)        % 64 ] );
-		ERR_IF_PASSTHROUGH;
+		to[ 0 ] = '<';
+		to[ 1 ] = valueToChar[ ( (value) / 64 ) % 64 ];
+		to[ 2 ] = valueToChar[   (value)        % 64 ];
+		amount = 3;
 	}
-	else if ( value < (64 * 64 * 64) ) 
+	else if ( value < (64 * 64 * 64) )
 	{
-		rc = pintoTextAddChar( text, '=' );
-		ERR_IF_PASSTHROUGH;
-
-		rc = pintoTextAddChar( text, valueToChar[ ( (value) / (64 * 64) ) % 64 ] );
-		ERR_IF_PASSTHROUGH;
-
-		rc = pintoTextAddChar( text, valueToChar[ ( (value) / (64     ) ) % 64 ] );
-		ERR_IF_PASSTHROUGH;
-
-		rc = pintoTextAddChar( text, valueToChar[   (value)               % 64 ] );
-		ERR_IF_PASSTHROUGH;
+		to[ 0 ] = '=';
+		to[ 1 ] = valueToChar[ ( (value) / (64 * 64) ) % 64 ];
+		to[ 2 ] = valueToChar[ ( (value) / (64     ) ) % 64 ];
+		to[ 3 ] = valueToChar[   (value)               % 64 ];
+		amount = 4;
 	}
 	else
 	{
-		PARANOID_ERR_IF( value >= (64 * 64 * 64 * 64) );
-
-		rc = pintoTextAddChar( text, '>' );
-		ERR_IF_PASSTHROUGH;
-
-		rc = pintoTextAddChar( text, valueToChar[ ( (value) / (64 * 64 * 64) ) % 64 ] );
-		ERR_IF_PASSTHROUGH;
-
-		rc = pintoTextAddChar( text, valueToChar[ ( (value) / (64 * 64     ) ) % 64 ] );
-		ERR_IF_PASSTHROUGH;
-
-		rc = pintoTextAddChar( text, valueToChar[ ( (value) / (64          ) ) % 64 ] );
-		ERR_IF_PASSTHROUGH;
+		to[ 0 ] = '>';
+		to[ 1 ] = valueToChar[ ( (value) / (64 * 64 * 64) ) % 64 ];
+		to[ 2 ] = valueToChar[ ( (value) / (64 * 64     ) ) % 64 ];
+		to[ 3 ] = valueToChar[ ( (value) / (64          ) ) % 64 ];
+		to[ 4 ] = valueToChar[   (value)                    % 64 ];
+		amount = 5;
+	}
 
-		rc = pintoTextAddChar( text, valueToChar[   (value)                    % 64 ] );
+	if ( to == chars )
+	{
+		rc = pintoTextAddChars( text, chars, amount );
 		ERR_IF_PASSTHROUGH;
 	}
+	else
+	{
+		text->usedSize += amount;
+		text->string[ text->usedSize ] = '\0';
+	}
 
 
 	/* CLEANUP */
@@ -392,6 +985,38 @@ PINTO_RC pintoTextAddValue( PintoText *text, s32 value )
 	return rc;
 }
 
+/******************************************************************************/
+/*!
+	\brief Gets how many characters pintoTextAddValue() uses for a value.
+	\param[in] value Value.
+	\return Amount of characters.
+*/
+s32 pintoTextValueSize( s32 value )
+{
+	/* CODE */
+	PARANOID_ERR_IF( value < 0 );
+	PARANOID_ERR_IF( value >= (64 * 64 * 64 * 64) );
+
+	if ( value < 64 )
+	{
+		return 1;
+	}
+	else if ( value < (64 * 14) )
+	{
+		return 2;
+	}
+	else if ( value < (64 * 64) )
+	{
+		return 3;
+	}
+	else if ( value < (64 * 64 * 64) )
+	{
+		return 4;
+	}
+
+	return 5;
+}
+
 /******************************************************************************/
 /*!
 	\brief Gets an encoded value from text.
@@ -406,6 +1031,11 @@ PINTO_RC pintoTextGetValue( PintoText *text, s32 *value )
 	/* DATA */
 	PINTO_RC rc = PINTO_RC_SUCCESS;
 
+	const u8 *string = NULL;
+	s32 digits = 0;
+	s32 digit = 0;
+	s32 i = 0;
+
 	char ch = 0;
 
 
@@ -413,65 +1043,82 @@ PINTO_RC pintoTextGetValue( PintoText *text, s32 *value )
 	PARANOID_ERR_IF( text == NULL );
 	PARANOID_ERR_IF( value == NULL );
 
+	pintoTextSkipInvalid( text );
+
 	ERR_IF( text->index == text->usedSize, PINTO_RC_ERROR_FORMAT_INVALID );
 
+	string = (const u8 *)( text->string + text->index );
+
+	/* most values are a single character */
+	digit = charToValue[ string[ 0 ] ];
+	if ( digit < 64 )
+	{
+		(*value) = digit;
+		text->index += 1;
+
+		goto cleanup;
+	}
+
+	/* how many characters follow the first one? */
 	(*value) = 0;
 
-	ch = text->string[ text->index ];
+	ch = (char) string[ 0 ];
 
 	/* No valid character has a lower value than '#', so we don't have to test
 	   for "ch >= '#'". Just testing for "ch <= '/'" is enough. */
-	if ( ch <= '/' ) 
+	if ( ch <= '/' )
 	{
 		PARANOID_ERR_IF( ch < '#' );
 
-		text->index += 1;
-
 		(*value) = ch - '\"';
-
-		rc = pintoTextUpdateValue( text, value );
-		ERR_IF_PASSTHROUGH;
+		digits = 1;
 	}
 	else if ( ch == '<' )
 	{
-		text->index += 1;
-
-		rc = pintoTextUpdateValue( text, value );
-		ERR_IF_PASSTHROUGH;
-
-		rc = pintoTextUpdateValue( text, value );
-		ERR_IF_PASSTHROUGH;
+		digits = 2;
 	}
 	else if ( ch == '=' )
 	{
-		text->index += 1;
-
-		rc = pintoTextUpdateValue( text, value );
-		ERR_IF_PASSTHROUGH;
-
-		rc = pintoTextUpdateValue( text, value );
-		ERR_IF_PASSTHROUGH;
-
-		rc = pintoTextUpdateValue( text, value );
-		ERR_IF_PASSTHROUGH;
+		digits = 3;
 	}
 	else if ( ch == '>' )
 	{
-		text->index += 1;
-
-		rc = pintoTextUpdateValue( text, value );
-		ERR_IF_PASSTHROUGH;
+		digits = 4;
+	}
+	else
+	{
+		ERR_IF( 1, PINTO_RC_ERROR_FORMAT_INVALID );
+	}
 
-		rc = pintoTextUpdateValue( text, value );
-		ERR_IF_PASSTHROUGH;
+	/* decode them all at once, if they're all here with nothing skipped
+	   between them */
+	if ( text->index + 1 + digits <= text->usedSize )
+	{
+		for ( i = 1; i <= digits; i += 1 )
+		{
+			digit = charToValue[ string[ i ] ];
+			if ( digit >= 64 )
+			{
+				break;
+			}
+
+			(*value) = ( (*value) * 64 ) + digit;
+		}
+
+		if ( i > digits )
+		{
+			text->index += 1 + digits;
+
+			goto cleanup;
+		}
+
+		/* start over, one character at a time */
+		(*value) = ( ch <= '/' ? ch - '\"' : 0 );
+	}
 
-		rc = pintoTextUpdateValue( text, value );
-		ERR_IF_PASSTHROUGH;
+	text->index += 1;
 
-		rc = pintoTextUpdateValue( text, value );
-		ERR_IF_PASSTHROUGH;
-	}
-	else
+	for ( i = 0; i < digits; i += 1 )
 	{
 		rc = pintoTextUpdateValue( text, value );
 		ERR_IF_PASSTHROUGH;
@@ -507,49 +1154,22 @@ PINTO_RC pintoTextUpdateValue( PintoText *text, s32 *value )
 	/* DATA */
 	PINTO_RC rc = PINTO_RC_SUCCESS;
 
-	char ch = 0;
+	s32 digit = 0;
 
 
 	/* CODE */
 	PARANOID_ERR_IF( text == NULL );
 	PARANOID_ERR_IF( value == NULL );
 
+	pintoTextSkipInvalid( text );
+
 	ERR_IF( text->index == text->usedSize, PINTO_RC_ERROR_FORMAT_INVALID );
 
-	(*value) *= 64;
+	digit = charToValue[ (u8) text->string[ text->index ] ];
 
-	ch = text->string[ text->index ];
+	ERR_IF( digit >= 64, PINTO_RC_ERROR_FORMAT_INVALID );
 
-	if ( ch >= '0' && ch <= '9' )
-	{
-		(*value) += ( ch - '0' );
-	}
-	else if ( ch >= 'a' )
-	{
-		/* No valid character has a higher value
-		   than 'z', so we don't have to test for
-		   "ch <= 'z'". Just testing for "ch >= 'a'"
-		   is enough. */
-		PARANOID_ERR_IF( ch > 'z' );
-
-		(*value) += 10 + ( ch - 'a' );
-	}
-	else if ( ch >= 'A' && ch <= 'Z' )
-	{
-		(*value) += 36 + ( ch - 'A' );
-	}
-	else if ( ch == ':' )
-	{
-		(*value) += 62;
-	}
-	else if ( ch == ';' )
-	{
-		(*value) += 63;
-	}
-	else
-	{
-		ERR_IF( 1, PINTO_RC_ERROR_FORMAT_INVALID );
-	}
+	(*value) = ( (*value) * 64 ) + digit;
 
 	text->index += 1;
 
@@ -587,77 +1207,3 @@ void pintoTextFreeAndGetString( PintoText **text_F, char **string_A )
 	return;
 }
 
-/******************************************************************************/
-/*!
-	\brief Helps the inflate function by duplicating previous characters and
-	       adding them to the end of the text.
-	\param[in] text Text.
-	\param[in] distance Amount of characters from the end to start copying.
-	\param[in] length Amount of characters to copy.
-	\return PINTO_RC
-
-	Will work even if length is greater than distance.
-	For example, if the text was:
-	"ABCDE"
-	With distance=2 and length=5, then the text would become:
-	"ABCDEDEDED"
-*/
-PINTO_RC pintoTextInflateHelper( PintoText *text, s32 distance, s32 length )
-{
-	/* DATA */
-	PINTO_RC rc = PINTO_RC_SUCCESS;
-
-	char *reallocedText = NULL;
-
-	s32 i = 0;
-	s32 j = 0;
-
-
-	/* CODE */
-	PARANOID_ERR_IF( text == NULL );
-	PARANOID_ERR_IF( distance < 0 );
-	PARANOID_ERR_IF( length < 0 );
-
-	ERR_IF( distance == 0, PINTO_RC_ERROR_FORMAT_INVALID );
-	ERR_IF( length == 0, PINTO_RC_ERROR_FORMAT_INVALID );
-
-	/* make sure distance is not too big */
-	ERR_IF( text->usedSize - distance < 0, PINTO_RC_ERROR_FORMAT_INVALID );
-
-	/* do we need to resize our buffer? */
-	if ( text->usedSize + length >= text->allocedSize )
-	{
-		/* No text should ever reach this size, so we put this in to prevent
-		   the buffer from growing too big.
-		   The fear is a malicious person crafting a small pinto encoding, that will
-		   deflate to take up huge amounts of ram ... if you consider more than 16MB to be huge :) */
-		ERR_IF( text->usedSize + length > ( PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT ), PINTO_RC_ERROR_FORMAT_TOO_LONG );
-
-		/* *** */
-		PINTO_REALLOC( reallocedText, text->string, char, text->allocedSize + length );
-
-		text->allocedSize += length;
-		text->string = reallocedText;
-	}
-
-	/* add */
-	j = text->usedSize - distance;
-
-	while ( i < length )
-	{
-		text->string[ text->usedSize ] = text->string[ j ];
-		text->usedSize += 1;
-		text->string[ text->usedSize ] = '\0';
-
-		/* next character */
-		i += 1;
-		j += 1;
-	}
-
-
-	/* CLEANUP */
-	cleanup:
-
-	return rc;
-}
-
@@ -0,0 +1,147 @@
+/*
+Copyright (C) 2012-2014 Jeremiah Martell
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    - Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    - Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+    - Neither the name of Jeremiah Martell nor the name of GeekHorse nor the
+      name of Pinto nor the names of its contributors may be used to endorse
+      or promote products derived from this software without specific prior
+      written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/******************************************************************************/
+/*!
+	\file
+	Running jobs on threads.
+
+	Threads are only used if Pinto is built with PINTO_ENABLE_THREADS defined,
+	and linked with pthreads. Otherwise jobs are run one after another on the
+	calling thread. Either way, every job is finished when pintoThreadsRun()
+	returns, and jobs must not depend on the order they run in, so the results
+	are the same.
+*/
+#undef PINTO_FILE_NUMBER
+#define PINTO_FILE_NUMBER 4
+
+/******************************************************************************/
+#include "pinto.h"
+#include "pintoInternal.h"
+
+#ifdef PINTO_ENABLE_THREADS
+	#include <pthread.h>
+#endif
+
+/******************************************************************************/
+#ifdef PINTO_ENABLE_THREADS
+typedef struct
+{
+	PintoJobFunc func;
+	void *job;
+} PintoThreadStart;
+
+static void *pintoThreadStart( void *arg );
+#endif
+
+/******************************************************************************/
+/*!
+	\brief Runs jobs, on as many threads as there are jobs.
+	\param[in] func Function to run for each job.
+	\param[in] jobs Array of jobs. Each one is passed to func.
+	\param[in] jobSize Size of each job, in bytes.
+	\param[in] jobAmount Amount of jobs. Must be at most PINTO_MAX_THREADS.
+	\return void
+
+	The first job runs on the calling thread. If a thread can't be created, its
+	job runs on the calling thread instead. Jobs report errors through their
+	own structures.
+*/
+void pintoThreadsRun( PintoJobFunc func, void *jobs, size_t jobSize, s32 jobAmount )
+{
+	/* DATA */
+	s32 i = 0;
+
+#ifdef PINTO_ENABLE_THREADS
+	pthread_t threads[ PINTO_MAX_THREADS ];
+	PintoThreadStart starts[ PINTO_MAX_THREADS ];
+	char threadCreated[ PINTO_MAX_THREADS ];
+#endif
+
+
+	/* CODE */
+	PARANOID_ERR_IF( func == NULL );
+	PARANOID_ERR_IF( jobs == NULL );
+	PARANOID_ERR_IF( jobAmount < 0 );
+	PARANOID_ERR_IF( jobAmount > PINTO_MAX_THREADS );
+
+#ifdef PINTO_ENABLE_THREADS
+	for ( i = 1; i < jobAmount; i += 1 )
+	{
+		starts[ i ].func = func;
+		starts[ i ].job = ( (char *) jobs ) + ( jobSize * i );
+
+		threadCreated[ i ] = ( pthread_create( &threads[ i ], NULL, pintoThreadStart, &starts[ i ] ) == 0 );
+		if ( ! threadCreated[ i ] )
+		{
+			func( starts[ i ].job );
+		}
+	}
+
+	if ( jobAmount > 0 )
+	{
+		func( jobs );
+	}
+
+	for ( i = 1; i < jobAmount; i += 1 )
+	{
+		if ( threadCreated[ i ] )
+		{
+			pthread_join( threads[ i ], NULL );
+		}
+	}
+#else
+	for ( i = 0; i < jobAmount; i += 1 )
+	{
+		func( ( (char *) jobs ) + ( jobSize * i ) );
+	}
+#endif
+
+	return;
+}
+
+#ifdef PINTO_ENABLE_THREADS
+/******************************************************************************/
+/*!
+	\brief Entry point of each thread.
+	\param[in] arg The thread's PintoThreadStart.
+	\return void * Always NULL.
+*/
+static void *pintoThreadStart( void *arg )
+{
+	/* DATA */
+	PintoThreadStart *start = (PintoThreadStart *) arg;
+
+
+	/* CODE */
+	start->func( start->job );
+
+	return NULL;
+}
+#endif
@@ -42,6 +42,13 @@ static int testBadImages();
 static int testBadFormats();
 static int testGoodDeflate();
 static int testBadDeflate();
+static int testDeflateChainDepth();
+static int testDeflateReference( PintoText *textIn, PintoText **textOut_A );
+static int testDeflateOptimal();
+static int testDeflateParallel();
+static int testRleColors();
+static int testReorderColors();
+static int testRleReference( const char *indexedData, s32 pixelAmount, s32 color, PintoText *text );
 static int testRandomImages(
 	char *description,
 	int numberOfImages,
@@ -51,6 +58,62 @@ static int testRandomImages(
 	int square,
 	int maxSize );
 static int testImageVerify( PintoImage *image );
+static int testImageViews();
+
+/******************************************************************************/
+/* Checks that another way to encode or decode an image agrees with its
+   encoding, and with what that encoding decodes to */
+typedef int (*TestVerifyFunc)( const PintoImage *image, const char *encoding, const PintoImage *imageOut );
+
+static int testImageVerifyAll( const PintoImage *image );
+static int testImageVerifyWith( const PintoImage *image, TestVerifyFunc verify );
+static int testFixtures( const char *description, TestVerifyFunc verify );
+static int testFixtureImage( s32 fixture, PintoImage **image_A );
+static int testEncodeIntoVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut );
+static int testEncodeToSinkVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut );
+static int testEncoderVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut );
+static int testEncodeLevelsVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut );
+static int testIndexedImageVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut );
+static int testImageViewVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut );
+static int testDecodeBufferVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut );
+static int testDecodeIntoVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut );
+static int testIndexedDecodeVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut );
+
+/* Every way testImageVerifyAll() checks an image */
+static TestVerifyFunc verifyFuncs[] =
+{
+	testEncodeIntoVerify,
+	testEncodeToSinkVerify,
+	testEncoderVerify,
+	testEncodeLevelsVerify,
+	testIndexedImageVerify,
+	testImageViewVerify,
+	testDecodeBufferVerify,
+	testDecodeIntoVerify,
+	testIndexedDecodeVerify,
+	NULL
+};
+
+/* Number of images testFixtureImage() makes */
+#define TEST_FIXTURE_AMOUNT 7
+
+/******************************************************************************/
+/* Sink that collects an encoding */
+typedef struct
+{
+	char *buffer;
+	s32 bufferSize;
+	s32 usedSize;
+	/* amount of writes that succeed before failing, or -1 to never fail */
+	s32 writesBeforeFailing;
+} TestSink;
+
+static s32 testSinkWrite( void *userData, const char *data, s32 size );
+static int testEncodeToSink();
+
+/******************************************************************************/
+/* Used by every verify function, so it's reused across many images */
+static PintoEncoder *verifyEncoder = NULL;
 
 /******************************************************************************/
 int testEncodingDecoding()
@@ -62,12 +125,30 @@ int testEncodingDecoding()
 	/* CODE */
 	printf( "Testing encoding/decoding...\n" ); fflush( stdout );
 
+	TEST_ERR_IF( pintoEncoderInit( &verifyEncoder ) != PINTO_RC_SUCCESS );
+
 	TEST_ERR_IF( testGoodImages() != 0 );
 	TEST_ERR_IF( testGoodFormats() != 0 );
 	TEST_ERR_IF( testGoodDeflate() != 0 );
 	TEST_ERR_IF( testBadImages() != 0 );
 	TEST_ERR_IF( testBadFormats() != 0 );
 	TEST_ERR_IF( testBadDeflate() != 0 );
+	TEST_ERR_IF( testDeflateChainDepth() != 0 );
+	TEST_ERR_IF( testDeflateOptimal() != 0 );
+	TEST_ERR_IF( testDeflateParallel() != 0 );
+	TEST_ERR_IF( testRleColors() != 0 );
+	TEST_ERR_IF( testReorderColors() != 0 );
+	TEST_ERR_IF( testFixtures( "Testing encoding into a buffer...", testEncodeIntoVerify ) != 0 );
+	TEST_ERR_IF( testEncodeToSink() != 0 );
+	TEST_ERR_IF( testFixtures( "Testing encoding to a sink at each level...", testEncodeToSinkVerify ) != 0 );
+	TEST_ERR_IF( testFixtures( "Testing encoder reuse and adding rows...", testEncoderVerify ) != 0 );
+	TEST_ERR_IF( testFixtures( "Testing encoding levels and threads...", testEncodeLevelsVerify ) != 0 );
+	TEST_ERR_IF( testFixtures( "Testing indexed images...", testIndexedImageVerify ) != 0 );
+	TEST_ERR_IF( testImageViews() != 0 );
+	TEST_ERR_IF( testFixtures( "Testing image views of images...", testImageViewVerify ) != 0 );
+	TEST_ERR_IF( testFixtures( "Testing decoding from a buffer...", testDecodeBufferVerify ) != 0 );
+	TEST_ERR_IF( testFixtures( "Testing decoding into memory...", testDecodeIntoVerify ) != 0 );
+	TEST_ERR_IF( testFixtures( "Testing decoding to palette indexes...", testIndexedDecodeVerify ) != 0 );
 	TEST_ERR_IF( testRandomImages( "Testing 100 random \"simple\" square images...", 100, 1, 1, 1, 1, PINTO_MAX_WIDTH ) != 0 );
 	TEST_ERR_IF( testRandomImages( "Testing 100 random \"simple\" non-square images...", 100, 1, 1, 1, 0, PINTO_MAX_WIDTH ) != 0 );
 	TEST_ERR_IF( testRandomImages( "Testing 100000 random small images...", 100000, 3, 0, 0, 0, 32 ) != 0 );
@@ -77,6 +158,8 @@ int testEncodingDecoding()
 	/* CLEANUP */
 	cleanup:
 
+	pintoEncoderFree( &verifyEncoder );
+
 	return rc;
 }
 
@@ -279,6 +362,8 @@ static int testGoodFormats()
 
 	PintoImage *image = NULL;
 
+	PintoImageInfo info;
+
 	s32 i = 0;
 	char *formats[] =
 	{
@@ -298,12 +383,26 @@ static int testGoodFormats()
 		pintoImageFree( &image );
 		TEST_ERR_IF( pintoImageDecodeString( formats[ i ], &image ) != PINTO_RC_SUCCESS );
 
+		TEST_ERR_IF( pintoImageGetInfo( formats[ i ], strlen( formats[ i ] ), &info ) != PINTO_RC_SUCCESS );
+		TEST_ERR_IF( info.width != image->width );
+		TEST_ERR_IF( info.height != image->height );
+
 		printf( "." ); fflush( stdout );
 		i += 1;
 	}
 
 	printf( "\n" );
 
+	/* getting the info only reads the header */
+	TEST_ERR_IF( pintoImageGetInfo( "a4510;;1;", 9, &info ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( info.width != 4 || info.height != 5 || info.colorAmount != 1 );
+	TEST_ERR_IF( info.palette[ 0 ] != 0 || info.palette[ 1 ] != 255 || info.palette[ 2 ] != 255 );
+	pintoImageFree( &image );
+	TEST_ERR_IF( pintoImageDecodeString( "a4510;;1;", &image ) != PINTO_RC_ERROR_FORMAT_INVALID );
+
+	TEST_ERR_IF( pintoImageGetInfo( " 5", 2, &info ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( info.width != 256 || info.height != 256 || info.colorAmount != 1 );
+
 
 	/* CLEANUP */
 	cleanup:
@@ -466,11 +565,30 @@ static int testBadImages()
 	PintoImage *badHeapImage = NULL;
 
 	s32 i = 0;
+	s32 test = 0;
+	s32 color = 0;
+	s32 colorAmount = 0;
+
+	PintoEncodeOptions options;
+	PINTO_RC rcExpected = PINTO_RC_SUCCESS;
+
+	s32 encodedSize = 0;
+
+	PintoIndexedImage indexedImage;
+	u8 indexedPalette[ 64 * 3 ];
+	u8 indexedIndexes[ 64 ];
+
+	PintoEncoder *encoder = NULL;
+	PINTO_RC rcRows = PINTO_RC_SUCCESS;
+	const char *encodingRows = NULL;
+	s32 row = 0;
 
 
 	/* CODE */
 	printf( "  Testing bad images...\n" ); fflush( stdout );
 
+	TEST_ERR_IF( pintoEncoderInit( &encoder ) != PINTO_RC_SUCCESS );
+
 	/* test image width of 0 */
 	badStackImage.width = 0;
 	TEST_ERR_IF( pintoImageEncode( &badStackImage, &encoding ) != PINTO_RC_ERROR_IMAGE_BAD_SIZE );
@@ -526,12 +644,105 @@ static int testBadImages()
 	pintoImageFree( &badHeapImage );
 	printf( "." ); fflush( stdout );
 
+	/* test an index that isn't in the palette, and too many (64) colors, with
+	   a palette */
+	indexedImage.width = 8;
+	indexedImage.height = 8;
+	indexedImage.colorAmount = 64;
+	indexedImage.palette = indexedPalette;
+	indexedImage.indexes = indexedIndexes;
+	indexedImage.transparentIndex = 200;
+	for ( i = 0; i < 64; i += 1 )
+	{
+		indexedPalette[ i * 3 ] = (u8)( i * 4 );
+		indexedPalette[ ( i * 3 ) + 1 ] = 0;
+		indexedPalette[ ( i * 3 ) + 2 ] = 0;
+		indexedIndexes[ i ] = (u8) i;
+	}
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, NULL, &encoding ) != PINTO_RC_ERROR_IMAGE_TOO_MANY_COLORS );
+	indexedIndexes[ 5 ] = 64;
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, NULL, &encoding ) != PINTO_RC_ERROR_PRECOND );
+	/* the transparent index is fine past the palette */
+	memset( indexedIndexes, 200, 64 );
+	indexedIndexes[ 5 ] = 3;
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, NULL, &encoding ) != PINTO_RC_SUCCESS );
+	PINTO_HOOK_FREE( encoding );
+	encoding = NULL;
+	/* no palette is fine when every pixel is transparent */
+	indexedImage.width = 4;
+	indexedImage.height = 3;
+	indexedImage.colorAmount = 0;
+	indexedImage.palette = NULL;
+	memset( indexedIndexes, 200, 12 );
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, NULL, &encoding ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( strcmp( encoding, "a430" ) != 0 );
+	PINTO_HOOK_FREE( encoding );
+	encoding = NULL;
+	indexedIndexes[ 5 ] = 0;
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, NULL, &encoding ) != PINTO_RC_ERROR_PRECOND );
+	printf( "." ); fflush( stdout );
+
+	/* threads must give the same error as no threads, which is the error of
+	   the first bad pixel */
+	for ( test = 0; test < 1000; test += 1 )
+	{
+		TEST_ERR_IF( pintoImageInit( ( rand() % 32 ) + 1, ( rand() % 32 ) + 1, &badHeapImage ) != PINTO_RC_SUCCESS );
+
+		colorAmount = ( rand() % 40 ) + 40;
+		for ( i = 0; i < badHeapImage->width * badHeapImage->height; i += 1 )
+		{
+			color = rand() % colorAmount;
+			testImageAddRun( badHeapImage, i, 1, (u8)( ( color % 64 ) * 4 ), (u8)( ( color / 64 ) * 4 ), 0 );
+		}
+
+		if ( test % 2 == 0 )
+		{
+			badHeapImage->rgba[ ( ( rand() % ( badHeapImage->width * badHeapImage->height ) ) * 4 ) + 3 ] = 128;
+		}
+
+		pintoEncodeOptionsInit( &options );
+		rcExpected = pintoImageEncodeEx( badHeapImage, &options, &encoding );
+		PINTO_HOOK_FREE( encoding );
+		encoding = NULL;
+
+		TEST_ERR_IF( pintoImageEncodedSize( badHeapImage, &encodedSize ) != rcExpected );
+
+		options.threadCount = ( rand() % 8 ) + 2;
+		TEST_ERR_IF( pintoImageEncodeEx( badHeapImage, &options, &encoding ) != rcExpected );
+		PINTO_HOOK_FREE( encoding );
+		encoding = NULL;
+
+		/* adding rows must give the same error, at the row it's in */
+		options.threadCount = ( rand() % 4 ) + 1;
+		TEST_ERR_IF( pintoEncoderBegin( encoder, badHeapImage->width, badHeapImage->height, &options ) != PINTO_RC_SUCCESS );
+
+		rcRows = PINTO_RC_SUCCESS;
+		for ( row = 0; row < badHeapImage->height && rcRows == PINTO_RC_SUCCESS; row += 1 )
+		{
+			rcRows = pintoEncoderAddRows( encoder, badHeapImage->rgba + ( row * badHeapImage->width * 4 ), 1 );
+		}
+
+		if ( rcRows == PINTO_RC_SUCCESS )
+		{
+			rcRows = pintoEncoderFinish( encoder, &encodingRows );
+		}
+
+		TEST_ERR_IF( rcRows != rcExpected );
+
+		pintoImageFree( &badHeapImage );
+	}
+	printf( "." ); fflush( stdout );
+
 	printf( "\n" );
 
 
 	/* CLEANUP */
 	cleanup:
 
+	PINTO_HOOK_FREE( encoding );
+	pintoImageFree( &badHeapImage );
+	pintoEncoderFree( &encoder );
+
 	return rc;
 }
 
@@ -543,9 +754,11 @@ static int testGoodDeflate()
 
 	s32 test = 0;
 	s32 i = 0;
+	s32 j = 0;
 
 	PintoText *textIn = NULL;
 	PintoText *textOut = NULL;
+	const char *stringIn = NULL;
 	char *stringOut = NULL;
 
 	struct inOut {
@@ -796,6 +1009,31 @@ static int testGoodDeflate()
 	}
 	TEST_ERR_IF( textIn->string[ i ] != '\0' );
 
+	/* references that overlap what they add, one short and one longer than
+	   what's inflated at a time. the inflated text is allocated at its size. */
+	stringIn = "ab c?3a";
+	for ( j = 0; j < 2; j += 1 )
+	{
+		pintoTextFree( &textOut );
+		TEST_ERR_IF( pintoTextInit( &textOut ) != PINTO_RC_SUCCESS );
+
+		TEST_ERR_IF( pintoTextAddChars( textOut, stringIn, (s32) strlen( stringIn ) ) != PINTO_RC_SUCCESS );
+
+		pintoTextFree( &textIn );
+		TEST_ERR_IF( pintoSimpleInflate( &textOut, &textIn ) != PINTO_RC_SUCCESS );
+
+		TEST_ERR_IF( textIn->usedSize != 3 + ( j == 0 ? 10 : 4095 ) );
+		TEST_ERR_IF( textIn->allocedSize != textIn->usedSize + 1 );
+
+		for ( i = 0; i < textIn->usedSize; i += 1 )
+		{
+			TEST_ERR_IF( textIn->string[ i ] != "abc"[ i % 3 ] );
+		}
+		TEST_ERR_IF( textIn->string[ i ] != '\0' );
+
+		stringIn = "abc?3<;;";
+	}
+
 	printf( "\n" );
 
 
@@ -818,6 +1056,7 @@ static int testBadDeflate()
 	int rc = 0;
 
 	s32 i = 0;
+	s32 j = 0;
 
 	PintoText *textIn = NULL;
 	PintoText *textOut = NULL;
@@ -857,6 +1096,21 @@ static int testBadDeflate()
 
 	printf( "." );
 
+	/* references from before the start, from 0 back, or of 0 characters.
+	   the long ones mustn't be sized as if they were valid. */
+	for ( j = 0; j < 3; j += 1 )
+	{
+		stringIn = ( j == 0 ? "ab?3>;;;;" : ( j == 1 ? "ab?0>;;;;" : "ab?10" ) );
+
+		pintoTextFree( &textIn );
+		TEST_ERR_IF( pintoTextInit( &textIn ) != PINTO_RC_SUCCESS );
+		TEST_ERR_IF( pintoTextAddChars( textIn, stringIn, (s32) strlen( stringIn ) ) != PINTO_RC_SUCCESS );
+
+		TEST_ERR_IF( pintoSimpleInflate( &textIn, &textOut ) != PINTO_RC_ERROR_FORMAT_INVALID );
+	}
+
+	printf( "." );
+
 	printf( "\n" );
 
 
@@ -873,297 +1127,1974 @@ static int testBadDeflate()
 }
 
 /******************************************************************************/
-#define MARK \
-	image->rgba[ ( y1 * image->width * 4 ) + ( x1 * 4 )     ] = red; \
-	image->rgba[ ( y1 * image->width * 4 ) + ( x1 * 4 ) + 1 ] = green; \
-	image->rgba[ ( y1 * image->width * 4 ) + ( x1 * 4 ) + 2 ] = blue; \
-	image->rgba[ ( y1 * image->width * 4 ) + ( x1 * 4 ) + 3 ] = 255;
-
-static int testRandomImages(
-	char *description,
-	int numberOfImages,
-	int maxNumberOfColors,
-	int blackOnly,
-	int simpleSizes,
-	int square,
-	int maxSize )
+static int testDeflateChainDepth()
 {
 	/* DATA */
 	int rc = 0;
 
-	PintoImage *image = NULL;
-	PintoImage *imageDownsized = NULL;
-	s32 width = 0;
-	s32 height = 0;
-
+	s32 test = 0;
 	s32 i = 0;
-	s32 j = 0;
-	s32 k = 0;
+	s32 length = 0;
+	s32 alphabetSize = 0;
 
-	s32 colorAmount = 0;
+	s32 depthI = 0;
+	s32 depths[] = { 1, 2, 8, 64, PINTO_DEFLATE_CHAIN_DEPTH_MAX };
 
-	u8 red = 0;
-	u8 green = 0;
-	u8 blue = 0;
+	PintoText *textOriginal = NULL;
+	PintoText *textIn = NULL;
+	PintoText *textOut = NULL;
+	PintoText *textExpected = NULL;
 
-	s32 marksAmount = 0;
 
-	s32 markKind = 0;
+	/* CODE */
+	printf( "  Testing deflate chain depths...\n" ); fflush( stdout );
 
-	s32 x1 = 0;
-	s32 y1 = 0;
-	s32 x2 = 0;
-	s32 y2 = 0;
+	for ( test = 0; test < 200; test += 1 )
+	{
+		/* create a random string. small alphabets give lots of matches. */
+		pintoTextFree( &textOriginal );
+		TEST_ERR_IF( pintoTextInit( &textOriginal ) != PINTO_RC_SUCCESS );
 
-	s32 temp = 0;
+		length = rand() % ( test < 100 ? 300 : 20000 );
+		alphabetSize = ( rand() % 8 ) + 1;
 
-	char *string = NULL;
+		for ( i = 0; i < length; i += 1 )
+		{
+			/* repeat earlier parts of the string, so we get long matches */
+			if ( i > 100 && rand() % 50 == 0 )
+			{
+				TEST_ERR_IF( pintoTextAddChar( textOriginal, textOriginal->string[ rand() % i ] ) != PINTO_RC_SUCCESS );
+			}
+			else
+			{
+				TEST_ERR_IF( pintoTextAddChar( textOriginal, 'A' + ( rand() % alphabetSize ) ) != PINTO_RC_SUCCESS );
+			}
+		}
+
+		/* the hash chains at max depth must give the same result as comparing
+		   against every position in the window */
+		pintoTextFree( &textExpected );
+		TEST_ERR_IF( testDeflateReference( textOriginal, &textExpected ) != 0 );
+
+		for ( depthI = 0; depthI < (s32)( sizeof( depths ) / sizeof( depths[ 0 ] ) ); depthI += 1 )
+		{
+			/* copy original */
+			pintoTextFree( &textIn );
+			TEST_ERR_IF( pintoTextInit( &textIn ) != PINTO_RC_SUCCESS );
+			for ( i = 0; i < textOriginal->usedSize; i += 1 )
+			{
+				TEST_ERR_IF( pintoTextAddChar( textIn, textOriginal->string[ i ] ) != PINTO_RC_SUCCESS );
+			}
+
+			/* deflate */
+			TEST_ERR_IF( pintoSimpleDeflateDepth( &textIn, depths[ depthI ], &textOut ) != PINTO_RC_SUCCESS );
+
+			if ( depths[ depthI ] == PINTO_DEFLATE_CHAIN_DEPTH_MAX )
+			{
+				TEST_ERR_IF( strcmp( textOut->string, textExpected->string ) != 0 );
+			}
+
+			/* inflate and test against original string */
+			TEST_ERR_IF( pintoSimpleInflate( &textOut, &textIn ) != PINTO_RC_SUCCESS );
+			TEST_ERR_IF( strcmp( textIn->string, textOriginal->string ) != 0 );
+		}
+
+		if ( test % 10 == 0 ) { printf( "." ); fflush( stdout ); }
+	}
+
+	printf( "\n" );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoTextFree( &textOriginal );
+	pintoTextFree( &textIn );
+	pintoTextFree( &textOut );
+	pintoTextFree( &textExpected );
+
+	return rc;
+}
+
+/******************************************************************************/
+static int testDeflateOptimal()
+{
+	/* DATA */
+	int rc = 0;
+
+	s32 test = 0;
+	s32 i = 0;
+	s32 length = 0;
+	s32 alphabetSize = 0;
+
+	s32 greedyTotal = 0;
+	s32 optimalTotal = 0;
+
+	PintoText *textOriginal = NULL;
+	PintoText *textIn = NULL;
+	PintoText *textGreedy = NULL;
+	PintoText *textOptimal = NULL;
 
 
 	/* CODE */
-	printf( "  %s\n", description ); fflush( stdout );
+	printf( "  Testing optimal deflate...\n" ); fflush( stdout );
 
-	for ( i = 0; i < numberOfImages; i += 1 )
+	for ( test = 0; test < 200; test += 1 )
 	{
-		/* generate random size */
-		if ( simpleSizes )
+		/* create a random string. small alphabets give lots of matches. */
+		pintoTextFree( &textOriginal );
+		TEST_ERR_IF( pintoTextInit( &textOriginal ) != PINTO_RC_SUCCESS );
+
+		length = rand() % ( test < 100 ? 300 : 20000 );
+		alphabetSize = ( rand() % 8 ) + 1;
+
+		for ( i = 0; i < length; i += 1 )
 		{
-			width = ( (s32) 1 ) << ( ( rand() % 10 ) + 3 );
-			height = ( (s32) 1 ) << ( ( rand() % 10 ) + 3 );
+			/* repeat earlier parts of the string, so we get long matches */
+			if ( i > 100 && rand() % 50 == 0 )
+			{
+				TEST_ERR_IF( pintoTextAddChar( textOriginal, textOriginal->string[ rand() % i ] ) != PINTO_RC_SUCCESS );
+			}
+			else
+			{
+				TEST_ERR_IF( pintoTextAddChar( textOriginal, 'A' + ( rand() % alphabetSize ) ) != PINTO_RC_SUCCESS );
+			}
 		}
-		else
+
+		/* deflate greedily */
+		pintoTextFree( &textIn );
+		TEST_ERR_IF( pintoTextInit( &textIn ) != PINTO_RC_SUCCESS );
+		for ( i = 0; i < textOriginal->usedSize; i += 1 )
 		{
-			width  = ( rand() % maxSize ) + 1;
-			height = ( rand() % maxSize ) + 1;
+			TEST_ERR_IF( pintoTextAddChar( textIn, textOriginal->string[ i ] ) != PINTO_RC_SUCCESS );
 		}
 
-		if ( square )
+		pintoTextFree( &textGreedy );
+		TEST_ERR_IF( pintoSimpleDeflate( &textIn, &textGreedy ) != PINTO_RC_SUCCESS );
+
+		/* deflate optimally */
+		TEST_ERR_IF( pintoTextInit( &textIn ) != PINTO_RC_SUCCESS );
+		for ( i = 0; i < textOriginal->usedSize; i += 1 )
 		{
-			height = width;
+			TEST_ERR_IF( pintoTextAddChar( textIn, textOriginal->string[ i ] ) != PINTO_RC_SUCCESS );
 		}
 
-		/* initialize image */
-		TEST_ERR_IF( pintoImageInit( width, height, &image ) != PINTO_RC_SUCCESS );
+		pintoTextFree( &textOptimal );
+		TEST_ERR_IF( pintoSimpleDeflateOptimal( &textIn, &textOptimal ) != PINTO_RC_SUCCESS );
 
-		/* how many colors do we want? */
-		colorAmount = ( rand() % maxNumberOfColors ) + 1;
+		/* optimal can never be bigger */
+		TEST_ERR_IF( textOptimal->usedSize > textGreedy->usedSize );
 
-		/* foreach color */
-		for ( j = 0; j < colorAmount; j += 1 )
+		greedyTotal += textGreedy->usedSize;
+		optimalTotal += textOptimal->usedSize;
+
+		/* inflate and test against original string */
+		TEST_ERR_IF( pintoSimpleInflate( &textOptimal, &textIn ) != PINTO_RC_SUCCESS );
+		TEST_ERR_IF( strcmp( textIn->string, textOriginal->string ) != 0 );
+
+		if ( test % 10 == 0 ) { printf( "." ); fflush( stdout ); }
+	}
+
+	/* and it should actually be better */
+	TEST_ERR_IF( optimalTotal >= greedyTotal );
+
+	printf( "\n" );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoTextFree( &textOriginal );
+	pintoTextFree( &textIn );
+	pintoTextFree( &textGreedy );
+	pintoTextFree( &textOptimal );
+
+	return rc;
+}
+
+/******************************************************************************/
+static int testDeflateParallel()
+{
+	/* DATA */
+	int rc = 0;
+
+	s32 test = 0;
+	s32 i = 0;
+	s32 length = 0;
+	s32 alphabetSize = 0;
+	s32 depth = 0;
+
+	PintoText *textOriginal = NULL;
+	PintoText *textIn = NULL;
+	PintoText *textSerial = NULL;
+	PintoText *textParallel = NULL;
+
+
+	/* CODE */
+	printf( "  Testing parallel deflate...\n" ); fflush( stdout );
+
+	for ( test = 0; test < 100; test += 1 )
+	{
+		/* create a random string, big enough to be split */
+		pintoTextFree( &textOriginal );
+		TEST_ERR_IF( pintoTextInit( &textOriginal ) != PINTO_RC_SUCCESS );
+
+		length = rand() % 300000;
+		alphabetSize = ( rand() % 8 ) + 1;
+
+		for ( i = 0; i < length; i += 1 )
 		{
-			/* generate color */
-			/* we don't care if it ends up being the same color as a previous
-			   color */
-			if ( blackOnly == 1 )
+			/* repeat earlier parts of the string, so we get long matches */
+			if ( i > 100 && rand() % 50 == 0 )
 			{
-				red   = 0;
-				green = 0;
-				blue  = 0;
+				TEST_ERR_IF( pintoTextAddChar( textOriginal, textOriginal->string[ rand() % i ] ) != PINTO_RC_SUCCESS );
+			}
+			/* and sometimes very long ones */
+			else if ( i > 10000 && rand() % 5000 == 0 )
+			{
+				TEST_ERR_IF( pintoTextAddChar( textOriginal, textOriginal->string[ i - 1 ] ) != PINTO_RC_SUCCESS );
+				while ( i < length && rand() % 5000 != 0 )
+				{
+					i += 1;
+					TEST_ERR_IF( pintoTextAddChar( textOriginal, textOriginal->string[ i - 1 ] ) != PINTO_RC_SUCCESS );
+				}
 			}
 			else
 			{
-				red   = rand() % 256;
-				green = rand() % 256;
-				blue  = rand() % 256;
+				TEST_ERR_IF( pintoTextAddChar( textOriginal, 'A' + ( rand() % alphabetSize ) ) != PINTO_RC_SUCCESS );
 			}
+		}
 
-			/* how many marks are we going to make */
-			marksAmount = ( rand() % 100 ) + 1;
+		/* deflate serially */
+		pintoTextFree( &textIn );
+		TEST_ERR_IF( pintoTextInit( &textIn ) != PINTO_RC_SUCCESS );
+		TEST_ERR_IF( pintoTextAddText( textIn, textOriginal ) != PINTO_RC_SUCCESS );
 
-			/* foreach mark */
-			for ( k = 0; k < marksAmount; k += 1 )
-			{
-				/* what kind of mark are we going to make? */
-				markKind = rand() % 4;
+		depth = ( test % 2 == 0 ? PINTO_DEFLATE_CHAIN_DEPTH_MAX : PINTO_DEFLATE_CHAIN_DEPTH_FAST );
 
-				/* single dot */
-				if ( markKind == 0 )
-				{
-					x1 = ( rand() % image->width );
-					y1 = ( rand() % image->height );
+		pintoTextFree( &textSerial );
+		TEST_ERR_IF( pintoSimpleDeflateDepth( &textIn, depth, &textSerial ) != PINTO_RC_SUCCESS );
 
-					MARK;
-				}
-				/* vertical line */
-				else if ( markKind == 1 )
-				{
-					x1 = ( rand() % image->width );
-					y1 = ( rand() % image->height );
-					y2 = ( rand() % image->height );
+		/* deflate in parallel, which must be the same */
+		TEST_ERR_IF( pintoTextInit( &textIn ) != PINTO_RC_SUCCESS );
+		TEST_ERR_IF( pintoTextAddText( textIn, textOriginal ) != PINTO_RC_SUCCESS );
 
-					if ( y2 < y1 )
-					{
-						/* swap y2 and y1 */
-						y2 = temp; y2 = y1; y1 = temp;
-					}
+		pintoTextFree( &textParallel );
+		TEST_ERR_IF( pintoSimpleDeflateParallel( &textIn, depth, ( rand() % 16 ) + 1, &textParallel ) != PINTO_RC_SUCCESS );
 
-					for ( ; y1 < y2; y1 += 1 )
-					{
-						MARK;
-					}
-				}
-				/* horizontal line */
-				else if ( markKind == 1 )
-				{
-					x1 = ( rand() % image->width );
-					x2 = ( rand() % image->width );
-					y1 = ( rand() % image->height );
+		TEST_ERR_IF( strcmp( textSerial->string, textParallel->string ) != 0 );
 
-					if ( x2 < x1 )
-					{
-						/* swap x2 and x1 */
-						x2 = temp; x2 = x1; x1 = temp;
-					}
+		if ( test % 5 == 0 ) { printf( "." ); fflush( stdout ); }
+	}
 
-					for ( ; x1 < x2; x1 += 1 )
-					{
-						MARK;
-					}
-				}
-				/* rectangle */
-				else if ( markKind == 1 )
-				{
-					x1 = ( rand() % image->width );
-					x2 = ( rand() % image->width );
-					y1 = ( rand() % image->height );
-					y2 = ( rand() % image->height );
+	printf( "\n" );
 
-					if ( x2 < x1 )
-					{
-						/* swap x2 and x1 */
-						x2 = temp; x2 = x1; x1 = temp;
-					}
 
-					if ( y2 < y1 )
-					{
-						/* swap y2 and y1 */
-						y2 = temp; y2 = y1; y1 = temp;
-					}
+	/* CLEANUP */
+	cleanup:
 
-					for ( ; x1 < x2; x1 += 1 )
-					{
-						temp = y1;
-						for ( ; y1 < y2; y1 += 1 )
-						{
-							MARK;
-						}
-						y1 = temp;
-					}
-				}
-			}
-		}
+	pintoTextFree( &textOriginal );
+	pintoTextFree( &textIn );
+	pintoTextFree( &textSerial );
+	pintoTextFree( &textParallel );
 
-		/* verify image */
-		TEST_ERR_IF( testImageVerify( image ) != 0 );
+	return rc;
+}
 
-		/* downsize image
-		   No good way to test the result, but we can make sure it doesnt have
-		   memory errors or leaks */
-		if ( image->width >= 2 && image->height >= 2 )
+/******************************************************************************/
+static int testRleColors()
+{
+	/* DATA */
+	int rc = 0;
+
+	s32 test = 0;
+	s32 i = 0;
+	s32 color = 0;
+	s32 colorAmount = 0;
+	s32 colorStart = 0;
+	s32 colorEnd = 0;
+	s32 pixelAmount = 0;
+	s32 runLength = 0;
+
+	char *indexedData = NULL;
+
+	PintoText *colorTexts[ PINTO_MAX_COLORS ];
+	PintoText *textExpected = NULL;
+
+
+	/* CODE */
+	printf( "  Testing RLE colors...\n" ); fflush( stdout );
+
+	for ( color = 0; color < PINTO_MAX_COLORS; color += 1 )
+	{
+		colorTexts[ color ] = NULL;
+	}
+
+	for ( test = 0; test < 1000; test += 1 )
+	{
+		/* create random indexed data, with runs of the same color */
+		pixelAmount = ( rand() % 5000 ) + 1;
+		colorAmount = ( rand() % PINTO_MAX_COLORS ) + 1;
+
+		PINTO_HOOK_FREE( indexedData );
+		indexedData = (char *) PINTO_HOOK_MALLOC( pixelAmount );
+		TEST_ERR_IF( indexedData == NULL );
+
+		i = 0;
+		while ( i < pixelAmount )
 		{
-			TEST_ERR_IF( pintoImageDownsize( image, &imageDownsized ) != PINTO_RC_SUCCESS );
+			/* -1 is transparent */
+			color = ( rand() % ( colorAmount + 1 ) ) - 1;
+
+			runLength = ( rand() % 10 ) + 1;
+			while ( runLength > 0 && i < pixelAmount )
+			{
+				indexedData[ i ] = (char) color;
+				i += 1;
+				runLength -= 1;
+			}
 		}
- 
-		/* free */
-		PINTO_HOOK_FREE( string );
-		string = NULL;
 
-		pintoImageFree( &image );
-		pintoImageFree( &imageDownsized );
+		/* pick a range of colors, sometimes all of them */
+		colorStart = 0;
+		colorEnd = colorAmount;
+		if ( test % 2 == 1 )
+		{
+			colorStart = rand() % colorAmount;
+			colorEnd = colorStart + ( rand() % ( colorAmount - colorStart ) ) + 1;
+		}
 
-		/* *** */
-		if ( i + 1 <= 100 )
+		for ( color = colorStart; color < colorEnd; color += 1 )
 		{
-			printf( "\r%3d", i + 1 ); fflush( stdout );
+			TEST_ERR_IF( pintoTextInit( &colorTexts[ color ] ) != PINTO_RC_SUCCESS );
 		}
-		else if ( ( i + 1 ) % 100 == 0 )
+
+		TEST_ERR_IF( pintoRleEncodeColors( indexedData, pixelAmount, colorStart, colorEnd, colorTexts ) != PINTO_RC_SUCCESS );
+
+		/* each color must be the same as doing it one color at a time */
+		for ( color = colorStart; color < colorEnd; color += 1 )
 		{
-			printf( "\r%3d", i + 1 ); fflush( stdout );
+			TEST_ERR_IF( pintoTextInit( &textExpected ) != PINTO_RC_SUCCESS );
+			TEST_ERR_IF( testRleReference( indexedData, pixelAmount, color, textExpected ) != 0 );
+
+			TEST_ERR_IF( strcmp( colorTexts[ color ]->string, textExpected->string ) != 0 );
+
+			pintoTextFree( &textExpected );
+			pintoTextFree( &colorTexts[ color ] );
 		}
-	}
 
+		if ( test % 50 == 0 ) { printf( "." ); fflush( stdout ); }
+	}
 
-	printf( "\n" ); fflush( stdout );
+	printf( "\n" );
 
 
 	/* CLEANUP */
 	cleanup:
 
+	PINTO_HOOK_FREE( indexedData );
+
+	for ( color = 0; color < PINTO_MAX_COLORS; color += 1 )
+	{
+		pintoTextFree( &colorTexts[ color ] );
+	}
+
+	pintoTextFree( &textExpected );
+
 	return rc;
 }
 
 /******************************************************************************/
-static int testImageVerify( PintoImage *image )
+static int testReorderColors()
 {
 	/* DATA */
 	int rc = 0;
 
+	PintoImage *image = NULL;
+	PintoImage *imageOut = NULL;
+
 	char *encoding = NULL;
+	char *encodingReordered = NULL;
 
-	PintoImage *imageOut = NULL;
+	PintoEncodeOptions options;
 
 	s32 i = 0;
 
-	u8 red = 0;
-	u8 green = 0;
-	u8 blue = 0;
-
 
 	/* CODE */
+	printf( "  Testing reordering colors...\n" ); fflush( stdout );
+
+	/* a white background with red and blue dots. blue and red appear first,
+	   so by default white is painted last and needs a run between every
+	   dot. it's better to paint white first, and blue last. */
+	TEST_ERR_IF( pintoImageInit( 64, 64, &image ) != PINTO_RC_SUCCESS );
+
+	testImageAddRun( image, 0, 64 * 64, 255, 255, 255 );
+
+	for ( i = 0; i < 200; i += 1 )
+	{
+		testImageAddRun( image, rand() % ( 64 * 64 ), 1, 255, 0, 0 );
+	}
+
+	for ( i = 0; i < 80; i += 1 )
+	{
+		testImageAddRun( image, rand() % ( 64 * 64 ), 1, 0, 0, 255 );
+	}
+
+	testImageAddRun( image, 0, 1, 0, 0, 255 );
+	testImageAddRun( image, 1, 1, 255, 0, 0 );
 
-	/* encode imageIn */
 	TEST_ERR_IF( pintoImageEncode( image, &encoding ) != PINTO_RC_SUCCESS );
 
-	/* decode what we just encoded to imageOut */
-	TEST_ERR_IF( pintoImageDecodeString( encoding, &imageOut ) != PINTO_RC_SUCCESS );
+	pintoEncodeOptionsInit( &options );
+	options.reorderColors = 1;
 
-	/* verify widths and heights */
-	TEST_ERR_IF( image->width != imageOut->width );
-	TEST_ERR_IF( image->height != imageOut->height );
+	TEST_ERR_IF( pintoImageEncodeEx( image, &options, &encodingReordered ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( strlen( encodingReordered ) >= strlen( encoding ) );
 
-	/* verify image data.
-	   NOTE: can't just use memcmp because if the image has 0 transparency, it may
-	         still have values for it's red, green, or blue. On decoding, we make
-	         all fully transparent pixels have 0 for red, green, and blue */
-	for ( i = 0; i < (image->width * image->height * 4); i += 4 )
+	TEST_ERR_IF( pintoImageDecodeString( encodingReordered, &imageOut ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( memcmp( image->rgba, imageOut->rgba, 64 * 64 * 4 ) != 0 );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( encoding );
+	PINTO_HOOK_FREE( encodingReordered );
+
+	pintoImageFree( &image );
+	pintoImageFree( &imageOut );
+
+	return rc;
+}
+
+/******************************************************************************/
+static s32 testSinkWrite( void *userData, const char *data, s32 size )
+{
+	/* DATA */
+	TestSink *sink = (TestSink *) userData;
+
+
+	/* CODE */
+	if ( sink->writesBeforeFailing == 0 )
 	{
-		if ( image->rgba[ i + 3 ] == 0 )
-		{
-			TEST_ERR_IF( imageOut->rgba[ i + 3 ] != 0 );
+		return 1;
+	}
+	sink->writesBeforeFailing -= 1;
 
-			TEST_ERR_IF( imageOut->rgba[ i     ] != 0 );
-			TEST_ERR_IF( imageOut->rgba[ i + 1 ] != 0 );
-			TEST_ERR_IF( imageOut->rgba[ i + 2 ] != 0 );
-		}
-		else
-		{
-			/* make sure it's fully opaque */
-			TEST_ERR_IF( imageOut->rgba[ i + 3 ] != 255 );
+	/* pieces must be small, and never empty */
+	if ( size <= 0 || size > PINTO_TEXT_SINK_SIZE || sink->usedSize + size > sink->bufferSize )
+	{
+		return 1;
+	}
 
-			/* compare red, green, and blue */
-			red   = image->rgba[ i     ];
-			green = image->rgba[ i + 1 ];
-			blue  = image->rgba[ i + 2 ];
+	memcpy( sink->buffer + sink->usedSize, data, size );
+	sink->usedSize += size;
 
-			red   = PINTO_8_BITS_TO_6_BITS( red   );
-			green = PINTO_8_BITS_TO_6_BITS( green );
-			blue  = PINTO_8_BITS_TO_6_BITS( blue  );
+	return 0;
+}
 
-			TEST_ERR_IF( imageOut->rgba[ i     ] != red );
-			TEST_ERR_IF( imageOut->rgba[ i + 1 ] != green );
-			TEST_ERR_IF( imageOut->rgba[ i + 2 ] != blue );
-		}
+/******************************************************************************/
+static int testEncodeToSink()
+{
+	/* DATA */
+	int rc = 0;
+
+	PintoImage *image = NULL;
+	char *encoding = NULL;
+	char *fileEncoding = NULL;
+
+	FILE *file = NULL;
+	s32 fileSize = 0;
+
+	TestSink sink;
+
+	s32 i = 0;
+
+
+	/* CODE */
+	printf( "  Testing encoding to a sink...\n" ); fflush( stdout );
+
+	sink.buffer = NULL;
+
+	/* an image whose encoding takes many pieces */
+	TEST_ERR_IF( pintoImageInit( 512, 512, &image ) != PINTO_RC_SUCCESS );
+
+	for ( i = 0; i < 512 * 512; i += ( rand() % 20 ) + 1 )
+	{
+		testImageAddRun( image, i, 1, (u8)( ( rand() % 8 ) * 32 ), 0, 0 );
+	}
+
+	TEST_ERR_IF( pintoImageEncode( image, &encoding ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( strlen( encoding ) <= PINTO_TEXT_SINK_SIZE * 4 );
+
+	/* write to a file */
+	file = tmpfile();
+	TEST_ERR_IF( file == NULL );
+
+	TEST_ERR_IF( pintoImageEncodeToSink( image, NULL, pintoFileWrite, file ) != PINTO_RC_SUCCESS );
+
+	fileSize = (s32) ftell( file );
+	TEST_ERR_IF( fileSize != (s32) strlen( encoding ) );
+
+	fileEncoding = (char *) PINTO_HOOK_MALLOC( fileSize + 1 );
+	TEST_ERR_IF( fileEncoding == NULL );
+
+	rewind( file );
+	TEST_ERR_IF( fread( fileEncoding, 1, fileSize, file ) != (size_t) fileSize );
+	fileEncoding[ fileSize ] = '\0';
+
+	TEST_ERR_IF( strcmp( fileEncoding, encoding ) != 0 );
+
+	/* a sink that fails stops the encoding */
+	sink.bufferSize = fileSize;
+	sink.buffer = (char *) PINTO_HOOK_MALLOC( sink.bufferSize );
+	TEST_ERR_IF( sink.buffer == NULL );
+
+	for ( i = 0; i < 3; i += 1 )
+	{
+		sink.usedSize = 0;
+		sink.writesBeforeFailing = i;
+
+		TEST_ERR_IF( pintoImageEncodeToSink( image, NULL, testSinkWrite, &sink ) != PINTO_RC_ERROR_WRITE_FAILED );
 	}
 
 
 	/* CLEANUP */
 	cleanup:
 
+	if ( file != NULL )
+	{
+		fclose( file );
+	}
+
 	PINTO_HOOK_FREE( encoding );
-	encoding = NULL;
+	PINTO_HOOK_FREE( fileEncoding );
+	PINTO_HOOK_FREE( sink.buffer );
 
-	pintoImageFree( &imageOut );
+	pintoImageFree( &image );
 
 	return rc;
 }
 
+/******************************************************************************/
+/* Creates the RLE data for one color, with a pass over every pixel. */
+static int testRleReference( const char *indexedData, s32 pixelAmount, s32 color, PintoText *text )
+{
+	/* DATA */
+	int rc = 0;
+
+	s32 pixel = 0;
+
+	char rleState = 0;
+	s32 rleCount = 0;
+
+
+	/* CODE */
+	for ( pixel = 0; pixel < pixelAmount; pixel += 1 )
+	{
+		/* if off */
+		if ( rleState == 0 )
+		{
+			if ( color == indexedData[ pixel ] )
+			{
+				TEST_ERR_IF( pintoTextAddValue( text, rleCount ) != PINTO_RC_SUCCESS );
+
+				rleState = 1;
+				rleCount = 1;
+			}
+			else
+			{
+				rleCount += 1;
+			}
+		}
+		/* else, on */
+		else
+		{
+			if ( indexedData[ pixel ] >= color )
+			{
+				rleCount += 1;
+			}
+			else
+			{
+				TEST_ERR_IF( pintoTextAddValue( text, rleCount ) != PINTO_RC_SUCCESS );
+
+				rleState = 0;
+				rleCount = 1;
+			}
+		}
+	}
+
+	TEST_ERR_IF( pintoTextAddChar( text, '^' ) != PINTO_RC_SUCCESS );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+/* Deflates by comparing against every position in the window. This is slow,
+   but obviously correct, so we test the real deflate against it. */
+static int testDeflateReference( PintoText *textIn, PintoText **textOut_A )
+{
+	/* DATA */
+	int rc = 0;
+
+	PintoText *textOut = NULL;
+	char *string = textIn->string;
+
+	s32 i = 0;
+	s32 matchI = 0;
+	s32 matchLength = 0;
+	s32 bestMatchLength = 0;
+	s32 bestMatchDistance = 0;
+
+
+	/* CODE */
+	TEST_ERR_IF( pintoTextInit( &textOut ) != PINTO_RC_SUCCESS );
+
+	while ( i < textIn->usedSize )
+	{
+		bestMatchLength = 0;
+		bestMatchDistance = 0;
+
+		for ( matchI = i - 1; i <= textIn->usedSize - 4 && matchI >= 0 && ( i - matchI ) < ( 64 * 64 ); matchI -= 1 )
+		{
+			matchLength = 0;
+			while ( i + matchLength < textIn->usedSize && string[ matchI + matchLength ] == string[ i + matchLength ] )
+			{
+				matchLength += 1;
+			}
+
+			if ( matchLength >= 4 && matchLength > bestMatchLength )
+			{
+				bestMatchLength = matchLength;
+				bestMatchDistance = i - matchI;
+			}
+		}
+
+		if ( bestMatchLength == 0 || ( bestMatchLength == 4 && bestMatchDistance >= 64 ) )
+		{
+			TEST_ERR_IF( pintoTextAddChar( textOut, string[ i ] ) != PINTO_RC_SUCCESS );
+			i += 1;
+		}
+		else
+		{
+			if ( bestMatchDistance < 64 )
+			{
+				TEST_ERR_IF( pintoTextAddChar( textOut, '?' ) != PINTO_RC_SUCCESS );
+				TEST_ERR_IF( pintoTextAddValue( textOut, bestMatchDistance ) != PINTO_RC_SUCCESS );
+			}
+			else
+			{
+				TEST_ERR_IF( pintoTextAddChar( textOut, '@' ) != PINTO_RC_SUCCESS );
+				TEST_ERR_IF( pintoTextAddValue( textOut, bestMatchDistance / 64 ) != PINTO_RC_SUCCESS );
+				TEST_ERR_IF( pintoTextAddValue( textOut, bestMatchDistance % 64 ) != PINTO_RC_SUCCESS );
+			}
+			TEST_ERR_IF( pintoTextAddValue( textOut, bestMatchLength ) != PINTO_RC_SUCCESS );
+			i += bestMatchLength;
+		}
+	}
+
+	/* give back */
+	(*textOut_A) = textOut;
+	textOut = NULL;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoTextFree( &textOut );
+
+	return rc;
+}
+
+/******************************************************************************/
+#define MARK \
+	image->rgba[ ( y1 * image->width * 4 ) + ( x1 * 4 )     ] = red; \
+	image->rgba[ ( y1 * image->width * 4 ) + ( x1 * 4 ) + 1 ] = green; \
+	image->rgba[ ( y1 * image->width * 4 ) + ( x1 * 4 ) + 2 ] = blue; \
+	image->rgba[ ( y1 * image->width * 4 ) + ( x1 * 4 ) + 3 ] = 255;
+
+static int testRandomImages(
+	char *description,
+	int numberOfImages,
+	int maxNumberOfColors,
+	int blackOnly,
+	int simpleSizes,
+	int square,
+	int maxSize )
+{
+	/* DATA */
+	int rc = 0;
+
+	PintoImage *image = NULL;
+	PintoImage *imageDownsized = NULL;
+	s32 width = 0;
+	s32 height = 0;
+
+	s32 i = 0;
+	s32 j = 0;
+	s32 k = 0;
+
+	s32 colorAmount = 0;
+
+	u8 red = 0;
+	u8 green = 0;
+	u8 blue = 0;
+
+	s32 marksAmount = 0;
+
+	s32 markKind = 0;
+
+	s32 x1 = 0;
+	s32 y1 = 0;
+	s32 x2 = 0;
+	s32 y2 = 0;
+
+	s32 temp = 0;
+
+	char *string = NULL;
+
+
+	/* CODE */
+	printf( "  %s\n", description ); fflush( stdout );
+
+	for ( i = 0; i < numberOfImages; i += 1 )
+	{
+		/* generate random size */
+		if ( simpleSizes )
+		{
+			width = ( (s32) 1 ) << ( ( rand() % 10 ) + 3 );
+			height = ( (s32) 1 ) << ( ( rand() % 10 ) + 3 );
+		}
+		else
+		{
+			width  = ( rand() % maxSize ) + 1;
+			height = ( rand() % maxSize ) + 1;
+		}
+
+		if ( square )
+		{
+			height = width;
+		}
+
+		/* initialize image */
+		TEST_ERR_IF( pintoImageInit( width, height, &image ) != PINTO_RC_SUCCESS );
+
+		/* how many colors do we want? */
+		colorAmount = ( rand() % maxNumberOfColors ) + 1;
+
+		/* foreach color */
+		for ( j = 0; j < colorAmount; j += 1 )
+		{
+			/* generate color */
+			/* we don't care if it ends up being the same color as a previous
+			   color */
+			if ( blackOnly == 1 )
+			{
+				red   = 0;
+				green = 0;
+				blue  = 0;
+			}
+			else
+			{
+				red   = rand() % 256;
+				green = rand() % 256;
+				blue  = rand() % 256;
+			}
+
+			/* how many marks are we going to make */
+			marksAmount = ( rand() % 100 ) + 1;
+
+			/* foreach mark */
+			for ( k = 0; k < marksAmount; k += 1 )
+			{
+				/* what kind of mark are we going to make? */
+				markKind = rand() % 4;
+
+				/* single dot */
+				if ( markKind == 0 )
+				{
+					x1 = ( rand() % image->width );
+					y1 = ( rand() % image->height );
+
+					MARK;
+				}
+				/* vertical line */
+				else if ( markKind == 1 )
+				{
+					x1 = ( rand() % image->width );
+					y1 = ( rand() % image->height );
+					y2 = ( rand() % image->height );
+
+					if ( y2 < y1 )
+					{
+						/* swap y2 and y1 */
+						y2 = temp; y2 = y1; y1 = temp;
+					}
+
+					for ( ; y1 < y2; y1 += 1 )
+					{
+						MARK;
+					}
+				}
+				/* horizontal line */
+				else if ( markKind == 1 )
+				{
+					x1 = ( rand() % image->width );
+					x2 = ( rand() % image->width );
+					y1 = ( rand() % image->height );
+
+					if ( x2 < x1 )
+					{
+						/* swap x2 and x1 */
+						x2 = temp; x2 = x1; x1 = temp;
+					}
+
+					for ( ; x1 < x2; x1 += 1 )
+					{
+						MARK;
+					}
+				}
+				/* rectangle */
+				else if ( markKind == 1 )
+				{
+					x1 = ( rand() % image->width );
+					x2 = ( rand() % image->width );
+					y1 = ( rand() % image->height );
+					y2 = ( rand() % image->height );
+
+					if ( x2 < x1 )
+					{
+						/* swap x2 and x1 */
+						x2 = temp; x2 = x1; x1 = temp;
+					}
+
+					if ( y2 < y1 )
+					{
+						/* swap y2 and y1 */
+						y2 = temp; y2 = y1; y1 = temp;
+					}
+
+					for ( ; x1 < x2; x1 += 1 )
+					{
+						temp = y1;
+						for ( ; y1 < y2; y1 += 1 )
+						{
+							MARK;
+						}
+						y1 = temp;
+					}
+				}
+			}
+		}
+
+		/* verify image */
+		TEST_ERR_IF( testImageVerify( image ) != 0 );
+
+		/* every other way to encode and decode it must agree. that's slow,
+		   so only a sample of the images are checked. */
+		if ( i % 100 == 0 )
+		{
+			TEST_ERR_IF( testImageVerifyAll( image ) != 0 );
+		}
+
+		/* downsize image
+		   No good way to test the result, but we can make sure it doesnt have
+		   memory errors or leaks */
+		if ( image->width >= 2 && image->height >= 2 )
+		{
+			TEST_ERR_IF( pintoImageDownsize( image, &imageDownsized ) != PINTO_RC_SUCCESS );
+		}
+ 
+		/* free */
+		PINTO_HOOK_FREE( string );
+		string = NULL;
+
+		pintoImageFree( &image );
+		pintoImageFree( &imageDownsized );
+
+		/* *** */
+		if ( i + 1 <= 100 )
+		{
+			printf( "\r%3d", i + 1 ); fflush( stdout );
+		}
+		else if ( ( i + 1 ) % 100 == 0 )
+		{
+			printf( "\r%3d", i + 1 ); fflush( stdout );
+		}
+	}
+
+
+	printf( "\n" ); fflush( stdout );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+static int testImageVerify( PintoImage *image )
+{
+	/* DATA */
+	int rc = 0;
+
+	char *encoding = NULL;
+
+	PintoImage *imageOut = NULL;
+
+	s32 i = 0;
+
+	u8 red = 0;
+	u8 green = 0;
+	u8 blue = 0;
+
+
+	/* CODE */
+
+	/* encode imageIn */
+	TEST_ERR_IF( pintoImageEncode( image, &encoding ) != PINTO_RC_SUCCESS );
+
+	/* decode what we just encoded to imageOut */
+	TEST_ERR_IF( pintoImageDecodeString( encoding, &imageOut ) != PINTO_RC_SUCCESS );
+
+	/* verify widths and heights */
+	TEST_ERR_IF( image->width != imageOut->width );
+	TEST_ERR_IF( image->height != imageOut->height );
+
+	/* verify image data.
+	   NOTE: can't just use memcmp because if the image has 0 transparency, it may
+	         still have values for it's red, green, or blue. On decoding, we make
+	         all fully transparent pixels have 0 for red, green, and blue */
+	for ( i = 0; i < (image->width * image->height * 4); i += 4 )
+	{
+		if ( image->rgba[ i + 3 ] == 0 )
+		{
+			TEST_ERR_IF( imageOut->rgba[ i + 3 ] != 0 );
+
+			TEST_ERR_IF( imageOut->rgba[ i     ] != 0 );
+			TEST_ERR_IF( imageOut->rgba[ i + 1 ] != 0 );
+			TEST_ERR_IF( imageOut->rgba[ i + 2 ] != 0 );
+		}
+		else
+		{
+			/* make sure it's fully opaque */
+			TEST_ERR_IF( imageOut->rgba[ i + 3 ] != 255 );
+
+			/* compare red, green, and blue */
+			red   = image->rgba[ i     ];
+			green = image->rgba[ i + 1 ];
+			blue  = image->rgba[ i + 2 ];
+
+			red   = PINTO_8_BITS_TO_6_BITS( red   );
+			green = PINTO_8_BITS_TO_6_BITS( green );
+			blue  = PINTO_8_BITS_TO_6_BITS( blue  );
+
+			TEST_ERR_IF( imageOut->rgba[ i     ] != red );
+			TEST_ERR_IF( imageOut->rgba[ i + 1 ] != green );
+			TEST_ERR_IF( imageOut->rgba[ i + 2 ] != blue );
+		}
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( encoding );
+	encoding = NULL;
+
+	pintoImageFree( &imageOut );
+
+	return rc;
+}
+
+/******************************************************************************/
+static int testImageVerifyAll( const PintoImage *image )
+{
+	/* DATA */
+	int rc = 0;
+
+	s32 i = 0;
+
+
+	/* CODE */
+	for ( i = 0; verifyFuncs[ i ] != NULL; i += 1 )
+	{
+		TEST_ERR_IF( testImageVerifyWith( image, verifyFuncs[ i ] ) != 0 );
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+static int testImageVerifyWith( const PintoImage *image, TestVerifyFunc verify )
+{
+	/* DATA */
+	int rc = 0;
+
+	char *encoding = NULL;
+
+	PintoImage *imageOut = NULL;
+
+
+	/* CODE */
+	TEST_ERR_IF( pintoImageEncode( image, &encoding ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( pintoImageDecodeString( encoding, &imageOut ) != PINTO_RC_SUCCESS );
+
+	TEST_ERR_IF( verify( image, encoding, imageOut ) != 0 );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( encoding );
+
+	pintoImageFree( &imageOut );
+
+	return rc;
+}
+
+/******************************************************************************/
+static int testEncodeIntoVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut )
+{
+	/* DATA */
+	int rc = 0;
+
+	char *encodingInto = NULL;
+
+	s32 encodedSize = 0;
+	s32 usedSize = 0;
+	s32 length = 0;
+
+
+	/* CODE */
+	(void)imageOut;
+
+	length = (s32) strlen( encoding );
+
+	/* no encoding can be bigger than the encoded size */
+	TEST_ERR_IF( pintoImageEncodedSize( image, &encodedSize ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( length > encodedSize );
+
+	/* encoding into a buffer must be the same, and only fit if it's big
+	   enough */
+	encodingInto = (char *) PINTO_HOOK_MALLOC( encodedSize + 1 );
+	TEST_ERR_IF( encodingInto == NULL );
+
+	TEST_ERR_IF( pintoImageEncodeInto( image, NULL, encodingInto, encodedSize + 1, &usedSize ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( usedSize != length );
+	TEST_ERR_IF( strcmp( encodingInto, encoding ) != 0 );
+
+	/* an exact fit has no '\0' */
+	memset( encodingInto, 'x', encodedSize + 1 );
+	TEST_ERR_IF( pintoEncoderEncodeInto( verifyEncoder, image, NULL, encodingInto, length, &usedSize ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( usedSize != length );
+	TEST_ERR_IF( memcmp( encodingInto, encoding, length ) != 0 );
+	TEST_ERR_IF( encodingInto[ length ] != 'x' );
+
+	/* too small still gives the size it needs, and the buffer has the start
+	   of the encoding */
+	memset( encodingInto, 'x', encodedSize + 1 );
+	TEST_ERR_IF( pintoImageEncodeInto( image, NULL, encodingInto, length - 1, &usedSize ) != PINTO_RC_ERROR_BUFFER_TOO_SMALL );
+	TEST_ERR_IF( usedSize != length );
+	TEST_ERR_IF( memcmp( encodingInto, encoding, length - 1 ) != 0 );
+	TEST_ERR_IF( encodingInto[ length - 1 ] != 'x' );
+
+	memset( encodingInto, 'x', encodedSize + 1 );
+	TEST_ERR_IF( pintoImageEncodeInto( image, NULL, encodingInto, 0, &usedSize ) != PINTO_RC_ERROR_BUFFER_TOO_SMALL );
+	TEST_ERR_IF( usedSize != length );
+	TEST_ERR_IF( encodingInto[ 0 ] != 'x' );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( encodingInto );
+
+	return rc;
+}
+
+/******************************************************************************/
+static int testEncodeToSinkVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut )
+{
+	/* DATA */
+	int rc = 0;
+
+	char *encodingLevel = NULL;
+
+	TestSink sink;
+
+	PintoEncodeOptions options;
+
+
+	/* CODE */
+	(void)encoding;
+	(void)imageOut;
+
+	sink.buffer = NULL;
+
+	/* encoding to a sink must be the same, at any level */
+	pintoEncodeOptionsInit( &options );
+	options.level = rand() % ( PINTO_LEVEL_MAX + 1 );
+	options.threadCount = ( rand() % 4 ) + 1;
+
+	TEST_ERR_IF( pintoImageEncodeEx( image, &options, &encodingLevel ) != PINTO_RC_SUCCESS );
+
+	sink.bufferSize = (s32) strlen( encodingLevel );
+	sink.buffer = (char *) PINTO_HOOK_MALLOC( sink.bufferSize + 1 );
+	TEST_ERR_IF( sink.buffer == NULL );
+	sink.usedSize = 0;
+	sink.writesBeforeFailing = -1;
+
+	TEST_ERR_IF( pintoImageEncodeToSink( image, &options, testSinkWrite, &sink ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( sink.usedSize != sink.bufferSize );
+	TEST_ERR_IF( memcmp( sink.buffer, encodingLevel, sink.usedSize ) != 0 );
+
+	/* and with an encoder that's been used before */
+	sink.usedSize = 0;
+
+	TEST_ERR_IF( pintoEncoderEncodeToSink( verifyEncoder, image, &options, testSinkWrite, &sink ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( sink.usedSize != sink.bufferSize );
+	TEST_ERR_IF( memcmp( sink.buffer, encodingLevel, sink.usedSize ) != 0 );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( encodingLevel );
+	PINTO_HOOK_FREE( sink.buffer );
+
+	return rc;
+}
+
+/******************************************************************************/
+static int testEncoderVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut )
+{
+	/* DATA */
+	int rc = 0;
+
+	const char *encodingEncoder = NULL;
+
+	PintoEncodeOptions options;
+
+	s32 row = 0;
+	s32 rowAmount = 0;
+
+
+	/* CODE */
+	(void)imageOut;
+
+	/* encoding with an encoder that's been used before must be the same */
+	TEST_ERR_IF( pintoEncoderEncode( verifyEncoder, image, NULL, &encodingEncoder ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( strcmp( encodingEncoder, encoding ) != 0 );
+
+	/* encoding a few rows at a time must be the same */
+	pintoEncodeOptionsInit( &options );
+	options.threadCount = ( rand() % 4 ) + 1;
+
+	TEST_ERR_IF( pintoEncoderBegin( verifyEncoder, image->width, image->height, &options ) != PINTO_RC_SUCCESS );
+
+	for ( row = 0; row < image->height; row += rowAmount )
+	{
+		rowAmount = ( rand() % 8 ) + 1;
+		if ( row + rowAmount > image->height )
+		{
+			rowAmount = image->height - row;
+		}
+
+		TEST_ERR_IF( pintoEncoderAddRows( verifyEncoder, image->rgba + ( row * image->width * 4 ), rowAmount ) != PINTO_RC_SUCCESS );
+	}
+
+	TEST_ERR_IF( pintoEncoderFinish( verifyEncoder, &encodingEncoder ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( strcmp( encodingEncoder, encoding ) != 0 );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	return rc;
+}
+
+/******************************************************************************/
+static int testEncodeLevelsVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut )
+{
+	/* DATA */
+	int rc = 0;
+
+	char *encodingMax = NULL;
+	char *encodingThreads = NULL;
+	char *encodingLevel = NULL;
+	char *encodingThreadsLevel = NULL;
+
+	s32 encodedSize = 0;
+
+	PintoImage *imageOutMax = NULL;
+	PintoImage *imageOutLevel = NULL;
+
+	s32 level = 0;
+
+	PintoEncodeOptions options;
+
+
+	/* CODE */
+	TEST_ERR_IF( pintoImageEncodedSize( image, &encodedSize ) != PINTO_RC_SUCCESS );
+
+	/* encoding with threads must be the same */
+	pintoEncodeOptionsInit( &options );
+	options.threadCount = ( rand() % 8 ) + 2;
+
+	TEST_ERR_IF( pintoImageEncodeEx( image, &options, &encodingThreads ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( strcmp( encodingThreads, encoding ) != 0 );
+
+	/* encode at the other levels, which must decode to the same image */
+	for ( level = PINTO_LEVEL_NONE; level <= PINTO_LEVEL_FAST; level += 1 )
+	{
+		pintoEncodeOptionsInit( &options );
+		options.level = level;
+
+		TEST_ERR_IF( pintoImageEncodeEx( image, &options, &encodingLevel ) != PINTO_RC_SUCCESS );
+		TEST_ERR_IF( (s32) strlen( encodingLevel ) > encodedSize );
+
+		TEST_ERR_IF( pintoImageDecodeString( encodingLevel, &imageOutLevel ) != PINTO_RC_SUCCESS );
+		TEST_ERR_IF( imageOutLevel->width != imageOut->width );
+		TEST_ERR_IF( imageOutLevel->height != imageOut->height );
+		TEST_ERR_IF( memcmp( imageOutLevel->rgba, imageOut->rgba, imageOut->width * imageOut->height * 4 ) != 0 );
+
+		/* threads must give the same encoding at this level too */
+		options.threadCount = ( rand() % 8 ) + 2;
+
+		TEST_ERR_IF( pintoImageEncodeEx( image, &options, &encodingThreadsLevel ) != PINTO_RC_SUCCESS );
+		TEST_ERR_IF( strcmp( encodingThreadsLevel, encodingLevel ) != 0 );
+
+		PINTO_HOOK_FREE( encodingLevel );
+		encodingLevel = NULL;
+
+		PINTO_HOOK_FREE( encodingThreadsLevel );
+		encodingThreadsLevel = NULL;
+
+		pintoImageFree( &imageOutLevel );
+	}
+
+	/* reordering colors must decode to the same image, and be the same with
+	   threads */
+	pintoEncodeOptionsInit( &options );
+	options.reorderColors = 1;
+
+	TEST_ERR_IF( pintoImageEncodeEx( image, &options, &encodingLevel ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( (s32) strlen( encodingLevel ) > encodedSize );
+
+	TEST_ERR_IF( pintoImageDecodeString( encodingLevel, &imageOutLevel ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( imageOutLevel->width != imageOut->width );
+	TEST_ERR_IF( imageOutLevel->height != imageOut->height );
+	TEST_ERR_IF( memcmp( imageOutLevel->rgba, imageOut->rgba, imageOut->width * imageOut->height * 4 ) != 0 );
+
+	options.threadCount = ( rand() % 8 ) + 2;
+
+	TEST_ERR_IF( pintoImageEncodeEx( image, &options, &encodingThreadsLevel ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( strcmp( encodingThreadsLevel, encodingLevel ) != 0 );
+
+	/* encode at max level, which must decode to the same image and can't be
+	   bigger */
+	pintoEncodeOptionsInit( &options );
+	options.level = PINTO_LEVEL_MAX;
+
+	TEST_ERR_IF( pintoImageEncodeEx( image, &options, &encodingMax ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( strlen( encodingMax ) > strlen( encoding ) );
+
+	TEST_ERR_IF( pintoImageDecodeString( encodingMax, &imageOutMax ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( imageOutMax->width != imageOut->width );
+	TEST_ERR_IF( imageOutMax->height != imageOut->height );
+	TEST_ERR_IF( memcmp( imageOutMax->rgba, imageOut->rgba, imageOut->width * imageOut->height * 4 ) != 0 );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( encodingMax );
+	PINTO_HOOK_FREE( encodingThreads );
+	PINTO_HOOK_FREE( encodingLevel );
+	PINTO_HOOK_FREE( encodingThreadsLevel );
+
+	pintoImageFree( &imageOutLevel );
+	pintoImageFree( &imageOutMax );
+
+	return rc;
+}
+
+/******************************************************************************/
+static int testIndexedImageVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut )
+{
+	/* DATA */
+	int rc = 0;
+
+	PintoIndexedImage indexedImage;
+	u8 palette[ 256 * 3 ];
+	u8 *indexes = NULL;
+	char *encodingIndexed = NULL;
+	PintoIndexedImage *indexedImageOut = NULL;
+
+	s32 pixel = 0;
+	s32 index = 0;
+	s32 colorAmount = 0;
+	u8 *rgba = NULL;
+
+
+	/* CODE */
+	(void)imageOut;
+
+	indexes = (u8 *) PINTO_HOOK_MALLOC( image->width * image->height );
+	TEST_ERR_IF( indexes == NULL );
+
+	/* the transparent index is past the palette, since the palette can only
+	   get up to 255 colors here */
+	for ( pixel = 0; pixel < image->width * image->height; pixel += 1 )
+	{
+		rgba = image->rgba + ( pixel * 4 );
+
+		if ( rgba[ 3 ] == 0 )
+		{
+			indexes[ pixel ] = 255;
+			continue;
+		}
+
+		for ( index = 0; index < colorAmount; index += 1 )
+		{
+			if ( memcmp( palette + ( index * 3 ), rgba, 3 ) == 0 )
+			{
+				break;
+			}
+		}
+
+		if ( index == colorAmount )
+		{
+			/* too many colors to fit, so this image can't be tested */
+			if ( colorAmount == 255 )
+			{
+				goto cleanup;
+			}
+
+			memcpy( palette + ( index * 3 ), rgba, 3 );
+			colorAmount += 1;
+		}
+
+		indexes[ pixel ] = (u8) index;
+	}
+
+	indexedImage.width = image->width;
+	indexedImage.height = image->height;
+	indexedImage.colorAmount = colorAmount;
+	indexedImage.palette = ( colorAmount == 0 ? NULL : palette );
+	indexedImage.indexes = indexes;
+	indexedImage.transparentIndex = 255;
+
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, NULL, &encodingIndexed ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( strcmp( encodingIndexed, encoding ) != 0 );
+
+	/* with no colors, decoding gives back no colors and every pixel
+	   transparent */
+	if ( colorAmount == 0 )
+	{
+		TEST_ERR_IF( pintoIndexedImageDecode( encodingIndexed, strlen( encodingIndexed ), &indexedImageOut ) != PINTO_RC_SUCCESS );
+		TEST_ERR_IF( indexedImageOut->width != image->width );
+		TEST_ERR_IF( indexedImageOut->height != image->height );
+		TEST_ERR_IF( indexedImageOut->colorAmount != 0 );
+
+		for ( pixel = 0; pixel < image->width * image->height; pixel += 1 )
+		{
+			TEST_ERR_IF( indexedImageOut->indexes[ pixel ] != PINTO_INDEX_TRANSPARENT );
+		}
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( indexes );
+	PINTO_HOOK_FREE( encodingIndexed );
+
+	pintoIndexedImageFree( &indexedImageOut );
+
+	return rc;
+}
+
+/******************************************************************************/
+static int testImageViewVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut )
+{
+	/* DATA */
+	int rc = 0;
+
+	PintoImageView view;
+	PintoEncodeOptions options;
+	u8 *buffer = NULL;
+	char *encodingView = NULL;
+	const char *encodingEncoder = NULL;
+
+	s32 format = 0;
+	s32 pixelSize = 0;
+	s32 rowSize = 0;
+	s32 bottomUp = 0;
+	s32 colorKey = 0;
+	s32 pixel = 0;
+	s32 x = 0;
+	s32 y = 0;
+	u8 *rgba = NULL;
+	u8 *out = NULL;
+
+
+	/* CODE */
+	(void)imageOut;
+
+	format = rand() % 4;
+	pixelSize = ( format == PINTO_FORMAT_RGB ? 3 : 4 );
+	rowSize = ( image->width * pixelSize ) + ( rand() % 9 );
+	bottomUp = rand() % 2;
+
+	buffer = (u8 *) PINTO_HOOK_MALLOC( rowSize * image->height );
+	TEST_ERR_IF( buffer == NULL );
+
+	/* for RGB, find a color key that no opaque pixel has */
+	colorKey = rand() % 0x1000000;
+	for ( pixel = 0; pixel < image->width * image->height; pixel += 1 )
+	{
+		rgba = image->rgba + ( pixel * 4 );
+
+		if ( rgba[ 3 ] != 0 && ( ( rgba[ 0 ] << 16 ) | ( rgba[ 1 ] << 8 ) | rgba[ 2 ] ) == colorKey )
+		{
+			colorKey = rand() % 0x1000000;
+			pixel = -1;
+		}
+	}
+
+	for ( y = 0; y < image->height; y += 1 )
+	{
+		for ( x = 0; x < image->width; x += 1 )
+		{
+			rgba = image->rgba + ( ( ( y * image->width ) + x ) * 4 );
+			out = buffer + ( ( bottomUp ? image->height - 1 - y : y ) * rowSize ) + ( x * pixelSize );
+
+			if ( format == PINTO_FORMAT_RGBA )
+			{
+				out[ 0 ] = rgba[ 0 ]; out[ 1 ] = rgba[ 1 ]; out[ 2 ] = rgba[ 2 ]; out[ 3 ] = rgba[ 3 ];
+			}
+			else if ( format == PINTO_FORMAT_BGRA )
+			{
+				out[ 0 ] = rgba[ 2 ]; out[ 1 ] = rgba[ 1 ]; out[ 2 ] = rgba[ 0 ]; out[ 3 ] = rgba[ 3 ];
+			}
+			else if ( format == PINTO_FORMAT_ARGB )
+			{
+				out[ 0 ] = rgba[ 3 ]; out[ 1 ] = rgba[ 0 ]; out[ 2 ] = rgba[ 1 ]; out[ 3 ] = rgba[ 2 ];
+			}
+			else if ( rgba[ 3 ] == 0 )
+			{
+				out[ 0 ] = (u8)( colorKey >> 16 ); out[ 1 ] = (u8)( colorKey >> 8 ); out[ 2 ] = (u8) colorKey;
+			}
+			else
+			{
+				out[ 0 ] = rgba[ 0 ]; out[ 1 ] = rgba[ 1 ]; out[ 2 ] = rgba[ 2 ];
+			}
+		}
+	}
+
+	pintoImageViewInit( &view, image->width, image->height, format, buffer );
+	view.colorKey = colorKey;
+	view.stride = rowSize;
+	if ( bottomUp )
+	{
+		view.pixels = buffer + ( ( image->height - 1 ) * rowSize );
+		view.stride = -rowSize;
+	}
+
+	pintoEncodeOptionsInit( &options );
+	options.threadCount = ( rand() % 4 ) + 1;
+
+	if ( rand() % 2 == 0 )
+	{
+		TEST_ERR_IF( pintoImageViewEncode( &view, &options, &encodingView ) != PINTO_RC_SUCCESS );
+		TEST_ERR_IF( strcmp( encodingView, encoding ) != 0 );
+	}
+	else
+	{
+		TEST_ERR_IF( pintoEncoderEncodeView( verifyEncoder, &view, &options, &encodingEncoder ) != PINTO_RC_SUCCESS );
+		TEST_ERR_IF( strcmp( encodingEncoder, encoding ) != 0 );
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( buffer );
+	PINTO_HOOK_FREE( encodingView );
+
+	return rc;
+}
+
+/******************************************************************************/
+static int testDecodeBufferVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut )
+{
+	/* DATA */
+	int rc = 0;
+
+	s32 length = 0;
+	char *buffer = NULL;
+	s32 bufferLength = 0;
+
+	PintoImage *imageBuffer = NULL;
+
+	s32 i = 0;
+
+
+	/* CODE */
+	(void)image;
+
+	length = (s32) strlen( encoding );
+
+	/* room for a break after every character, and a second image after it */
+	buffer = (char *) PINTO_HOOK_MALLOC( ( length * 2 ) + 16 );
+	TEST_ERR_IF( buffer == NULL );
+
+	/* wrap the encoding with characters that must be skipped */
+	for ( i = 0; i < length; i += 1 )
+	{
+		if ( ( rand() % 8 ) == 0 )
+		{
+			buffer[ bufferLength ] = " \n\t_`[]\\"[ rand() % 9 ];
+			bufferLength += 1;
+		}
+
+		buffer[ bufferLength ] = encoding[ i ];
+		bufferLength += 1;
+	}
+
+	/* the buffer isn't '\0' terminated, and is followed by another image that
+	   must not be read */
+	memcpy( buffer + bufferLength, "a441000?64^", 11 );
+
+	TEST_ERR_IF( pintoImageDecodeBuffer( buffer, bufferLength, &imageBuffer ) != PINTO_RC_SUCCESS );
+
+	TEST_ERR_IF( imageBuffer->width != imageOut->width );
+	TEST_ERR_IF( imageBuffer->height != imageOut->height );
+	TEST_ERR_IF( memcmp( imageBuffer->rgba, imageOut->rgba, imageOut->width * imageOut->height * 4 ) != 0 );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( buffer );
+
+	pintoImageFree( &imageBuffer );
+
+	return rc;
+}
+
+/******************************************************************************/
+static int testDecodeIntoVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut )
+{
+	/* DATA */
+	int rc = 0;
+
+	s32 length = 0;
+
+	s32 offset = 0;
+	s32 stride = 0;
+	s32 rgbaSize = 0;
+	s32 neededSize = 0;
+	u8 *rgba = NULL;
+
+	char *badEncoding = NULL;
+
+	s32 width = 0;
+	s32 height = 0;
+
+	s32 row = 0;
+	s32 i = 0;
+
+
+	/* CODE */
+	(void)image;
+
+	length = (s32) strlen( encoding );
+
+	/* an extra value after the last color is invalid */
+	badEncoding = (char *) PINTO_HOOK_MALLOC( length + 1 );
+	TEST_ERR_IF( badEncoding == NULL );
+
+	memcpy( badEncoding, encoding, length );
+	badEncoding[ length ] = '0';
+
+	offset = rand() % 16;
+	stride = ( imageOut->width * 4 ) + ( ( rand() % 2 ) * ( rand() % 16 ) );
+	rgbaSize = offset + ( stride * imageOut->height );
+
+	rgba = (u8 *) PINTO_HOOK_MALLOC( rgbaSize );
+	TEST_ERR_IF( rgba == NULL );
+
+	/* anything left in the memory must be overwritten, or not touched if
+	   it's not part of the image */
+	memset( rgba, 0xAB, rgbaSize );
+
+	/* the last row doesn't need its padding */
+	neededSize = rgbaSize - ( stride - ( imageOut->width * 4 ) );
+
+	/* too small, so nothing is written */
+	TEST_ERR_IF( pintoImageDecodeInto( encoding, length, rgba, neededSize - 1, offset, stride, &width, &height ) != PINTO_RC_ERROR_BUFFER_TOO_SMALL );
+	TEST_ERR_IF( width != imageOut->width );
+	TEST_ERR_IF( height != imageOut->height );
+
+	for ( i = 0; i < rgbaSize; i += 1 )
+	{
+		TEST_ERR_IF( rgba[ i ] != 0xAB );
+	}
+
+	/* invalid, so nothing is written */
+	TEST_ERR_IF( pintoImageDecodeInto( badEncoding, length + 1, rgba, rgbaSize, offset, stride, &width, &height ) != PINTO_RC_ERROR_FORMAT_INVALID );
+
+	for ( i = 0; i < rgbaSize; i += 1 )
+	{
+		TEST_ERR_IF( rgba[ i ] != 0xAB );
+	}
+
+	/* a stride of 0 means there's no padding */
+	TEST_ERR_IF( pintoImageDecodeInto( encoding, length, rgba, neededSize, offset, ( stride == imageOut->width * 4 && rand() % 2 ) ? 0 : stride, &width, &height ) != PINTO_RC_SUCCESS );
+
+	for ( i = 0; i < offset; i += 1 )
+	{
+		TEST_ERR_IF( rgba[ i ] != 0xAB );
+	}
+
+	for ( row = 0; row < imageOut->height; row += 1 )
+	{
+		TEST_ERR_IF( memcmp( rgba + offset + ( row * stride ), imageOut->rgba + ( row * imageOut->width * 4 ), imageOut->width * 4 ) != 0 );
+
+		for ( i = imageOut->width * 4; i < stride; i += 1 )
+		{
+			TEST_ERR_IF( rgba[ offset + ( row * stride ) + i ] != 0xAB );
+		}
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( rgba );
+	PINTO_HOOK_FREE( badEncoding );
+
+	return rc;
+}
+
+/******************************************************************************/
+static int testIndexedDecodeVerify( const PintoImage *image, const char *encoding, const PintoImage *imageOut )
+{
+	/* DATA */
+	int rc = 0;
+
+	PintoIndexedImage *indexedImage = NULL;
+	char *encodingIndexed = NULL;
+
+	PintoImageInfo info;
+
+	s32 i = 0;
+	u8 index = 0;
+
+
+	/* CODE */
+	(void)image;
+
+	TEST_ERR_IF( pintoIndexedImageDecode( encoding, strlen( encoding ), &indexedImage ) != PINTO_RC_SUCCESS );
+
+	TEST_ERR_IF( indexedImage->width != imageOut->width );
+	TEST_ERR_IF( indexedImage->height != imageOut->height );
+	TEST_ERR_IF( indexedImage->transparentIndex != PINTO_INDEX_TRANSPARENT );
+
+	/* each index must be the pixel's color */
+	for ( i = 0; i < imageOut->width * imageOut->height; i += 1 )
+	{
+		index = indexedImage->indexes[ i ];
+
+		if ( imageOut->rgba[ ( i * 4 ) + 3 ] == 0 )
+		{
+			TEST_ERR_IF( index != PINTO_INDEX_TRANSPARENT );
+		}
+		else
+		{
+			TEST_ERR_IF( index >= indexedImage->colorAmount );
+			TEST_ERR_IF( memcmp( indexedImage->palette + ( index * 3 ), imageOut->rgba + ( i * 4 ), 3 ) != 0 );
+		}
+	}
+
+	/* the header must have the same size and palette */
+	TEST_ERR_IF( pintoImageGetInfo( encoding, strlen( encoding ), &info ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( info.width != indexedImage->width );
+	TEST_ERR_IF( info.height != indexedImage->height );
+	TEST_ERR_IF( info.colorAmount != indexedImage->colorAmount );
+	if ( info.colorAmount > 0 )
+	{
+		TEST_ERR_IF( memcmp( info.palette, indexedImage->palette, info.colorAmount * 3 ) != 0 );
+	}
+
+	/* the palette is in painting order, so encoding it again gives the same
+	   encoding */
+	TEST_ERR_IF( pintoIndexedImageEncode( indexedImage, NULL, &encodingIndexed ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( strcmp( encodingIndexed, encoding ) != 0 );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoIndexedImageFree( &indexedImage );
+
+	PINTO_HOOK_FREE( encodingIndexed );
+
+	return rc;
+}
+
+/******************************************************************************/
+static int testImageViews()
+{
+	/* DATA */
+	int rc = 0;
+
+	PintoImageView view;
+	PintoImage *image = NULL;
+	PintoEncodeOptions options;
+	u8 *gray = NULL;
+	char *encoding = NULL;
+	char *encodingView = NULL;
+	PINTO_RC rcExpected = PINTO_RC_SUCCESS;
+
+	s32 test = 0;
+	s32 pixel = 0;
+	s32 levels = 0;
+	s32 threshold = 0;
+
+
+	/* CODE */
+	printf( "  Testing image views...\n" ); fflush( stdout );
+
+	/* gray, which is transparent under the threshold, must be the same as
+	   the same image in RGBA */
+	for ( test = 0; test < 1000; test += 1 )
+	{
+		TEST_ERR_IF( pintoImageInit( ( rand() % 64 ) + 1, ( rand() % 64 ) + 1, &image ) != PINTO_RC_SUCCESS );
+
+		gray = (u8 *) PINTO_HOOK_MALLOC( image->width * image->height );
+		TEST_ERR_IF( gray == NULL );
+
+		/* sometimes enough gray levels to be too many colors */
+		levels = ( rand() % 2 == 0 ? 8 : 256 );
+		threshold = rand() % 257;
+
+		for ( pixel = 0; pixel < image->width * image->height; pixel += 1 )
+		{
+			gray[ pixel ] = (u8)( ( rand() % levels ) * ( 256 / levels ) );
+
+			if ( gray[ pixel ] >= threshold )
+			{
+				image->rgba[ ( pixel * 4 )     ] = gray[ pixel ];
+				image->rgba[ ( pixel * 4 ) + 1 ] = gray[ pixel ];
+				image->rgba[ ( pixel * 4 ) + 2 ] = gray[ pixel ];
+				image->rgba[ ( pixel * 4 ) + 3 ] = 255;
+			}
+		}
+
+		pintoEncodeOptionsInit( &options );
+		options.threadCount = ( rand() % 4 ) + 1;
+
+		rcExpected = pintoImageEncodeEx( image, &options, &encoding );
+
+		pintoImageViewInit( &view, image->width, image->height, PINTO_FORMAT_GRAY, gray );
+		view.threshold = threshold;
+
+		TEST_ERR_IF( pintoImageViewEncode( &view, &options, &encodingView ) != rcExpected );
+		TEST_ERR_IF( rcExpected == PINTO_RC_SUCCESS && strcmp( encodingView, encoding ) != 0 );
+
+		PINTO_HOOK_FREE( encoding );
+		encoding = NULL;
+		PINTO_HOOK_FREE( encodingView );
+		encodingView = NULL;
+		PINTO_HOOK_FREE( gray );
+		gray = NULL;
+		pintoImageFree( &image );
+	}
+	printf( "." ); fflush( stdout );
+
+	/* partial transparency must be found in every 4 byte format */
+	for ( test = 0; test < 300; test += 1 )
+	{
+		TEST_ERR_IF( pintoImageInit( ( rand() % 64 ) + 1, ( rand() % 64 ) + 1, &image ) != PINTO_RC_SUCCESS );
+
+		pixel = rand() % ( image->width * image->height );
+		image->rgba[ ( pixel * 4 ) + ( test % 3 == 2 ? 0 : 3 ) ] = 128;
+
+		pintoImageViewInit( &view, image->width, image->height, test % 3, image->rgba );
+
+		TEST_ERR_IF( pintoImageViewEncode( &view, NULL, &encodingView ) != PINTO_RC_ERROR_IMAGE_PARTIAL_TRANSPARENCY );
+
+		pintoImageFree( &image );
+	}
+	printf( "." ); fflush( stdout );
+
+	/* rows can't overlap */
+	TEST_ERR_IF( pintoImageInit( 4, 4, &image ) != PINTO_RC_SUCCESS );
+	pintoImageViewInit( &view, 4, 4, PINTO_FORMAT_RGBA, image->rgba + ( 12 * 4 ) );
+	view.stride = -15;
+	TEST_ERR_IF( pintoImageViewEncode( &view, NULL, &encodingView ) != PINTO_RC_ERROR_PRECOND );
+	view.stride = -16;
+	TEST_ERR_IF( pintoImageViewEncode( &view, NULL, &encodingView ) != PINTO_RC_SUCCESS );
+	PINTO_HOOK_FREE( encodingView );
+	encodingView = NULL;
+	view.pixels = image->rgba;
+	view.stride = 15;
+	TEST_ERR_IF( pintoImageViewEncode( &view, NULL, &encodingView ) != PINTO_RC_ERROR_PRECOND );
+	pintoImageFree( &image );
+	printf( "." ); fflush( stdout );
+
+	printf( "\n" );
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( encoding );
+	PINTO_HOOK_FREE( encodingView );
+	PINTO_HOOK_FREE( gray );
+	pintoImageFree( &image );
+
+	return rc;
+}
+
+
+/******************************************************************************/
+/* Checks an image from each fixture a few times, since verify functions make
+   some random choices */
+static int testFixtures( const char *description, TestVerifyFunc verify )
+{
+	/* DATA */
+	int rc = 0;
+
+	PintoImage *image = NULL;
+
+	s32 fixture = 0;
+	s32 i = 0;
+
+
+	/* CODE */
+	printf( "  %s\n", description ); fflush( stdout );
+
+	for ( fixture = 0; fixture < TEST_FIXTURE_AMOUNT; fixture += 1 )
+	{
+		TEST_ERR_IF( testFixtureImage( fixture, &image ) != 0 );
+
+		for ( i = 0; i < 10; i += 1 )
+		{
+			TEST_ERR_IF( testImageVerifyWith( image, verify ) != 0 );
+		}
+
+		pintoImageFree( &image );
+	}
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoImageFree( &image );
+
+	return rc;
+}
+
+/******************************************************************************/
+/* Makes an image that's a case encoding or decoding has to get right */
+static int testFixtureImage( s32 fixture, PintoImage **image_A )
+{
+	/* DATA */
+	int rc = 0;
+
+	PintoImage *image = NULL;
+
+	s32 i = 0;
+	s32 color = 0;
+
+
+	/* CODE */
+	if ( fixture == 0 )
+	{
+		/* every pixel is transparent, so there are no colors */
+		TEST_ERR_IF( pintoImageInit( 1, 1, &image ) != PINTO_RC_SUCCESS );
+	}
+	else if ( fixture == 1 )
+	{
+		/* a black square, which has a short header */
+		TEST_ERR_IF( pintoImageInit( 8, 8, &image ) != PINTO_RC_SUCCESS );
+		testImageAddRun( image, 0, 64, 0, 0, 0 );
+	}
+	else if ( fixture == 2 )
+	{
+		/* an odd size, with runs that cross rows, and transparent gaps */
+		TEST_ERR_IF( pintoImageInit( 13, 7, &image ) != PINTO_RC_SUCCESS );
+		testImageAddRun( image, 0, 20, 255, 0, 0 );
+		testImageAddRun( image, 25, 30, 0, 255, 0 );
+		testImageAddRun( image, 40, 10, 0, 0, 255 );
+		testImageAddRun( image, 60, 31, 255, 0, 0 );
+	}
+	else if ( fixture == 3 )
+	{
+		/* 60 colors in runs of 1, so the encoding is big */
+		TEST_ERR_IF( pintoImageInit( 64, 64, &image ) != PINTO_RC_SUCCESS );
+
+		for ( i = 0; i < 64 * 64; i += 1 )
+		{
+			color = ( i * 37 + i / 64 ) % 60;
+			testImageAddRun( image, i, 1, (u8)( color * 4 ), (u8)( 255 - color * 4 ), 0 );
+		}
+	}
+	else if ( fixture == 4 )
+	{
+		/* wide, with long runs */
+		TEST_ERR_IF( pintoImageInit( 300, 3, &image ) != PINTO_RC_SUCCESS );
+		testImageAddRun( image, 0, 450, 255, 255, 255 );
+		testImageAddRun( image, 450, 200, 128, 128, 128 );
+	}
+	else if ( fixture == 5 )
+	{
+		/* tall, with every other row filled */
+		TEST_ERR_IF( pintoImageInit( 2, 200, &image ) != PINTO_RC_SUCCESS );
+
+		for ( i = 0; i < 200; i += 2 )
+		{
+			testImageAddRun( image, i * 2, 2, 0, 0, 255 );
+		}
+	}
+	else
+	{
+		/* a repeating pattern, which deflates to many references */
+		TEST_ERR_IF( pintoImageInit( 128, 128, &image ) != PINTO_RC_SUCCESS );
+
+		for ( i = 0; i < 128 * 128; i += 1 )
+		{
+			if ( ( i / 128 ) % 3 != 0 )
+			{
+				color = ( ( i % 128 ) / 8 ) % 5;
+				testImageAddRun( image, i, 1, (u8)( color * 50 ), 0, (u8)( 200 - color * 40 ) );
+			}
+		}
+	}
+
+	(*image_A) = image;
+	image = NULL;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	pintoImageFree( &image );
+
+	return rc;
+}
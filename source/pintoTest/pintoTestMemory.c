@@ -40,10 +40,16 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /* which malloc to fail on */
 static s32 failOnMallocCount = 0;
 static s32 currentMallocCount = 0;
+/* biggest single allocation */
+static size_t largestMallocSize = 0;
 
 void *pintoHookMalloc( size_t size )
 {
 	currentMallocCount += 1;
+	if ( size > largestMallocSize )
+	{
+		largestMallocSize = size;
+	}
 	if ( currentMallocCount == failOnMallocCount )
 	{
 		return NULL;
@@ -55,6 +61,10 @@ void *pintoHookMalloc( size_t size )
 void *pintoHookCalloc( size_t nmemb, size_t size )
 {
 	currentMallocCount += 1;
+	if ( nmemb * size > largestMallocSize )
+	{
+		largestMallocSize = nmemb * size;
+	}
 	if ( currentMallocCount == failOnMallocCount )
 	{
 		return NULL;
@@ -66,6 +76,10 @@ void *pintoHookCalloc( size_t nmemb, size_t size )
 void *pintoHookRealloc( void *ptr, size_t size )
 {
 	currentMallocCount += 1;
+	if ( size > largestMallocSize )
+	{
+		largestMallocSize = size;
+	}
 	if ( currentMallocCount == failOnMallocCount )
 	{
 		return NULL;
@@ -85,6 +99,8 @@ static PINTO_RC testFailedMallocs1( s32 test );
 static PINTO_RC testFailedMallocs2( s32 test );
 static PINTO_RC testFailedMallocs3( s32 test );
 static PINTO_RC testFailedMallocs4( s32 test );
+static PINTO_RC testFailedMallocs5( s32 test );
+static PINTO_RC testFailedMallocs6( s32 test );
 
 typedef struct
 {
@@ -96,8 +112,10 @@ static FailedFunc failedFuncs[] =
 {
 	{ testFailedMallocs1, 1 },
 	{ testFailedMallocs2, 1 },
-	{ testFailedMallocs3, 2 },
+	{ testFailedMallocs3, 4 },
 	{ testFailedMallocs4, 13 },
+	{ testFailedMallocs5, 5 },
+	{ testFailedMallocs6, 2 },
 	{ NULL, 0 }
 };
 #endif
@@ -120,6 +138,17 @@ int testMemory()
 
 	s32 OLD_PINTO_TEXT_SIZE_GROWTH = 0;
 
+#ifdef PINTO_DEBUG
+	PintoEncoder *encoder = NULL;
+	PintoImage *image = NULL;
+	PintoEncodeOptions options;
+	const char *encoding = NULL;
+	s32 level = 0;
+	char buffer[ 65536 ];
+	s32 usedSize = 0;
+	s32 color = 0;
+#endif
+
 
 	/* CODE */
 	/* **************************************** */
@@ -195,6 +224,65 @@ int testMemory()
 	/* *** */
 	PINTO_TEXT_SIZE_GROWTH = OLD_PINTO_TEXT_SIZE_GROWTH;
 
+#ifdef PINTO_DEBUG
+	/* **************************************** */
+	/* an encoder that's been used shouldn't allocate again */
+	printf( "  Testing encoder reuse...\n" ); fflush( stdout );
+
+	TEST_ERR_IF( pintoImageInit( 64, 64, &image ) != PINTO_RC_SUCCESS );
+	testImageAddRun( image, 0, 1000, 255, 255, 255 );
+	testImageAddRun( image, 1500, 300, 255, 0, 0 );
+	testImageAddRun( image, 3000, 700, 0, 0, 255 );
+
+	TEST_ERR_IF( pintoEncoderInit( &encoder ) != PINTO_RC_SUCCESS );
+
+	for ( level = PINTO_LEVEL_NONE; level <= PINTO_LEVEL_MAX; level += 1 )
+	{
+		pintoEncodeOptionsInit( &options );
+		options.level = level;
+		options.reorderColors = 1;
+
+		TEST_ERR_IF( pintoEncoderEncode( encoder, image, &options, &encoding ) != PINTO_RC_SUCCESS );
+
+		currentMallocCount = 0;
+		TEST_ERR_IF( pintoEncoderEncode( encoder, image, &options, &encoding ) != PINTO_RC_SUCCESS );
+		TEST_ERR_IF( currentMallocCount != 0 );
+
+		TEST_ERR_IF( pintoEncoderEncodeInto( encoder, image, &options, buffer, sizeof( buffer ), &usedSize ) != PINTO_RC_SUCCESS );
+		TEST_ERR_IF( currentMallocCount != 0 );
+		TEST_ERR_IF( usedSize != (s32)strlen( encoding ) );
+	}
+
+	/* **************************************** */
+	/* encoding into a buffer should make the encoding right in the buffer,
+	   and not allocate anything its size */
+	printf( "  Testing encoding into a buffer...\n" ); fflush( stdout );
+
+	/* lots of short runs of lots of colors, so the encoding is bigger than
+	   anything else the encode needs */
+	for ( i = 0; i < 64 * 64; i += 1 )
+	{
+		color = ( i * 37 + i / 64 ) % 60;
+		testImageAddRun( image, i, 1, (u8)( color * 4 ), (u8)( 255 - color * 4 ), 0 );
+	}
+
+	pintoEncodeOptionsInit( &options );
+	options.level = PINTO_LEVEL_NONE;
+
+	largestMallocSize = 0;
+	TEST_ERR_IF( pintoImageEncodeInto( image, &options, buffer, sizeof( buffer ), &usedSize ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( usedSize > (s32)sizeof( buffer ) / 2 );
+	TEST_ERR_IF( largestMallocSize >= (size_t)usedSize );
+
+	/* a buffer that's too small is filled as far as it goes, and still
+	   tells us the size it needs */
+	largestMallocSize = 0;
+	TEST_ERR_IF( pintoImageEncodeInto( image, &options, buffer + usedSize, usedSize - 1, &j ) != PINTO_RC_ERROR_BUFFER_TOO_SMALL );
+	TEST_ERR_IF( j != usedSize );
+	TEST_ERR_IF( memcmp( buffer, buffer + usedSize, usedSize - 1 ) != 0 );
+	TEST_ERR_IF( largestMallocSize >= (size_t)usedSize );
+#endif
+
 	/* **************************************** */
 	/* test that calloc sets pointers to NULL */
 	printf( "  Testing calloc...\n" ); fflush( stdout );
@@ -207,6 +295,11 @@ int testMemory()
 	/* CLEANUP */
 	cleanup:
 
+#ifdef PINTO_DEBUG
+	pintoEncoderFree( &encoder );
+	pintoImageFree( &image );
+#endif
+
 	return rc;
 }
 
@@ -340,15 +433,23 @@ static PINTO_RC testFailedMallocs3( s32 test )
 	rc = pintoTextInit( &textIn );
 	ERR_IF_PASSTHROUGH;
 
-	for ( i = 0; in[ test ][ i ] != '\0'; i += 1 )
+	for ( i = 0; in[ test % 2 ][ i ] != '\0'; i += 1 )
 	{
-		rc = pintoTextAddChar( textIn, in[ test ][ i ] );
+		rc = pintoTextAddChar( textIn, in[ test % 2 ][ i ] );
 		ERR_IF_PASSTHROUGH;
 	}
 
 	/* deflate */
-	rc = pintoSimpleDeflate( &textIn, &textOut );
-	ERR_IF_PASSTHROUGH;
+	if ( test < 2 )
+	{
+		rc = pintoSimpleDeflate( &textIn, &textOut );
+		ERR_IF_PASSTHROUGH;
+	}
+	else
+	{
+		rc = pintoSimpleDeflateOptimal( &textIn, &textOut );
+		ERR_IF_PASSTHROUGH;
+	}
 
 	/* inflate */
 	rc = pintoSimpleInflate( &textOut, &textIn );
@@ -406,5 +507,196 @@ static PINTO_RC testFailedMallocs4( s32 test )
 
 	return rc;
 }
-#endif
+/******************************************************************************/
+static PINTO_RC testFailedMallocs5( s32 test )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoImage *image1 = NULL;
+	PintoImage *image2 = NULL;
+	char *encoding = NULL;
+
+	PintoEncodeOptions options;
+
+
+	/* CODE */
+	/* image with 3 colors */
+	rc = pintoImageInit( 32, 32, &image1 );
+	ERR_IF_PASSTHROUGH;
+
+	testImageAddRun( image1, 0, 100, 255, 255, 255 );
+	testImageAddRun( image1, 300, 200, 255, 0, 0 );
+	testImageAddRun( image1, 600, 300, 0, 0, 255 );
+
+	/* encode with threads, at different levels */
+	pintoEncodeOptionsInit( &options );
+	options.threadCount = ( test % 2 == 0 ? 2 : 5 );
+	options.level = ( test < 2 ? PINTO_LEVEL_DEFAULT : PINTO_LEVEL_NONE + ( test - 2 ) );
+	if ( test == 4 )
+	{
+		/* reordering colors, on top of the default level */
+		options.level = PINTO_LEVEL_DEFAULT;
+		options.reorderColors = 1;
+	}
+
+	rc = pintoImageEncodeEx( image1, &options, &encoding );
+	ERR_IF_PASSTHROUGH;
+
+	/* decode */
+	rc = pintoImageDecodeString( encoding, &image2 );
+	ERR_IF_PASSTHROUGH;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	PINTO_HOOK_FREE( encoding );
+	pintoImageFree( &image1 );
+	pintoImageFree( &image2 );
+
+	return rc;
+}
+/******************************************************************************/
+static PINTO_RC testFailedMallocs6( s32 test )
+{
+	/* DATA */
+	PINTO_RC rc = PINTO_RC_SUCCESS;
+
+	PintoEncoder *encoder = NULL;
+	PintoImage *image1 = NULL;
+	PintoImage *image2 = NULL;
+	PintoImage *image3 = NULL;
+	PintoImage *image4 = NULL;
+	const char *encoding = NULL;
+	char buffer[ 1024 ];
+	u8 rgba[ 4 * 4 * 4 ];
+	s32 size = 0;
+	FILE *file = NULL;
+	PintoIndexedImage indexedImage;
+	PintoIndexedImage *indexedImage2 = NULL;
+	PintoImageInfo info;
+	char *indexedEncoding = NULL;
+	PintoImageView view;
+
+	PintoEncodeOptions options;
+
+
+	/* CODE */
+	/* a small image, then a bigger one, so the encoder has to grow */
+	rc = pintoImageInit( 16, 16, &image1 );
+	ERR_IF_PASSTHROUGH;
+
+	testImageAddRun( image1, 0, 100, 255, 255, 255 );
+	testImageAddRun( image1, 150, 50, 255, 0, 0 );
+
+	rc = pintoImageInit( 32, 32, &image2 );
+	ERR_IF_PASSTHROUGH;
+
+	testImageAddRun( image2, 0, 100, 255, 255, 255 );
+	testImageAddRun( image2, 300, 200, 255, 0, 0 );
+	testImageAddRun( image2, 600, 300, 0, 0, 255 );
+
+	pintoEncodeOptionsInit( &options );
+	if ( test == 1 )
+	{
+		options.level = PINTO_LEVEL_MAX;
+		options.reorderColors = 1;
+	}
+
+	rc = pintoEncoderInit( &encoder );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoEncoderEncode( encoder, image1, &options, &encoding );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoEncoderEncode( encoder, image2, &options, &encoding );
+	ERR_IF_PASSTHROUGH;
+
+	/* into a buffer, which needs its own encoder */
+	rc = pintoImageEncodeInto( image2, &options, buffer, 1024, &size );
+	ERR_IF_PASSTHROUGH;
+
+	/* to a sink */
+	file = tmpfile();
+	ERR_IF( file == NULL, PINTO_RC_ERROR_STANDARD_LIBRARY_ERROR );
+
+	rc = pintoEncoderEncodeToSink( encoder, image2, &options, pintoFileWrite, file );
+	ERR_IF_PASSTHROUGH;
+
+	/* a few rows at a time, twice so it finishes both ways */
+	rc = pintoEncoderBegin( encoder, 32, 32, &options );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoEncoderAddRows( encoder, image2->rgba, 20 );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoEncoderAddRows( encoder, image2->rgba + ( 20 * 32 * 4 ), 12 );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoEncoderFinishToSink( encoder, pintoFileWrite, file );
+	ERR_IF_PASSTHROUGH;
 
+	rc = pintoEncoderBegin( encoder, 32, 32, &options );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoEncoderAddRows( encoder, image2->rgba, 32 );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoEncoderFinish( encoder, &encoding );
+	ERR_IF_PASSTHROUGH;
+
+	/* from a view, bottom row first and in BGRA */
+	pintoImageViewInit( &view, 16, 16, PINTO_FORMAT_BGRA, image2->rgba + ( 31 * 32 * 4 ) );
+	view.stride = -32 * 4;
+
+	rc = pintoEncoderEncodeView( encoder, &view, &options, &encoding );
+	ERR_IF_PASSTHROUGH;
+
+	/* with a palette */
+	indexedImage.width = 4;
+	indexedImage.height = 4;
+	indexedImage.colorAmount = 2;
+	indexedImage.palette = (u8 *) "\xFF\0\0\0\0\xFF";
+	indexedImage.indexes = (u8 *) "\0\0\1\1\0\2\1\1\0\0\1\1\2\2\2\2";
+	indexedImage.transparentIndex = 2;
+
+	rc = pintoIndexedImageEncode( &indexedImage, &options, &indexedEncoding );
+	ERR_IF_PASSTHROUGH;
+
+	/* decode */
+	rc = pintoImageDecodeString( encoding, &image3 );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoImageDecodeBuffer( indexedEncoding, strlen( indexedEncoding ), &image4 );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoImageDecodeInto( indexedEncoding, strlen( indexedEncoding ), rgba, 4 * 4 * 4, 0, 0, &size, &size );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoIndexedImageDecode( indexedEncoding, strlen( indexedEncoding ), &indexedImage2 );
+	ERR_IF_PASSTHROUGH;
+
+	rc = pintoImageGetInfo( indexedEncoding, strlen( indexedEncoding ), &info );
+	ERR_IF_PASSTHROUGH;
+
+
+	/* CLEANUP */
+	cleanup:
+
+	if ( file != NULL )
+	{
+		fclose( file );
+	}
+
+	pintoEncoderFree( &encoder );
+	pintoImageFree( &image1 );
+	pintoImageFree( &image2 );
+	pintoImageFree( &image3 );
+	pintoImageFree( &image4 );
+	PINTO_HOOK_FREE( indexedEncoding );
+	pintoIndexedImageFree( &indexedImage2 );
+
+	return rc;
+}
+#endif
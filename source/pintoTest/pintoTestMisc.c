@@ -44,6 +44,12 @@ int testMisc()
 	const char *string = NULL;
 
 	PintoText *text = NULL;
+	PintoText *textVerify = NULL;
+	PintoText view;
+
+	s32 strayIndex = 0;
+	s32 strayVerify = 0;
+	s32 bufferLength = 0;
 
 	s32 value = 0;
 	s32 valueVerify = 0;
@@ -53,6 +59,19 @@ int testMisc()
 	PintoImage *image1 = NULL;
 	PintoImage *image2 = NULL;
 
+	PintoPalette palette;
+	s32 keys[ PINTO_MAX_COLORS + 1 ];
+	s32 index = 0;
+	s32 test = 0;
+
+	u8 rgba[ 100 * 4 ];
+	s32 pixelKeys[ 100 ];
+	s32 pixelAmount = 0;
+	s32 partialPixel = 0;
+
+	u8 color[ 4 ];
+	s32 offset = 0;
+
 
 	/* CODE */
 	/* **************************************** */
@@ -137,6 +156,10 @@ int testMisc()
 	printf ( "\n" );
 
 	TEST_ERR_IF( pintoTextAddChar( text, 'x' ) != PINTO_RC_ERROR_FORMAT_TOO_LONG );
+	TEST_ERR_IF( pintoTextAddValue( text, 0 ) != PINTO_RC_ERROR_FORMAT_TOO_LONG );
+	TEST_ERR_IF( pintoTextAddBuffer( text, "\n x", 3, NULL ) != PINTO_RC_ERROR_FORMAT_TOO_LONG );
+	TEST_ERR_IF( pintoTextAddBuffer( text, " \n", 2, &strayIndex ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( strayIndex != -1 );
 
 	/* double-check */
 	TEST_ERR_IF( text->string[ ( PINTO_MAX_WIDTH * PINTO_MAX_HEIGHT ) - 1 ] != 'x' );
@@ -144,6 +167,71 @@ int testMisc()
 	
 	pintoTextFree( &text );
 
+	/* adding a buffer is the same as adding each character */
+	for ( test = 0; test < 1000; test += 1 )
+	{
+		TEST_ERR_IF( pintoTextInit( &text ) != PINTO_RC_SUCCESS );
+		TEST_ERR_IF( pintoTextInit( &textVerify ) != PINTO_RC_SUCCESS );
+
+		bufferLength = rand() % ( 100 * 4 );
+		strayVerify = -1;
+
+		for ( i = 0; i < bufferLength; i += 1 )
+		{
+			/* mostly valid, with some whitespace and some runs of
+			   anything, so some blocks are all valid and some aren't */
+			if ( ( i / 40 ) % 3 == 2 && rand() % 2 == 0 )
+			{
+				rgba[ i ] = (u8) rand();
+			}
+			else if ( ( i / 40 ) % 3 == 1 && rand() % 8 == 0 )
+			{
+				rgba[ i ] = (u8)( " \t\r\n"[ rand() % 4 ] );
+			}
+			else
+			{
+				rgba[ i ] = (u8)( '#' + ( rand() % ( 'z' - '#' + 1 ) ) );
+			}
+
+			if ( strayVerify == -1 && ! PINTO_CHAR_IS_VALID( (char) rgba[ i ] ) && ! PINTO_CHAR_IS_SPACE( (char) rgba[ i ] ) )
+			{
+				strayVerify = i;
+			}
+
+			TEST_ERR_IF( pintoTextAddChar( textVerify, (char) rgba[ i ] ) != PINTO_RC_SUCCESS );
+		}
+
+		TEST_ERR_IF( pintoTextAddBuffer( text, (const char *) rgba, bufferLength, &strayIndex ) != PINTO_RC_SUCCESS );
+		TEST_ERR_IF( strayIndex != strayVerify );
+
+		TEST_ERR_IF( text->usedSize != textVerify->usedSize );
+		TEST_ERR_IF( strcmp( text->string, textVerify->string ) != 0 );
+
+		pintoTextFree( &text );
+		pintoTextFree( &textVerify );
+	}
+
+	/* values with skipped characters inside them, or cut short */
+	string = " >1 2\n3\t4<;; =\n12";
+	pintoTextInitView( &view, string, (s32) strlen( string ) );
+
+	TEST_ERR_IF( pintoTextGetValue( &view, &valueVerify ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( valueVerify != ( 1 * 64 * 64 * 64 ) + ( 2 * 64 * 64 ) + ( 3 * 64 ) + 4 );
+
+	TEST_ERR_IF( pintoTextGetValue( &view, &valueVerify ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( valueVerify != ( 63 * 64 ) + 63 );
+
+	TEST_ERR_IF( pintoTextGetValue( &view, &valueVerify ) != PINTO_RC_ERROR_FORMAT_INVALID );
+
+	string = "#^ ^";
+	pintoTextInitView( &view, string, (s32) strlen( string ) );
+
+	TEST_ERR_IF( pintoTextGetValue( &view, &valueVerify ) != PINTO_RC_ERROR_FORMAT_INVALID );
+
+	pintoTextInitView( &view, string + 1, (s32) strlen( string + 1 ) );
+
+	TEST_ERR_IF( pintoTextGetValue( &view, &valueVerify ) != PINTO_RC_ERROR_FORMAT_INVALID );
+
 	/* check "image too small" in downsize function */
 	TEST_ERR_IF( pintoImageInit( 1, 32, &image1 ) != PINTO_RC_SUCCESS );
 	TEST_ERR_IF( pintoImageDownsize( image1, &image2 ) != PINTO_RC_ERROR_IMAGE_TOO_SMALL );
@@ -153,6 +241,131 @@ int testMisc()
 	TEST_ERR_IF( pintoImageDownsize( image1, &image2 ) != PINTO_RC_ERROR_IMAGE_TOO_SMALL );
 	pintoImageFree( &image1 );
 
+	/* palette gives back indexes in order of first appearance */
+	for ( test = 0; test < 1000; test += 1 )
+	{
+		/* random distinct keys */
+		for ( i = 0; i < PINTO_MAX_COLORS + 1; i += 1 )
+		{
+			do
+			{
+				keys[ i ] = ( ( rand() & 0x1FF ) << 9 ) | ( rand() & 0x1FF );
+				for ( j = 0; j < i; j += 1 )
+				{
+					if ( keys[ j ] == keys[ i ] ) { break; }
+				}
+			}
+			while ( j != i );
+		}
+
+		pintoPaletteInit( &palette );
+
+		for ( i = 0; i < PINTO_MAX_COLORS; i += 1 )
+		{
+			TEST_ERR_IF( pintoPaletteGetIndex( &palette, keys[ i ], &index ) != PINTO_RC_SUCCESS );
+			TEST_ERR_IF( index != i );
+		}
+
+		/* look them up again */
+		for ( i = PINTO_MAX_COLORS - 1; i >= 0; i -= 1 )
+		{
+			TEST_ERR_IF( pintoPaletteGetIndex( &palette, keys[ i ], &index ) != PINTO_RC_SUCCESS );
+			TEST_ERR_IF( index != i );
+
+			TEST_ERR_IF( palette.colors[ ( i * 3 )     ] != PINTO_8_BITS_TO_6_BITS( ( keys[ i ] >> 12 ) << 2 ) );
+			TEST_ERR_IF( palette.colors[ ( i * 3 ) + 1 ] != PINTO_8_BITS_TO_6_BITS( ( ( keys[ i ] >> 6 ) & 0x3F ) << 2 ) );
+			TEST_ERR_IF( palette.colors[ ( i * 3 ) + 2 ] != PINTO_8_BITS_TO_6_BITS( ( keys[ i ] & 0x3F ) << 2 ) );
+		}
+
+		/* one too many */
+		TEST_ERR_IF( pintoPaletteGetIndex( &palette, keys[ PINTO_MAX_COLORS ], &index ) != PINTO_RC_ERROR_IMAGE_TOO_MANY_COLORS );
+		TEST_ERR_IF( palette.colorAmount != PINTO_MAX_COLORS );
+	}
+
+	/* converting pixels to keys */
+	for ( test = 0; test < 10000; test += 1 )
+	{
+		pixelAmount = rand() % 100;
+		partialPixel = pixelAmount;
+
+		for ( i = 0; i < pixelAmount * 4; i += 1 )
+		{
+			rgba[ i ] = (u8) rand();
+		}
+
+		for ( i = 0; i < pixelAmount; i += 1 )
+		{
+			rgba[ ( i * 4 ) + 3 ] = ( rand() % 2 == 0 ? 0 : 255 );
+		}
+
+		/* sometimes have a partially transparent pixel */
+		if ( pixelAmount > 0 && test % 2 == 0 )
+		{
+			partialPixel = rand() % pixelAmount;
+			rgba[ ( partialPixel * 4 ) + 3 ] = (u8)( ( rand() % 254 ) + 1 );
+		}
+
+		TEST_ERR_IF( pintoPixelsToKeys( rgba, pixelAmount, pixelKeys ) != partialPixel );
+
+		for ( i = 0; i < partialPixel; i += 1 )
+		{
+			if ( rgba[ ( i * 4 ) + 3 ] == 0 )
+			{
+				TEST_ERR_IF( pixelKeys[ i ] != -1 );
+			}
+			else
+			{
+				TEST_ERR_IF( pixelKeys[ i ] != PINTO_PALETTE_KEY( rgba[ ( i * 4 ) ], rgba[ ( i * 4 ) + 1 ], rgba[ ( i * 4 ) + 2 ] ) );
+			}
+		}
+	}
+
+	/* filling pixels, at any offset so every alignment is tried */
+	for ( test = 0; test < 10000; test += 1 )
+	{
+		offset = rand() % 33;
+		pixelAmount = rand() % ( ( ( 100 * 4 ) - offset ) / 4 );
+
+		for ( i = 0; i < 4; i += 1 )
+		{
+			color[ i ] = (u8) rand();
+		}
+
+		/* sometimes every byte is the same */
+		if ( test % 4 == 0 )
+		{
+			memset( color, color[ 0 ], 4 );
+		}
+
+		memset( rgba, 0xAB, 100 * 4 );
+
+		pintoPixelsFill( rgba + offset, pixelAmount, color );
+
+		for ( i = 0; i < 100 * 4; i += 1 )
+		{
+			if ( i >= offset && i < offset + ( pixelAmount * 4 ) )
+			{
+				TEST_ERR_IF( rgba[ i ] != color[ ( i - offset ) % 4 ] );
+			}
+			else
+			{
+				TEST_ERR_IF( rgba[ i ] != 0xAB );
+			}
+		}
+	}
+
+	/* rgba is aligned, if Pinto is built to align it */
+	TEST_ERR_IF( pintoImageInit( 1 + ( rand() % 100 ), 1 + ( rand() % 100 ), &image1 ) != PINTO_RC_SUCCESS );
+
+#if PINTO_RGBA_ALIGNMENT > 0
+	TEST_ERR_IF( ( (size_t) image1->rgba ) % PINTO_RGBA_ALIGNMENT != 0 );
+#endif
+
+	for ( i = 0; i < image1->width * image1->height * 4; i += 1 )
+	{
+		TEST_ERR_IF( image1->rgba[ i ] != 0 );
+	}
+
 	printf( "\n" );
 
 
@@ -160,6 +373,8 @@ int testMisc()
 	cleanup:
 
 	pintoTextFree( &text );
+	pintoTextFree( &textVerify );
+	pintoImageFree( &image1 );
 
 	return rc;
 }
@@ -49,12 +49,26 @@ int testPreconditions()
 	PintoText *text1 = NULL;
 	PintoText *text2 = NULL;
 
+	PintoEncodeOptions options;
+
+	PintoEncoder *encoder = NULL;
+	const char *constString = NULL;
+	char buffer[ 16 ];
+	PintoIndexedImage indexedImage;
+	PintoIndexedImage *indexedImage1 = NULL;
+	PintoIndexedImage *indexedImage2 = &indexedImage;
+	PintoImageInfo info;
+	PintoImageView view;
+	s32 size = 0;
+	u8 rgba[ 8 * 8 * 4 ];
+
 
 	/* CODE */
 	/* **************************************** */
 	printf( "Testing preconditions...\n" ); fflush( stdout );
 
 	TEST_ERR_IF( pintoTextInit( &text1 ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( pintoEncoderInit( &encoder ) != PINTO_RC_SUCCESS );
 
 	TEST_ERR_IF( pintoImageInit( -1, 10, &image1 ) != PINTO_RC_ERROR_PRECOND );
 	TEST_ERR_IF( pintoImageInit(  0, 10, &image1 ) != PINTO_RC_ERROR_PRECOND );
@@ -69,10 +83,182 @@ int testPreconditions()
 	TEST_ERR_IF( pintoImageEncode( image2, NULL ) != PINTO_RC_ERROR_PRECOND );
 	TEST_ERR_IF( pintoImageEncode( image2, &string2 ) != PINTO_RC_ERROR_PRECOND );
 
+	pintoEncodeOptionsInit( &options );
+	TEST_ERR_IF( pintoImageEncodeEx( NULL, &options, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageEncodeEx( image2, &options, NULL ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageEncodeEx( image2, &options, &string2 ) != PINTO_RC_ERROR_PRECOND );
+	options.level = -1;
+	TEST_ERR_IF( pintoImageEncodeEx( image2, &options, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	options.level = PINTO_LEVEL_MAX + 1;
+	TEST_ERR_IF( pintoImageEncodeEx( image2, &options, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	pintoEncodeOptionsInit( &options );
+	options.threadCount = 0;
+	TEST_ERR_IF( pintoImageEncodeEx( image2, &options, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	options.threadCount = PINTO_MAX_THREADS + 1;
+	TEST_ERR_IF( pintoImageEncodeEx( image2, &options, &string1 ) != PINTO_RC_ERROR_PRECOND );
+
+	TEST_ERR_IF( pintoEncoderInit( NULL ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderInit( &encoder ) != PINTO_RC_ERROR_PRECOND );
+
+	pintoEncodeOptionsInit( &options );
+	TEST_ERR_IF( pintoEncoderEncode( NULL, image2, &options, &constString ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderEncode( encoder, NULL, &options, &constString ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderEncode( encoder, image2, &options, NULL ) != PINTO_RC_ERROR_PRECOND );
+	options.level = -1;
+	TEST_ERR_IF( pintoEncoderEncode( encoder, image2, &options, &constString ) != PINTO_RC_ERROR_PRECOND );
+	pintoEncodeOptionsInit( &options );
+	options.threadCount = 0;
+	TEST_ERR_IF( pintoEncoderEncode( encoder, image2, &options, &constString ) != PINTO_RC_ERROR_PRECOND );
+
+	TEST_ERR_IF( pintoImageEncodedSize( NULL, &size ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageEncodedSize( image2, NULL ) != PINTO_RC_ERROR_PRECOND );
+
+	TEST_ERR_IF( pintoImageEncodeInto( NULL, NULL, buffer, 16, &size ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageEncodeInto( image2, NULL, NULL, 16, &size ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageEncodeInto( image2, NULL, buffer, -1, &size ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageEncodeInto( image2, NULL, buffer, 16, NULL ) != PINTO_RC_ERROR_PRECOND );
+
+	TEST_ERR_IF( pintoEncoderEncodeInto( NULL, image2, NULL, buffer, 16, &size ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderEncodeInto( encoder, NULL, NULL, buffer, 16, &size ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderEncodeInto( encoder, image2, NULL, NULL, 16, &size ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderEncodeInto( encoder, image2, NULL, buffer, -1, &size ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderEncodeInto( encoder, image2, NULL, buffer, 16, NULL ) != PINTO_RC_ERROR_PRECOND );
+
+	TEST_ERR_IF( pintoImageEncodeToSink( NULL, NULL, pintoFileWrite, stdout ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageEncodeToSink( image2, NULL, NULL, stdout ) != PINTO_RC_ERROR_PRECOND );
+
+	TEST_ERR_IF( pintoEncoderEncodeToSink( NULL, image2, NULL, pintoFileWrite, stdout ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderEncodeToSink( encoder, NULL, NULL, pintoFileWrite, stdout ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderEncodeToSink( encoder, image2, NULL, NULL, stdout ) != PINTO_RC_ERROR_PRECOND );
+
+	TEST_ERR_IF( pintoEncoderBegin( NULL, 10, 10, NULL ) != PINTO_RC_ERROR_PRECOND );
+	pintoEncodeOptionsInit( &options );
+	options.level = -1;
+	TEST_ERR_IF( pintoEncoderBegin( encoder, 10, 10, &options ) != PINTO_RC_ERROR_PRECOND );
+	pintoEncodeOptionsInit( &options );
+	options.threadCount = 0;
+	TEST_ERR_IF( pintoEncoderBegin( encoder, 10, 10, &options ) != PINTO_RC_ERROR_PRECOND );
+
+	/* rows can't be added or finished before beginning */
+	TEST_ERR_IF( pintoEncoderAddRows( NULL, (u8 *) buffer, 1 ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderAddRows( encoder, (u8 *) buffer, 1 ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderFinish( NULL, &constString ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderFinish( encoder, &constString ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderFinishToSink( NULL, pintoFileWrite, stdout ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderFinishToSink( encoder, pintoFileWrite, stdout ) != PINTO_RC_ERROR_PRECOND );
+
+	/* or past the height, or finished before all rows are added */
+	memset( buffer, 0, 16 );
+	TEST_ERR_IF( pintoEncoderBegin( encoder, 1, 2, NULL ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( pintoEncoderAddRows( encoder, NULL, 1 ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderBegin( encoder, 1, 2, NULL ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( pintoEncoderAddRows( encoder, (u8 *) buffer, 0 ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderBegin( encoder, 1, 2, NULL ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( pintoEncoderAddRows( encoder, (u8 *) buffer, 3 ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderBegin( encoder, 1, 2, NULL ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( pintoEncoderAddRows( encoder, (u8 *) buffer, 1 ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( pintoEncoderFinish( encoder, &constString ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderFinishToSink( encoder, pintoFileWrite, stdout ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderAddRows( encoder, (u8 *) buffer, 1 ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( pintoEncoderFinish( encoder, NULL ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderFinishToSink( encoder, NULL, stdout ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderFinish( encoder, &constString ) != PINTO_RC_SUCCESS );
+	TEST_ERR_IF( pintoEncoderFinish( encoder, &constString ) != PINTO_RC_ERROR_PRECOND );
+
+	pintoImageViewInit( &view, 2, 2, PINTO_FORMAT_GRAY, (u8 *) buffer );
+	TEST_ERR_IF( pintoImageViewEncode( NULL, NULL, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageViewEncode( &view, NULL, NULL ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageViewEncode( &view, NULL, &string2 ) != PINTO_RC_ERROR_PRECOND );
+	view.format = -1;
+	TEST_ERR_IF( pintoImageViewEncode( &view, NULL, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	view.format = PINTO_FORMAT_GRAY + 1;
+	TEST_ERR_IF( pintoImageViewEncode( &view, NULL, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	view.format = PINTO_FORMAT_GRAY;
+	view.threshold = -1;
+	TEST_ERR_IF( pintoImageViewEncode( &view, NULL, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	view.threshold = 257;
+	TEST_ERR_IF( pintoImageViewEncode( &view, NULL, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	view.threshold = 0;
+	view.format = PINTO_FORMAT_RGB;
+	view.colorKey = -2;
+	TEST_ERR_IF( pintoImageViewEncode( &view, NULL, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	view.colorKey = 0x1000000;
+	TEST_ERR_IF( pintoImageViewEncode( &view, NULL, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	view.colorKey = -1;
+	view.pixels = NULL;
+	TEST_ERR_IF( pintoImageViewEncode( &view, NULL, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	view.pixels = (u8 *) buffer;
+	pintoEncodeOptionsInit( &options );
+	options.level = -1;
+	TEST_ERR_IF( pintoImageViewEncode( &view, &options, &string1 ) != PINTO_RC_ERROR_PRECOND );
+
+	TEST_ERR_IF( pintoEncoderEncodeView( NULL, &view, NULL, &constString ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderEncodeView( encoder, NULL, NULL, &constString ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoEncoderEncodeView( encoder, &view, NULL, NULL ) != PINTO_RC_ERROR_PRECOND );
+	view.format = -1;
+	TEST_ERR_IF( pintoEncoderEncodeView( encoder, &view, NULL, &constString ) != PINTO_RC_ERROR_PRECOND );
+	view.format = PINTO_FORMAT_RGB;
+	pintoEncodeOptionsInit( &options );
+	options.threadCount = 0;
+	TEST_ERR_IF( pintoEncoderEncodeView( encoder, &view, &options, &constString ) != PINTO_RC_ERROR_PRECOND );
+
+	memset( buffer, 0, 16 );
+	indexedImage.width = 4;
+	indexedImage.height = 4;
+	indexedImage.colorAmount = 1;
+	indexedImage.palette = (u8 *) buffer;
+	indexedImage.indexes = (u8 *) buffer;
+	indexedImage.transparentIndex = -1;
+	TEST_ERR_IF( pintoIndexedImageEncode( NULL, NULL, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, NULL, NULL ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, NULL, &string2 ) != PINTO_RC_ERROR_PRECOND );
+	indexedImage.palette = NULL;
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, NULL, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	indexedImage.palette = (u8 *) buffer;
+	indexedImage.indexes = NULL;
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, NULL, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	indexedImage.indexes = (u8 *) buffer;
+	indexedImage.colorAmount = -1;
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, NULL, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	indexedImage.colorAmount = 257;
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, NULL, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	indexedImage.colorAmount = 1;
+	indexedImage.transparentIndex = -2;
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, NULL, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	indexedImage.transparentIndex = 256;
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, NULL, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	indexedImage.transparentIndex = -1;
+	pintoEncodeOptionsInit( &options );
+	options.level = -1;
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, &options, &string1 ) != PINTO_RC_ERROR_PRECOND );
+	pintoEncodeOptionsInit( &options );
+	options.threadCount = 0;
+	TEST_ERR_IF( pintoIndexedImageEncode( &indexedImage, &options, &string1 ) != PINTO_RC_ERROR_PRECOND );
+
 	TEST_ERR_IF( pintoImageDecodeString( NULL, &image1 ) != PINTO_RC_ERROR_PRECOND );
 	TEST_ERR_IF( pintoImageDecodeString( string2, NULL ) != PINTO_RC_ERROR_PRECOND );
 	TEST_ERR_IF( pintoImageDecodeString( string2, &image2 ) != PINTO_RC_ERROR_PRECOND );
 
+	TEST_ERR_IF( pintoImageDecodeBuffer( NULL, 4, &image1 ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageDecodeBuffer( string2, strlen( string2 ), NULL ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageDecodeBuffer( string2, strlen( string2 ), &image2 ) != PINTO_RC_ERROR_PRECOND );
+
+	TEST_ERR_IF( pintoImageDecodeInto( NULL, 2, rgba, 8 * 8 * 4, 0, 0, &size, &size ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageDecodeInto( "0^", 2, NULL, 8 * 8 * 4, 0, 0, &size, &size ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageDecodeInto( "0^", 2, rgba, -1, 0, 0, &size, &size ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageDecodeInto( "0^", 2, rgba, 8 * 8 * 4, -1, 0, &size, &size ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageDecodeInto( "0^", 2, rgba, 8 * 8 * 4, 0, -1, &size, &size ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageDecodeInto( "0^", 2, rgba, 8 * 8 * 4, 0, ( 8 * 4 ) - 1, &size, &size ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageDecodeInto( "0^", 2, rgba, 8 * 8 * 4, 0, 0, NULL, &size ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageDecodeInto( "0^", 2, rgba, 8 * 8 * 4, 0, 0, &size, NULL ) != PINTO_RC_ERROR_PRECOND );
+
+	TEST_ERR_IF( pintoIndexedImageDecode( NULL, 2, &indexedImage1 ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoIndexedImageDecode( "0^", 2, NULL ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoIndexedImageDecode( "0^", 2, &indexedImage2 ) != PINTO_RC_ERROR_PRECOND );
+
+	TEST_ERR_IF( pintoImageGetInfo( NULL, 2, &info ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoImageGetInfo( "0^", 2, NULL ) != PINTO_RC_ERROR_PRECOND );
+
 	TEST_ERR_IF( pintoImageDecodeText( NULL, &image1 ) != PINTO_RC_ERROR_PRECOND );
 	TEST_ERR_IF( pintoImageDecodeText( &text2, &image1 ) != PINTO_RC_ERROR_PRECOND );
 	TEST_ERR_IF( pintoImageDecodeText( &text1, NULL ) != PINTO_RC_ERROR_PRECOND );
@@ -83,6 +269,10 @@ int testPreconditions()
 
 	TEST_ERR_IF( pintoTextAddChar( NULL, 'a' ) != PINTO_RC_ERROR_PRECOND );
 
+	TEST_ERR_IF( pintoTextAddBuffer( NULL, "a", 1, NULL ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoTextAddBuffer( text1, NULL, 1, NULL ) != PINTO_RC_ERROR_PRECOND );
+	TEST_ERR_IF( pintoTextAddBuffer( text1, "a", -1, NULL ) != PINTO_RC_ERROR_PRECOND );
+
 	TEST_ERR_IF( pintoImageDownsize( NULL, &image1 ) != PINTO_RC_ERROR_PRECOND );
 	TEST_ERR_IF( pintoImageDownsize( image2, NULL ) != PINTO_RC_ERROR_PRECOND );
 	TEST_ERR_IF( pintoImageDownsize( image2, &image2 ) != PINTO_RC_ERROR_PRECOND );
@@ -92,6 +282,8 @@ int testPreconditions()
 
 	pintoTextFree( &text1 );
 
+	pintoEncoderFree( &encoder );
+
 	return rc;
 }
 
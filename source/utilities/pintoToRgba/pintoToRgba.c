@@ -38,6 +38,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /******************************************************************************/
 #define APP_ERR_IF( x ) if ( (x) ) { rc = -__LINE__; goto cleanup; }
 
+/******************************************************************************/
+#define READ_SIZE 4096
+
 /******************************************************************************/
 #define FLAG_PRINT_USAGE         0
 #define FLAG_PRINT_SIZE          1
@@ -52,11 +55,15 @@ int main( int argc, char **argv )
 
 	char flag = FLAG_PRINT_USAGE;
 
-	PintoText *text = NULL;
+	char *data = NULL;
+	char *reallocedData = NULL;
+	size_t dataSize = 0;
+	size_t dataAllocedSize = 0;
+	size_t readSize = 0;
 
 	FILE *fp = NULL;
 
-	char ch = 0;
+	PintoImageInfo info;
 
 	PintoImage *image = NULL;
 	PintoImage *imageDownsize = NULL;
@@ -109,14 +116,6 @@ int main( int argc, char **argv )
 		APP_ERR_IF( 1 );
 	}
 
-	/* setup text */
-	pintoRC = pintoTextInit( &text );
-	if ( pintoRC != PINTO_RC_SUCCESS )
-	{
-		fprintf( stderr, "ERROR: text init failed! (%s)\n", pintoRCToString( pintoRC ) );
-		APP_ERR_IF( 1 );
-	}
-
 	/* open file */
 	fp = fopen( argv[ 2 ], "rb" );
 	if ( fp == NULL )
@@ -124,31 +123,59 @@ int main( int argc, char **argv )
 		fprintf( stderr, "ERROR: Could not open file \"%s\": %s\n", argv[ 2 ], strerror( errno ) );
 		APP_ERR_IF( 1 );
 	}
-	
-	/* read pinto data from stdin */
-	while ( fread( &ch, 1, 1, fp ) == 1 )
+
+	/* read pinto data from file. double the room each time it fills, so a
+	   big file isn't copied over and over. */
+	do
+	{
+		if ( dataSize == dataAllocedSize )
+		{
+			dataAllocedSize = ( dataAllocedSize == 0 ? READ_SIZE : dataAllocedSize * 2 );
+
+			reallocedData = (char *) realloc( data, dataAllocedSize );
+			if ( reallocedData == NULL )
+			{
+				fprintf( stderr, "ERROR: Could not allocate memory for file \"%s\"\n", argv[ 2 ] );
+				APP_ERR_IF( 1 );
+			}
+			data = reallocedData;
+		}
+
+		readSize = fread( data + dataSize, 1, dataAllocedSize - dataSize, fp );
+		dataSize += readSize;
+	}
+	while ( readSize != 0 );
+
+	if ( ferror( fp ) )
+	{
+		fprintf( stderr, "ERROR: Could not read file \"%s\": %s\n", argv[ 2 ], strerror( errno ) );
+		APP_ERR_IF( 1 );
+	}
+
+	if ( flag == FLAG_PRINT_SIZE )
 	{
-		pintoRC = pintoTextAddChar( text, ch );
+		/* only the header is needed for the size */
+		pintoRC = pintoImageGetInfo( data, dataSize, &info );
 		if ( pintoRC != PINTO_RC_SUCCESS )
 		{
-			fprintf( stderr, "ERROR: text add char failed! (%s)\n", pintoRCToString( pintoRC ) );
+			fprintf( stderr, "ERROR: pinto get info failed! (%s)\n", pintoRCToString( pintoRC ) );
 			APP_ERR_IF( 1 );
 		}
+
+		printf( "%dx%d\n", info.width, info.height );
+
+		goto cleanup;
 	}
 
 	/* decode to image */
-	pintoRC = pintoImageDecodeText( &text, &image );
+	pintoRC = pintoImageDecodeBuffer( data, dataSize, &image );
 	if ( pintoRC != PINTO_RC_SUCCESS )
 	{
 		fprintf( stderr, "ERROR: pinto decode failed! (%s)\n", pintoRCToString( pintoRC ) );
 		APP_ERR_IF( 1 );
 	}
 
-	if ( flag == FLAG_PRINT_SIZE )
-	{
-		printf( "%dx%d\n", image->width, image->height );
-	}
-	else if ( flag == FLAG_PRINT_RGBA )
+	if ( flag == FLAG_PRINT_RGBA )
 	{
 		/* output to stdout */
 		fwrite( image->rgba, 1, image->width * image->height * 4, stdout );
@@ -180,7 +207,7 @@ int main( int argc, char **argv )
 		fp = NULL;
 	}
 
-	free( text );
+	free( data );
 
 	return rc;
 }